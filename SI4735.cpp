@@ -60,10 +60,228 @@ SI4735::SI4735()
 {
     // 1 = LSB and 2 = USB; 0 = AM, FM or WB
     currentSsbStatus = 0;
+    transport = &wireTransport;
+#ifdef SI4735_STATS
+    resetStats();
+#endif
+}
+
+/**
+ * @brief Destroy the SI4735::SI4735
+ * @details Detaches the interrupt handler of this instance (if any). 
+ */
+SI4735::~SI4735()
+{
+    detachInterruptHandler();
 }
 
 /** @defgroup group05 Deal with Interrupt and I2C bus */
 
+/**
+ * @ingroup group05 Bus transport
+ *
+ * @brief Writes a command and reads its response
+ *
+ * @details The default implementation does a full write transaction (with STOP) followed by a read transaction.
+ *
+ * @param address I2C bus address
+ * @param data  bytes to be sent
+ * @param size  number of bytes to be sent
+ * @param response buffer where the response will be stored
+ * @param responseSize number of bytes to read
+ * @return uint8_t number of bytes really received (0 if the write fails)
+ */
+uint8_t SI4735Transport::writeRead(uint8_t address, const uint8_t *data, uint8_t size, uint8_t *response, uint8_t responseSize)
+{
+    if (write(address, data, size) != 0)
+        return 0;
+    return read(address, response, responseSize);
+}
+
+/**
+ * @ingroup group05 Bus transport
+ *
+ * @brief Timing hook. Waits a given time in microseconds.
+ *
+ * @details Override this method if your platform has a better way to wait (RTOS delay, low power sleep or a virtual clock).
+ *
+ * @param us time in microseconds
+ */
+void SI4735Transport::waitMicroseconds(uint32_t us)
+{
+    if (us >= 1000)
+        delay(us / 1000);
+    delayMicroseconds(us % 1000);
+}
+
+/**
+ * @ingroup group05 Bus transport
+ * @brief Starts the I2C bus (Wire.begin())
+ */
+void SI4735WireTransport::begin()
+{
+    wire->begin();
+}
+
+/**
+ * @ingroup group05 Bus transport
+ *
+ * @brief Sends size bytes to the device in a single I2C transaction.
+ *
+ * @param address I2C bus address
+ * @param data bytes to be sent
+ * @param size number of bytes
+ * @return uint8_t the value returned by endTransmission (0 = success)
+ */
+uint8_t SI4735WireTransport::write(uint8_t address, const uint8_t *data, uint8_t size)
+{
+    wire->beginTransmission(address);
+    for (uint8_t i = 0; i < size; i++)
+        wire->write(data[i]);
+    return wire->endTransmission();
+}
+
+/**
+ * @ingroup group05 Bus transport
+ *
+ * @brief Reads size bytes from the device in a single I2C transaction.
+ *
+ * @param address I2C bus address
+ * @param data buffer where the bytes will be stored
+ * @param size number of bytes
+ * @return uint8_t the number of bytes received
+ */
+uint8_t SI4735WireTransport::read(uint8_t address, uint8_t *data, uint8_t size)
+{
+    uint8_t received = wire->requestFrom(address, size);
+    for (uint8_t i = 0; i < size; i++)
+        data[i] = wire->read();
+    return received;
+}
+
+/**
+ * @ingroup group05 Bus transport
+ *
+ * @brief Writes a command and reads its response. 
+ *
+ * @details If the repeated start is enabled (see setRepeatedStart), the read starts with a repeated start condition 
+ * @details (no STOP between the write and the read). Otherwise, same of SI4735Transport::writeRead.
+ *
+ * @return uint8_t number of bytes really received (0 if the write fails)
+ */
+uint8_t SI4735WireTransport::writeRead(uint8_t address, const uint8_t *data, uint8_t size, uint8_t *response, uint8_t responseSize)
+{
+    if (!repeatedStart)
+        return SI4735Transport::writeRead(address, data, size, response, responseSize);
+
+    wire->beginTransmission(address);
+    for (uint8_t i = 0; i < size; i++)
+        wire->write(data[i]);
+    if (wire->endTransmission(false) != 0)
+        return 0;
+    return read(address, response, responseSize);
+}
+
+/**
+ * @ingroup group05 Bus transport
+ * @brief Sets the I2C bus clock
+ * @param frequency in Hz (Example: 100000 = 100kHz)
+ */
+void SI4735WireTransport::setClock(uint32_t frequency)
+{
+    wire->setClock(frequency);
+}
+
+/**
+ * @ingroup group05 Bus transport
+ *
+ * @brief Sets the transport used to talk to the Si47XX device.
+ *
+ * @details Call this method before setup. If transport is NULL, the default transport (Arduino Wire library) will be used.
+ *
+ * @see SI4735Transport, SI4735WireTransport
+ *
+ * @param transport an instance of a SI4735Transport implementation
+ */
+void SI4735::setTransport(SI4735Transport *transport)
+{
+    this->transport = (transport != NULL) ? transport : &wireTransport;
+}
+
+SI4735 *SI4735::interruptReceiver[MAX_INTERRUPT_RECEIVERS] = {NULL};
+
+/**
+ * @ingroup group05 Interrupt
+ * @brief Interrupt handlers. Each one sets the interrupt flag of the instance that owns it. 
+ * @details attachInterrupt does not pass any parameter to the handler. So, there is one handler per instance.
+ */
+void SI4735::interruptHandler0()
+{
+    if (interruptReceiver[0] != NULL)
+        interruptReceiver[0]->interruptFlag = true;
+}
+
+void SI4735::interruptHandler1()
+{
+    if (interruptReceiver[1] != NULL)
+        interruptReceiver[1]->interruptFlag = true;
+}
+
+void SI4735::interruptHandler2()
+{
+    if (interruptReceiver[2] != NULL)
+        interruptReceiver[2]->interruptFlag = true;
+}
+
+void SI4735::interruptHandler3()
+{
+    if (interruptReceiver[3] != NULL)
+        interruptReceiver[3]->interruptFlag = true;
+}
+
+/**
+ * @ingroup group05 Interrupt
+ *
+ * @brief Attaches an interrupt handler of this instance to the interruptPin (RISING edge)
+ *
+ * @details Each instance uses its own handler and its own interrupt flag. So, many receivers can share the MCU.
+ * @details If all MAX_INTERRUPT_RECEIVERS handlers are in use, no handler is attached (interruptSlot = -1) and setup 
+ * @details keeps the GPO2/INT interrupt disabled on this instance (polling).
+ */
+void SI4735::attachInterruptHandler()
+{
+    static void (*const handler[MAX_INTERRUPT_RECEIVERS])() = {interruptHandler0, interruptHandler1, interruptHandler2, interruptHandler3};
+
+    if (interruptSlot < 0)
+    {
+        for (uint8_t i = 0; i < MAX_INTERRUPT_RECEIVERS; i++)
+        {
+            if (interruptReceiver[i] == NULL)
+            {
+                interruptReceiver[i] = this;
+                interruptSlot = i;
+                break;
+            }
+        }
+        if (interruptSlot < 0)
+            return;
+    }
+    attachInterrupt(digitalPinToInterrupt(interruptPin), handler[interruptSlot], RISING);
+}
+
+/**
+ * @ingroup group05 Interrupt
+ * @brief Detaches the interrupt handler of this instance and frees its slot
+ */
+void SI4735::detachInterruptHandler()
+{
+    if (interruptSlot < 0)
+        return;
+    detachInterrupt(digitalPinToInterrupt(interruptPin));
+    interruptReceiver[interruptSlot] = NULL;
+    interruptSlot = -1;
+}
+
 /**
  * @ingroup group05 Interrupt
  * @brief Interrupt handle
@@ -72,7 +290,7 @@ SI4735::SI4735()
  */
 void SI4735::waitInterrupr(void)
 {
-    while (!data_from_si4735)
+    while (!interruptFlag)
         ;
 }
 
@@ -95,13 +313,8 @@ si47x_status SI4735::getInterruptStatus()
 {
     si47x_status status;
 
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(GET_INT_STATUS);
-    Wire.endTransmission();
-
-    Wire.requestFrom(deviceAddress, 1);
-    status.raw = Wire.read();
+    sendCommand(GET_INT_STATUS, 0, NULL);
+    busRead(deviceAddress, &status.raw, 1);
 
     return status;
 }
@@ -137,12 +350,7 @@ void SI4735::setGpioCtl(uint8_t GPO1OEN, uint8_t GPO2OEN, uint8_t GPO3OEN)
     gpio.arg.DUMMY1 = 0;
     gpio.arg.DUMMY2 = 0;
 
-    waitToSend();
-
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(GPIO_CTL);
-    Wire.write(gpio.raw);
-    Wire.endTransmission();
+    sendCommand(GPIO_CTL, 1, &gpio.raw);
 }
 
 /**
@@ -176,12 +384,7 @@ void SI4735::setGpio(uint8_t GPO1LEVEL, uint8_t GPO2LEVEL, uint8_t GPO3LEVEL)
     gpio.arg.DUMMY1 = 0;
     gpio.arg.DUMMY2 = 0;
 
-    waitToSend();
-
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(GPIO_SET);
-    Wire.write(gpio.raw);
-    Wire.endTransmission();
+    sendCommand(GPIO_SET, 1, &gpio.raw);
 }
 
 /**
@@ -216,6 +419,47 @@ void SI4735::setGpioIen(uint8_t STCIEN, uint8_t RSQIEN, uint8_t ERRIEN, uint8_t
     gpio.arg.RSQREP = RSQREP;
 
     sendProperty(GPO_IEN, gpio.raw);
+
+    this->ctsInterruptArmed = CTSIEN && powerUp.arg.GPO2OEN && this->currentInterruptEnable;
+}
+
+/**
+ * @ingroup group05 Interrupt
+ *
+ * @brief Sets the strategy used by waitToSend to know the device is ready (CTS)
+ *
+ * @details WAIT_MODE_POLLING (default) reads the status byte through the I2C bus every MIN_DELAY_WAIT_SEND_LOOP us.
+ * @details WAIT_MODE_INTERRUPT arms the CTS and STC interrupts (CTSIEN and STCIEN) and waits for the GPO2/INT edge.  
+ * @details In this mode the bus stays free (for displays, EEPROM and other devices) while the Si47XX is executing a command.
+ * @details setFrequency, seekStation and the asynchronous tune also return as soon as the STC interrupt arrives, instead 
+ * @details of sleeping the expected (or worst case) tune time. 
+ * @details If no edge arrives within timeout, waitToSend falls back to polling.
+ * @details The interrupt mode needs the interruptPin parameter of setup (GPO2/INT connected to an Arduino interrupt pin). 
+ * @details Without it, the polling mode is used. You can call this function before or after setup.
+ *
+ * @code
+ *   rx.setup(RESET_PIN, INTERRUPT_PIN, FM_FUNCTION);
+ *   rx.setWaitMode(WAIT_MODE_INTERRUPT);
+ * @endcode
+ *
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 65, 146
+ * @see setup, waitToSend, setGpioIen
+ *
+ * @param mode WAIT_MODE_POLLING or WAIT_MODE_INTERRUPT
+ * @param timeout max time in ms waiting for the GPO2/INT edge (default MAX_DELAY_WAIT_INTERRUPT)
+ */
+void SI4735::setWaitMode(uint8_t mode, uint16_t timeout)
+{
+    this->waitMode = mode;
+    this->maxDelayWaitInterrupt = timeout;
+
+    // If the device is already running, arms (or disarms) the interrupt sources now.
+    // Otherwise, radioPowerUp will do it.
+    if (this->currentInterruptEnable)
+    {
+        uint8_t enable = (mode == WAIT_MODE_INTERRUPT);
+        setGpioIen(enable, 0, 0, enable, 0, 0);
+    }
 }
 
 /** 
@@ -240,10 +484,9 @@ int16_t SI4735::getDeviceI2CAddress(uint8_t resetPin)
 
     reset();
 
-    Wire.begin();
+    transport->begin();
     // check 0X11 I2C address
-    Wire.beginTransmission(SI473X_ADDR_SEN_LOW);
-    error = Wire.endTransmission();
+    error = busWrite(SI473X_ADDR_SEN_LOW, NULL, 0);
     if (error == 0)
     {
         setDeviceI2CAddress(0);
@@ -251,8 +494,7 @@ int16_t SI4735::getDeviceI2CAddress(uint8_t resetPin)
     }
 
     // check 0X63 I2C address
-    Wire.beginTransmission(SI473X_ADDR_SEN_HIGH);
-    error = Wire.endTransmission();
+    error = busWrite(SI473X_ADDR_SEN_HIGH, NULL, 0);
     if (error == 0)
     {
         setDeviceI2CAddress(1);
@@ -308,11 +550,12 @@ void SI4735::setDeviceOtherI2CAddress(uint8_t i2cAddr)
 void SI4735::reset()
 {
     pinMode(resetPin, OUTPUT);
-    delay(10);
+    waitMicroseconds(10000);
     digitalWrite(resetPin, LOW);
-    delay(10);
+    waitMicroseconds(10000);
     digitalWrite(resetPin, HIGH);
-    delay(10);
+    waitMicroseconds(10000);
+    setCommandPending(LATENCY_OTHER); // CTS unknown after reset
 }
 
 /**
@@ -321,2209 +564,3668 @@ void SI4735::reset()
  * @brief  Wait for the si473x is ready (Clear to Send (CTS) status bit have to be 1).  
  * 
  * @details This function should be used before sending any command to a SI47XX device.
+ * @details If the wait mode is WAIT_MODE_INTERRUPT and a command is pending, waits for the GPO2/INT edge instead of polling.
+ * @details Otherwise, sleeps the expected completion time of the last command sent (see setCommandLatency) and then polls CTS.
+ * @details If CTS was already confirmed and nothing was sent after that, returns immediately without using the I2C bus.
  * 
  * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 63, 128
+ * @see setWaitMode, setCommandLatency
  */
 void SI4735::waitToSend()
 {
-    do
-    {
-        delayMicroseconds(MIN_DELAY_WAIT_SEND_LOOP); // Need check the minimum value.
-        Wire.requestFrom(deviceAddress, 1);
-    } while (!(Wire.read() & B10000000));
+    waitCts();
 }
 
-/** @defgroup group07 Device Setup and Start up */
-
 /**
- * @ingroup group07 Device Power Up parameters 
- *  
- * @brief Set the Power Up parameters for si473X. 
- * 
- * @details Use this method to chenge the defaul behavior of the Si473X. Use it before PowerUp()
- * @details About the parameter XOSCEN: 
- * @details     0 = Use external RCLK (crystal oscillator disabled);
- * @details     1 = Use crystal oscillator (RCLK and GPO3/DCLK with external 32.768 kHz crystal and OPMODE = 01010000). 
- * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 65 and 129
- * 
- * @param uint8_t CTSIEN sets Interrupt anabled or disabled (1 = anabled and 0 = disabled )
- * @param uint8_t GPO2OEN sets GP02 Si473X pin enabled (1 = anabled and 0 = disabled )
- * @param uint8_t PATCH  Used for firmware patch updates. Use it always 0 here. 
- * @param uint8_t XOSCEN sets external Crystal enabled or disabled. 0 = Use external RCLK (crystal oscillator disabled); 1 = Use crystal oscillator  
- * @param uint8_t FUNC sets the receiver function have to be used [0 = FM Receive; 1 = AM (LW/MW/SW) and SSB (if SSB patch apllied)]
- * @param uint8_t OPMODE set the kind of audio mode you want to use.
+ * @ingroup group06 Yield hook
+ *
+ * @brief Waits a given time. All library delays go through this method.
+ *
+ * @details If a yield hook is set (see setYieldHook) and the wait is at least minYieldTime, the hook is called
+ * @details repeatedly with the time left (budget) until less than YIELD_GUARD_TIME us remains. The rest of the time
+ * @details is waited through the transport timing hook. If the hook returns late, the wait ends at once and the overrun is counted.
+ *
+ * @see setYieldHook, SI4735Transport::waitMicroseconds
+ * @param us time in microseconds
  */
-void SI4735::setPowerUp(uint8_t CTSIEN, uint8_t GPO2OEN, uint8_t PATCH, uint8_t XOSCEN, uint8_t FUNC, uint8_t OPMODE)
+void SI4735::waitMicroseconds(uint32_t us)
 {
-    powerUp.arg.CTSIEN = CTSIEN;   // 1 -> Interrupt anabled;
-    powerUp.arg.GPO2OEN = GPO2OEN; // 1 -> GPO2 Output Enable;
-    powerUp.arg.PATCH = PATCH;     // 0 -> Boot normally;
-    powerUp.arg.XOSCEN = XOSCEN;   // 1 -> Use external crystal oscillator;
-    powerUp.arg.FUNC = FUNC;       // 0 = FM Receive; 1 = AM/SSB (LW/MW/SW) Receiver.
-    powerUp.arg.OPMODE = OPMODE;   // 0x5 = 00000101 = Analog audio outputs (LOUT/ROUT).
-
-    // Set the current tuning frequancy mode 0X20 = FM and 0x40 = AM (LW/MW/SW)
-    // See See Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 55 and 124
+    if (yieldFunc != NULL && !yielding && us >= minYieldTime)
+    {
+        uint32_t start = micros();
+        uint32_t elapsed = 0;
 
-    this->currentClockType = XOSCEN;
+        yielding = true;
+        while ((elapsed + YIELD_GUARD_TIME) < us)
+        {
+            yieldFunc(us - elapsed - YIELD_GUARD_TIME);
+            elapsed = micros() - start;
+        }
+        yielding = false;
 
-    if (FUNC == 0)
-    {
-        currentTune = FM_TUNE_FREQ;
-        currentFrequencyParams.arg.FREEZE = 1;
-    }
-    else
-    {
-        currentTune = AM_TUNE_FREQ;
-        currentFrequencyParams.arg.FREEZE = 0;
+        if (elapsed >= us)
+        {
+            if (elapsed > us && yieldOverruns < 0xFFFF)
+                yieldOverruns++;
+            return;
+        }
+        us -= elapsed;
     }
-    currentFrequencyParams.arg.FAST = 1;
-    currentFrequencyParams.arg.DUMMY1 = 0;
-    currentFrequencyParams.arg.ANTCAPH = 0;
-    currentFrequencyParams.arg.ANTCAPL = 1;
+    transport->waitMicroseconds(us);
 }
 
 /**
- * @ingroup group07 Device Power Up 
- * 
- * @brief Powerup the Si47XX
- * 
- * @details Before call this function call the setPowerUp to set up the parameters.
- * 
- * @details Parameters you have to set up with setPowerUp
- * 
- * | Parameter | Description |
- * | --------- | ----------- |
- * | CTSIEN    | Interrupt anabled or disabled |
- * | GPO2OEN   | GPO2 Output Enable or disabled |
- * | PATCH     | Boot normally or patch |
- * | XOSCEN    | Use external crystal oscillator. 1 = Use crystal oscillator;  (crystal oscillator disabled) |
- * | FUNC      | defaultFunction = 0 = FM Receive; 1 = AM (LW/MW/SW) Receiver |
- * | OPMODE    | SI473X_ANALOG_AUDIO (B00000101) or SI473X_DIGITAL_AUDIO (B00001011) |
- * 
- * ATTENTION: The document AN383; "Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES"; rev 0.8; page 6; there is the following note:
- *            Crystal and digital audio mode cannot be used at the same time. Populate R1 and remove C10, C11, and X1 when using digital audio.
- * 
- *see setMaxDelaySetFrequency()
- * @see MAX_DELAY_AFTER_POWERUP 
- * @see  SI4735::setPowerUp()
- * @see  Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 64, 129
+ * @ingroup group06 Yield hook
+ *
+ * @brief Waits for the GPO2/INT edge (interruptFlag) up to a given time
+ *
+ * @details The time is measured with micros(). If a yield hook is set, it is called with the time left (as budget) while it is 
+ * @details at least minYieldTime. The hook can return early when isInterruptPending() is true. Otherwise, the flag is checked 
+ * @details every MIN_DELAY_WAIT_INTERRUPT_LOOP us. The flag is not cleared.
+ *
+ * @see setYieldHook, isInterruptPending
+ * @param timeout max time in microseconds
+ * @return true if the edge has arrived
  */
-void SI4735::radioPowerUp(void)
+bool SI4735::waitInterrupt(uint32_t timeout)
 {
-    // delayMicroseconds(1000);
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(POWER_UP);
-    Wire.write(powerUp.raw[0]); // Content of ARG1
-    Wire.write(powerUp.raw[1]); // COntent of ARG2
-    Wire.endTransmission();
-    // Delay at least 500 ms between powerup command and first tune command to wait for
-    // the oscillator to stabilize if XOSCEN is set and crystal is used as the RCLK.
-    waitToSend();
-    delay(maxDelayAfterPouwerUp);
-
-    // Turns the external mute circuit off
-    if (audioMuteMcuPin >= 0)
-        setHardwareAudioMute(false);
+    uint32_t start = micros();
+    uint32_t elapsed;
 
-    if (this->currentClockType == 0)
+    while (!interruptFlag && (elapsed = micros() - start) < timeout)
     {
-        setRefClock(this->refClock);
-        setRefClockPrescaler(this->refClockPrescale, this->refClockSourcePin);
+        uint32_t left = timeout - elapsed;
+        if (yieldFunc != NULL && !yielding && left >= minYieldTime)
+        {
+            yielding = true;
+            yieldFunc(left - YIELD_GUARD_TIME);
+            yielding = false;
+            if ((micros() - start) > timeout && yieldOverruns < 0xFFFF)
+                yieldOverruns++;
+        }
+        else
+            transport->waitMicroseconds((left < MIN_DELAY_WAIT_INTERRUPT_LOOP) ? left : MIN_DELAY_WAIT_INTERRUPT_LOOP);
     }
+    return interruptFlag;
 }
 
 /**
- * @ingroup group07 Device Power Up 
- * 
- * @brief You have to call setPowerUp method before. 
- * @details This function is still available only for legacy reasons. 
- *          If you are using this function, please, replace it by radioPowerup().
- * @deprecated Use radioPowerUp instead.
- * @see  SI4735::setPowerUp()
- * @see  Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 64, 129
+ * @ingroup group06 Yield hook
+ *
+ * @brief Sets a function called while the library is waiting for the device
+ *
+ * @details The library waits for the device after power up, tune, seek, property writes, patch lines and while polling CTS or STC.
+ * @details During those waits, the hook runs instead of a plain delay. You can use this time to read an encoder, refresh a display or sequence the audio mute.
+ * @details The hook receives the time (budget, in us) it can use and must return before it elapses. It can be called many times during the same wait.
+ * @details Keep in mind that the hook runs in the middle of a library call: do not call SI4735 methods from it (waits inside the hook do not call it again).
+ * @details In WAIT_MODE_INTERRUPT, the wait for the GPO2/INT edge gives the hook the time left up to the timeout. Return as soon as 
+ * @details isInterruptPending() is true, so the library sees the edge without delay.
+ *
+ * @code
+ *   void radioYield(uint32_t budget) {
+ *      if (budget > 2000 && !rx.isInterruptPending()) updateDisplay();
+ *      readEncoder();
+ *   }
+ *   ...
+ *   rx.setYieldHook(radioYield);
+ * @endcode
+ *
+ * @see getYieldOverruns, seekStationProgress
+ * @param yieldFunc function called during the waits. NULL disables it.
+ * @param minTime waits shorter than this value (us) do not call the hook (default MIN_YIELD_TIME)
  */
-void SI4735::analogPowerUp(void)
+void SI4735::setYieldHook(void (*yieldFunc)(uint32_t budget), uint16_t minTime)
 {
-    radioPowerUp();
+    this->yieldFunc = yieldFunc;
+    this->minYieldTime = (minTime > YIELD_GUARD_TIME) ? minTime : YIELD_GUARD_TIME + 1;
+    this->yieldOverruns = 0;
 }
 
-/** 
- * @ingroup group07 Device Power Down 
- * 
- * @brief Moves the device from powerup to powerdown mode.
- * 
- * @details After Power Down command, only the Power Up command is accepted.
+/**
+ * @ingroup group06 Wait to send command
+ *
+ * @brief Waits for CTS. Same of waitToSend.
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 67, 132
- * @see radioPowerUp()
+ * @see waitToSend
+ * @return uint8_t number of status reads done (up to 255)
  */
-void SI4735::powerDown(void)
+uint8_t SI4735::waitCts()
 {
-    // Turns the external mute circuit on
-    if (audioMuteMcuPin >= 0)
-        setHardwareAudioMute(true);
-
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(POWER_DOWN);
-    Wire.endTransmission();
-    delayMicroseconds(2500);
+    uint8_t status;
+    return waitCts(1, &status, false);
 }
 
 /**
- * @ingroup group07 Firmware Information 
+ * @ingroup group06 Wait to send command 
  * 
- * @brief Gets firmware information 
- * @details The firmware information will be stored in firmwareInfo member variable 
+ * @brief Waits for CTS reading size bytes on each status poll
+ * @details Without SI4735_STATS, waitCts(size, response, readResponse) is just pollCts.
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 66, 131
- * @see firmwareInfo
+ * @details The status byte is the first byte of any response. So, the last poll (the one with CTS set) is also the command response. 
+ * @details There is no extra read after CTS.
+ * 
+ * @see waitToSend, getCommandResponse
+ * 
+ * @param size number of bytes read on each poll
+ * @param response buffer with at least size bytes. response[0] is the status byte.
+ * @param readResponse if true, reads the response even if CTS is already known (no command pending)
+ * @return uint8_t number of reads done (up to 255)
  */
-void SI4735::getFirmware(void)
+uint8_t SI4735::pollCts(uint8_t size, uint8_t *response, bool readResponse)
 {
-    waitToSend();
+    uint8_t polls = 0;
+
+    if (ctsPending)
+    {
+        // Interrupt mode: waits for the GPO2/INT edge without using the I2C bus.
+        uint32_t start = micros();
+        uint32_t timeout = maxDelayWaitInterrupt * 1000UL;
+        uint32_t elapsed;
+        while ((elapsed = micros() - start) < timeout && waitInterrupt(timeout - elapsed))
+        {
+            interruptFlag = false;
+            // The edge can be an STC interrupt. Confirms the CTS bit.
+            busRead(deviceAddress, response, size);
+            polls++;
+            if (response[0] & B10000000)
+            {
+                // STC already set (fast tune): keeps the flag for waitStc, since both edges were merged.
+                if (response[0] & 0x01)
+                    interruptFlag = true;
+                ctsPending = false;
+                pendingLatencyClass = LATENCY_NONE;
+                return polls;
+            }
+        }
+        // No edge: falls back to polling.
+        ctsPending = false;
+    }
 
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(GET_REV);
-    Wire.endTransmission();
+    // Nothing was sent since the last time CTS was seen. The device is ready.
+    if (pendingLatencyClass == LATENCY_NONE)
+    {
+        if (readResponse)
+        {
+            busRead(deviceAddress, response, size);
+            polls++;
+        }
+        return polls;
+    }
 
+    // Sleeps close to the expected completion time of the last command and only then polls.
+    uint32_t elapsed = micros() - pendingCommandTime;
+    bool slept = elapsed < commandLatency[pendingLatencyClass];
+    if (slept)
+        waitMicroseconds(commandLatency[pendingLatencyClass] - elapsed);
+
+    uint8_t first = polls;
     do
     {
-        waitToSend();
-        // Request for 9 bytes response
-        Wire.requestFrom(deviceAddress, 9);
-        for (int i = 0; i < 9; i++)
-            firmwareInfo.raw[i] = Wire.read();
-    } while (firmwareInfo.resp.ERR);
+        if (polls != first)
+            waitMicroseconds(MIN_DELAY_WAIT_LATENCY_LOOP);
+        busRead(deviceAddress, response, size);
+        if (polls < 255)
+            polls++;
+    } while (!(response[0] & B10000000));
+
+    // Arriving after the expected time (the sketch did other work since the command), a ready device at the first poll
+    // says nothing about the command time. Only a wait that slept is early; a late arrival that had to poll again still counts.
+    if (slept || (polls - first) > 1)
+        updateCommandLatency(pendingLatencyClass, micros() - pendingCommandTime, slept && (polls - first) == 1);
+    pendingLatencyClass = LATENCY_NONE;
+    return polls;
 }
 
+#ifdef SI4735_STATS
 /**
- * @ingroup group07 
- * @brief Sets the frequency of the REFCLK from the output of the prescaler
- * @details The REFCLK range is 31130 to 34406 Hz (32768 ±5% Hz) in 1 Hz steps, or 0 (to disable AFC). For example, an RCLK of 13 MHz would require a prescaler value of 400 to divide it to 32500 Hz REFCLK.
- * @details The reference clock frequency property would then need to be set to 32500 Hz. 
- * @details RCLK frequencies between 31130 Hz and 40 MHz are supported, however, there are gaps in frequency coverage for prescaler values ranging from 1 to 10, or frequencies up to 311300 Hz. See table below.
+ * @ingroup group06 Bus statistics
  * 
- * Table REFCLK Prescaler
- * | Prescaler  | RCLK Low (Hz) | RCLK High (Hz)   |
- * | ---------- | ------------- | ---------------- | 
- * |    1       |   31130       |   34406          |
- * |    2       |   62260       |   68812          |
- * |    3       |   93390       |  103218          |
- * |    4       |  124520       |  137624          |
- * |    5       |  155650       |  172030          | 
- * |    6       |  186780       |  206436          |
- * |    7       |  217910       |  240842          | 
- * |    8       |  249040       |  275248          | 
- * |    9       |  280170       |  309654          | 
- * |   10       |  311300       |  344060          |       
- *  
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 34 and 35
+ * @brief Waits for CTS (see pollCts) and updates the wait statistics
  * 
- * @param refclk The allowed REFCLK frequency range is between 31130 and 34406 Hz (32768 ±5%), or 0 (to disable AFC).
+ * @see pollCts, getStats
  */
-void SI4735::setRefClock(uint16_t refclk)
+uint8_t SI4735::waitCts(uint8_t size, uint8_t *response, bool readResponse)
 {
-    sendProperty(REFCLK_FREQ, refclk);
-    this->refClock = refclk;
-}
+    uint32_t start = micros();
+    uint8_t polls = pollCts(size, response, readResponse);
+    uint32_t elapsed = micros() - start;
 
-/**
- * @ingroup group07
- * @brief Sets the number used by the prescaler to divide the external RCLK down to the internal REFCLK. 
- * @details The range may be between 1 and 4095 in 1 unit steps. 
- * @details For example, an RCLK of 13 MHz would require a prescaler value of 400 to divide it to 32500 Hz. The reference clock frequency property would then need to be set to 32500 Hz. 
- * @details ATTENTION by default, this function considers you are using the RCLK pin as clock source. 
- * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 34 and 35
- * 
- * @param prescale  Prescaler for Reference Clock value; Between 1 and 4095 in 1 unit steps. Default is 1. 
- * @param rclk_sel  0 = RCLK pin is clock source (default); 1 = DCLK pin is clock source
- */
-void SI4735::setRefClockPrescaler(uint16_t prescale, uint8_t rclk_sel)
-{
-    sendProperty(REFCLK_PRESCALE, prescale); //| (rclk_sel << 13)); // Sets the D12 to rclk_sel
-    this->refClockPrescale = prescale;
-    this->refClockSourcePin = rclk_sel;
+    stats.waits++;
+    stats.waitTime += elapsed;
+    if (elapsed > stats.maxWaitTime)
+        stats.maxWaitTime = elapsed;
+    stats.ctsPolls += polls;
+
+    return polls;
 }
 
-/** 
- * @ingroup   group07 Device start up 
- *  
- * @brief Starts the Si473X device. 
- *
- * @details Use this function to start the device up with the parameters shown below.
- * @details If the audio mode parameter is not entered, analog mode will be considered.
- * @details You can use any Arduino digital pin. Be sure you are using less than 3.6V on Si47XX RST pin.   
+/**
+ * @ingroup group06 Bus statistics
  * 
- * ATTENTION: The document AN383; "Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES"; rev 0.8; page 6; there is the following note:
- *            Crystal and digital audio mode cannot be used at the same time. Populate R1 and remove C10, C11, and X1 when using digital audio.
+ * @brief Counts a command sent to the device
  * 
- * @param resetPin Digital Arduino Pin used to RESET de Si47XX device. 
- * @param interruptPin interrupt Arduino Pin (see your Arduino pinout). If less than 0, iterrupt disabled.
- * @param defaultFunction is the mode you want the receiver starts.
- * @param audioMode default SI473X_ANALOG_AUDIO (Analog Audio). Use SI473X_ANALOG_AUDIO or SI473X_DIGITAL_AUDIO.
- * @param clockType 0 = Use external RCLK (crystal oscillator disabled); 1 = Use crystal oscillator 
+ * @param cmd command number (opcode)
  */
-void SI4735::setup(uint8_t resetPin, int interruptPin, uint8_t defaultFunction, uint8_t audioMode, uint8_t clockType)
+void SI4735::statsCommand(uint8_t cmd)
 {
-    this->currentInterruptEnable = 0;
-    Wire.begin();
-
-    this->resetPin = resetPin;
-    this->interruptPin = interruptPin;
-
-    // Arduino interrupt setup (you have to know which Arduino Pins can deal with interrupt).
-    if (interruptPin >= 0)
+    for (uint8_t i = 0; i < STATS_COMMANDS; i++)
     {
-        pinMode(interruptPin, INPUT);
-        attachInterrupt(digitalPinToInterrupt(interruptPin), interrupt_hundler, RISING);
-        this->currentInterruptEnable = 1;
+        if (stats.opcode[i] == cmd || stats.opcode[i] == 0)
+        {
+            stats.opcode[i] = cmd;
+            stats.commands[i]++;
+            return;
+        }
     }
-
-    data_from_si4735 = false;
-
-    currentAudioMode = audioMode;
-
-    // Set the initial SI473X behavior
-    // CTSIEN   interruptEnable -> Interrupt anabled or disable;
-    // GPO2OEN  1 -> GPO2 Output Enable;
-    // PATCH    0 -> Boot normally;
-    // XOSCEN   clockType -> Use external crystal oscillator (XOSCEN_CRYSTAL) or reference clock (XOSCEN_RCLK);
-    // FUNC     defaultFunction = 0 = FM Receive; 1 = AM (LW/MW/SW) Receiver.
-    // OPMODE   SI473X_ANALOG_AUDIO or SI473X_DIGITAL_AUDIO.
-
-    setPowerUp(this->currentInterruptEnable, 0, 0, clockType, defaultFunction, audioMode);
-
-    if (audioMuteMcuPin >= 0)
-        setHardwareAudioMute(true); // If you are using external citcuit to mute the audio, it turns the audio mute
-
-    reset();
-
-    radioPowerUp();
-    setVolume(30); // Default volume level.
-    getFirmware();
+    stats.otherCommands++;
 }
 
-/** 
- * @ingroup   group07 Device start up 
- * 
- * @brief  Starts the Si473X device.  
+/**
+ * @ingroup group06 Bus statistics
  * 
- * @details Use this setup if you are not using interrupt resource.
- * @details If the audio mode parameter is not entered, analog mode will be considered.
- * @details You can use any Arduino digital pin. Be sure you are using less than 3.6V on Si47XX RST pin.   
+ * @brief Clears the bus statistics
  * 
- * @param uint8_t resetPin Digital Arduino Pin used to RESET command. 
- * @param uint8_t defaultFunction. 0 =  FM mode; 1 = AM 
+ * @see getStats
  */
-void SI4735::setup(uint8_t resetPin, uint8_t defaultFunction)
+void SI4735::resetStats()
 {
-    setup(resetPin, -1, defaultFunction, SI473X_ANALOG_AUDIO, XOSCEN_CRYSTAL);
-    delay(250);
+    memset(&stats, 0, sizeof stats);
 }
 
-/** @defgroup group08 Tune, Device Mode and Filter setup */
-
 /**
- * @ingroup   group08 Internal Antenna Tuning capacitor
+ * @ingroup group06 Bus statistics
  * 
- * @brief Selects the tuning capacitor value.
- * 
- * @details On FM mode, the Antenna Tuning Capacitor is valid only when using TXO/LPI pin as the antenna input.
- * This selects the value of the antenna tuning capacitor manually, or automatically if set to zero. 
- * The valid range is 0 to 191. Automatic capacitor tuning is recommended. 
- * For example, if the varactor is set to a value of 5 manually, when read back the value will be 1. 
- * @details on AM mode, If the value is set to anything other than 0, the tuning capacitance is manually set as 95 fF x ANTCAP + 7 pF. 
- * ANTCAP manual range is 1–6143. Automatic capacitor tuning is recommended. In SW mode, ANTCAPH[15:8] (high byte) needs to be set to 0 and ANTCAPL[7:0] (low byte) needs to be set to 1. 
+ * @brief Adds a tune to the settle statistics of the current band
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 71 and 136
+ * @see getSettleStats
  * 
- * @param capacitor If zero, the tuning capacitor value is selected automatically. 
- *                  If the value is set to anything other than 0:
- *                  AM - the tuning capacitance is manually set as 95 fF x ANTCAP + 7 pF. 
- *                       ANTCAP manual range is 1–6143;
- *                  FM - the valid range is 0 to 191.    
- *                  According to Silicon Labs, automatic capacitor tuning is recommended (value 0). 
+ * @param time time (us) from the tune command to the end of setFrequency
+ * @param settled false if maxDelaySetFrequency was reached
+ * @param polls RSQ reads done by the settle detection
  */
-void SI4735::setTuneFrequencyAntennaCapacitor(uint16_t capacitor)
+void SI4735::statsSettle(uint32_t time, bool settled, uint8_t polls)
 {
-    si47x_antenna_capacitor cap;
-
-    cap.value = capacitor;
-
-    currentFrequencyParams.arg.DUMMY1 = 0;
+    si4735_settle_stats *band;
 
-    if (currentTune != AM_TUNE_FREQ) 
-    {
-        // For FM, the capacitor value has just one byte
-        currentFrequencyParams.arg.ANTCAPH = (capacitor <= 191) ? cap.raw.ANTCAPL : 0;
-    }
+    if (lastMode == SSB_CURRENT_MODE)
+        band = &stats.settle[SETTLE_BAND_SSB];
+    else if (currentTune == AM_TUNE_FREQ)
+        band = &stats.settle[(currentWorkFrequency < 1800) ? SETTLE_BAND_MW : SETTLE_BAND_SW];
     else
-    {
-        if (capacitor <= 6143)
-        {
-            currentFrequencyParams.arg.FREEZE = 0; // This parameter is not used for AM
-            currentFrequencyParams.arg.ANTCAPH = cap.raw.ANTCAPH;
-            currentFrequencyParams.arg.ANTCAPL = cap.raw.ANTCAPL;
-        }
-    }
-    // Tune the device again with the current frequency.
-    this->setFrequency(this->currentWorkFrequency);
+        band = &stats.settle[SETTLE_BAND_FM];
+
+    if (band->tunes == 0 || time < band->minTime)
+        band->minTime = time;
+    if (time > band->maxTime)
+        band->maxTime = time;
+    band->tunes++;
+    band->totalTime += time;
+    band->rsqPolls += polls;
+    if (!settled)
+        band->timeouts++;
 }
 
 /**
- * @ingroup   group08 Tune Frequency 
- * 
- * @brief Set the frequency to the corrent function of the Si4735 (FM, AM or SSB)
- * 
- * @details You have to call setup or setPowerUp before call setFrequency.
+ * @ingroup group06 Bus statistics
  * 
- * @see maxDelaySetFrequency()
- * @see MAX_DELAY_AFTER_SET_FREQUENCY
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 70, 135
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 13
+ * @brief Gets how many times a given command was sent since the last resetStats
  * 
- * @param uint16_t  freq is the frequency to change. For example, FM => 10390 = 103.9 MHz; AM => 810 = 810 kHz.
+ * @see getStats
+ * @param cmd command number (for example, FM_TUNE_FREQ or SET_PROPERTY)
+ * @return uint16_t number of commands (0 if the command was never sent or was counted in otherCommands)
  */
-void SI4735::setFrequency(uint16_t freq)
+uint16_t SI4735::getStatsCommands(uint8_t cmd)
 {
-    waitToSend(); // Wait for the si473x is ready.
-    currentFrequency.value = freq;
-    currentFrequencyParams.arg.FREQH = currentFrequency.raw.FREQH;
-    currentFrequencyParams.arg.FREQL = currentFrequency.raw.FREQL;
+    for (uint8_t i = 0; i < STATS_COMMANDS && stats.opcode[i] != 0; i++)
+        if (stats.opcode[i] == cmd)
+            return stats.commands[i];
+    return 0;
+}
+#endif
 
-    if (currentSsbStatus != 0)
+/**
+ * @ingroup group06 Command latency
+ *
+ * @brief Gets the latency class of a given command
+ *
+ * @see setCommandLatency
+ *
+ * @param cmd command number (see AN332-Si47XX PROGRAMMING GUIDE)
+ * @return uint8_t latency class (LATENCY_PROPERTY, LATENCY_FM_TUNE, ...)
+ */
+uint8_t SI4735::getLatencyClass(uint8_t cmd)
+{
+    switch (cmd)
     {
-        currentFrequencyParams.arg.DUMMY1 = 0;
-        currentFrequencyParams.arg.USBLSB = currentSsbStatus; // Set to LSB or USB
-        currentFrequencyParams.arg.FAST = 1;                  // Used just on AM and FM
-        currentFrequencyParams.arg.FREEZE = 0;                // Used just on FM
+    case SET_PROPERTY:
+    case GET_PROPERTY:
+        return LATENCY_PROPERTY;
+    case FM_TUNE_FREQ:
+    case FM_SEEK_START:
+    case NBFM_TUNE_FREQ:
+        return LATENCY_FM_TUNE;
+    case AM_TUNE_FREQ: // Same of SSB_TUNE_FREQ
+    case AM_SEEK_START:
+        return LATENCY_AM_TUNE;
+    case FM_RSQ_STATUS:
+    case NBFM_RSQ_STATUS:
+        return LATENCY_FM_RSQ;
+    case AM_RSQ_STATUS: // Same of SSB_RSQ_STATUS
+        return LATENCY_AM_RSQ;
+    case FM_RDS_STATUS:
+        return LATENCY_FM_RDS;
+    case POWER_UP:
+    case POWER_DOWN:
+        return LATENCY_POWER;
+    default:
+        return LATENCY_OTHER;
     }
-
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(currentTune);
-    Wire.write(currentFrequencyParams.raw[0]); // Send a byte with FAST and  FREEZE information; if not FM must be 0;
-    Wire.write(currentFrequencyParams.arg.FREQH);
-    Wire.write(currentFrequencyParams.arg.FREQL);
-    Wire.write(currentFrequencyParams.arg.ANTCAPH);
-    // If current tune is not FM sent one more byte
-    if (currentTune == AM_TUNE_FREQ) // if AM or SSB
-        Wire.write(currentFrequencyParams.arg.ANTCAPL);
-
-    Wire.endTransmission();
-    waitToSend();                // Wait for the si473x is ready.
-    currentWorkFrequency = freq; // check it
-    delay(maxDelaySetFrequency); // For some reason I need to delay here.
 }
 
 /**
- * @ingroup group08 Tune Frequency 
- *  
- * @brief Increments the current frequency on current band/function by using the current step.
- * 
- * @see setFrequencyStep()
+ * @ingroup group06 Command latency
+ *
+ * @brief Refines the expected completion time of a latency class from a measured time
+ *
+ * @details If the device was ready at the first poll done right after sleeping the expected time, the real time may be shorter 
+ * @details than the expected one. In this case the expected time is reduced by 1/8. Otherwise it moves 1/4 of the way to the measured time.
+ * @details A first poll done after the expected time had already passed (the caller was busy) is not early.
+ *
+ * @param latencyClass see setCommandLatency
+ * @param measured measured time in microseconds
+ * @param early true if the device was ready at the first poll, after sleeping the expected time
  */
-void SI4735::frequencyUp()
+void SI4735::updateCommandLatency(uint8_t latencyClass, uint32_t measured, bool early)
 {
-    if (currentWorkFrequency >= currentMaximumFrequency)
-        currentWorkFrequency = currentMinimumFrequency;
+    if (!commandLatencyLearning || latencyClass >= LATENCY_CLASSES)
+        return;
+
+    uint16_t expected = commandLatency[latencyClass];
+
+    if (early)
+        expected -= expected >> 3;
     else
-        currentWorkFrequency += currentStep;
+    {
+        if (measured > 0xFFFF)
+            measured = 0xFFFF;
+        expected = expected - (expected >> 2) + (measured >> 2);
+    }
 
-    setFrequency(currentWorkFrequency);
+    commandLatency[latencyClass] = expected;
 }
 
 /**
- * @ingroup group08 Tune Frequency 
- * 
- * @brief Decrements the current frequency on current band/function by using the current step.
- *  
- * @see setFrequencyStep()
+ * @ingroup group06 Command latency
+ *
+ * @brief Waits for the Seek/Tune Complete (STC) after a tune or seek command
+ *
+ * @details Sleeps the expected STC time of the latency class and then polls the STCINT bit (GET_INT_STATUS).  
+ * @details The poll interval starts at MIN_DELAY_WAIT_STC_LOOP and is doubled up to MAX_DELAY_WAIT_STC_LOOP.
+ * @details If the wait mode is WAIT_MODE_INTERRUPT (STCIEN set; see setWaitMode), it does not sleep the expected time.
+ * @details It waits for the GPO2/INT edge without using the I2C bus and returns as soon as the device signals STC.
+ * @details Then, the wait follows the real tune (PLL settle) or seek time. Without the edge, it falls back to polling.
+ * @details When STC is found, it is acknowledged (tune status with INTACK = 1) and currentStatus is updated.
+ * @details maxDelay is the upper bound of the wait. On timeout, the interrupt is acknowledged too (INTACK = 1). So, a STCINT left by 
+ * @details this command does not satisfy the first poll of the next wait (and the learned STC time is not corrupted by it).
+ *
+ * @param latencyClass LATENCY_FM_STC or LATENCY_AM_STC
+ * @param maxDelay max time in ms 
+ * @param learn if true, refines the expected STC time
+ * @return true if STC was found; false if maxDelay has elapsed
  */
-void SI4735::frequencyDown()
+bool SI4735::waitStc(uint8_t latencyClass, uint16_t maxDelay, bool learn)
 {
-
-    if (currentWorkFrequency <= currentMinimumFrequency)
-        currentWorkFrequency = currentMaximumFrequency;
+    uint32_t start = micros();
+    uint32_t limit = maxDelay * 1000UL;
+    uint32_t step = MIN_DELAY_WAIT_STC_LOOP;
+    uint32_t elapsed;
+    uint8_t polls = 0;
+    bool slept = false;
+
+    if (waitMode == WAIT_MODE_INTERRUPT && ctsInterruptArmed)
+    {
+        // STCIEN is set: waits for the STC interrupt. The CTS edge of the tune command was already consumed by waitToSend.
+        waitInterrupt(limit);
+        interruptFlag = false;
+    }
     else
-        currentWorkFrequency -= currentStep;
+    {
+        slept = commandLatency[latencyClass] < limit;
+        waitMicroseconds(slept ? commandLatency[latencyClass] : limit);
+    }
 
-    setFrequency(currentWorkFrequency);
+    while (!getInterruptStatus().refined.STCINT)
+    {
+        elapsed = micros() - start;
+        if (elapsed >= limit)
+        {
+            getStatus(1, 0); // Acknowledges a STCINT set after the last poll. It must not satisfy the next wait.
+            return false;
+        }
+        waitMicroseconds((step < (limit - elapsed)) ? step : (limit - elapsed));
+        if (step < MAX_DELAY_WAIT_STC_LOOP)
+            step <<= 1;
+        polls++;
+    }
+
+    // With the edge, the measured time is the real STC time (it is not an early poll). Like in pollCts, the first poll
+    // is early only if the whole expected time was slept before it.
+    if (learn)
+        updateCommandLatency(latencyClass, micros() - start, polls == 0 && slept);
+
+    getStatus(1, 0); // Clears STCINT
+    return true;
 }
 
+/** @defgroup group07 Device Setup and Start up */
+
 /**
- * @ingroup group08 Set mode and Band
- * 
- * @todo Adjust the power up parameters
+ * @ingroup group07 Device Power Up parameters 
+ *  
+ * @brief Set the Power Up parameters for si473X. 
  * 
- * @brief Sets the radio to AM function. It means: LW MW and SW.
+ * @details Use this method to chenge the defaul behavior of the Si473X. Use it before PowerUp()
+ * @details About the parameter XOSCEN: 
+ * @details     0 = Use external RCLK (crystal oscillator disabled);
+ * @details     1 = Use crystal oscillator (RCLK and GPO3/DCLK with external 32.768 kHz crystal and OPMODE = 01010000). 
  * 
- * @details Define the band range you want to use for the AM mode. 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 65 and 129
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 129.
+ * @param uint8_t CTSIEN sets Interrupt anabled or disabled (1 = anabled and 0 = disabled )
+ * @param uint8_t GPO2OEN sets GP02 Si473X pin enabled (1 = anabled and 0 = disabled )
+ * @param uint8_t PATCH  Used for firmware patch updates. Use it always 0 here. 
+ * @param uint8_t XOSCEN sets external Crystal enabled or disabled. 0 = Use external RCLK (crystal oscillator disabled); 1 = Use crystal oscillator  
+ * @param uint8_t FUNC sets the receiver function have to be used [0 = FM Receive; 1 = AM (LW/MW/SW) and SSB (if SSB patch apllied)]
+ * @param uint8_t OPMODE set the kind of audio mode you want to use.
  */
-void SI4735::setAM()
+void SI4735::setPowerUp(uint8_t CTSIEN, uint8_t GPO2OEN, uint8_t PATCH, uint8_t XOSCEN, uint8_t FUNC, uint8_t OPMODE)
 {
-    // If you’re already using AM mode, it is not necessary to call powerDown and radioPowerUp.
-    // The other properties also should have the same value as the previous status.
-    if (lastMode != AM_CURRENT_MODE)
+    powerUp.arg.CTSIEN = CTSIEN;   // 1 -> Interrupt anabled;
+    powerUp.arg.GPO2OEN = GPO2OEN; // 1 -> GPO2 Output Enable;
+    powerUp.arg.PATCH = PATCH;     // 0 -> Boot normally;
+    powerUp.arg.XOSCEN = XOSCEN;   // 1 -> Use external crystal oscillator;
+    powerUp.arg.FUNC = FUNC;       // 0 = FM Receive; 1 = AM/SSB (LW/MW/SW) Receiver.
+    powerUp.arg.OPMODE = OPMODE;   // 0x5 = 00000101 = Analog audio outputs (LOUT/ROUT).
+
+    // Set the current tuning frequancy mode 0X20 = FM and 0x40 = AM (LW/MW/SW)
+    // See See Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 55 and 124
+
+    this->currentClockType = XOSCEN;
+
+    if (FUNC == 0)
     {
-        powerDown();
-        setPowerUp(this->currentInterruptEnable, 0, 0, this->currentClockType, AM_CURRENT_MODE, currentAudioMode);
-        radioPowerUp();
-        setAvcAmMaxGain(currentAvcAmMaxGain); // Set AM Automatic Volume Gain to 48
-        setVolume(volume);                    // Set to previus configured volume
+        currentTune = FM_TUNE_FREQ;
+        currentFrequencyParams.arg.FREEZE = 1;
     }
-    currentSsbStatus = 0;
-    lastMode = AM_CURRENT_MODE;
+    else
+    {
+        currentTune = AM_TUNE_FREQ;
+        currentFrequencyParams.arg.FREEZE = 0;
+    }
+    currentFrequencyParams.arg.FAST = 1;
+    currentFrequencyParams.arg.DUMMY1 = 0;
+    currentFrequencyParams.arg.ANTCAPH = 0;
+    currentFrequencyParams.arg.ANTCAPL = 1;
 }
 
 /**
- * @ingroup group08 Set mode and Band
- * 
- * @todo Adjust the power up parameters
+ * @ingroup group07 Device Power Up 
  * 
- * @brief Sets the radio to FM function
+ * @brief Powerup the Si47XX
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 64. 
- */
-void SI4735::setFM()
-{
-    powerDown();
-    setPowerUp(this->currentInterruptEnable, 0, 0, this->currentClockType, FM_CURRENT_MODE, currentAudioMode);
-    radioPowerUp();
-    setVolume(volume); // Set to previus configured volume
-    currentSsbStatus = 0;
-    disableFmDebug();
-    lastMode = FM_CURRENT_MODE;
-}
-
-/**
- * @ingroup group08 Set mode and Band
+ * @details Before call this function call the setPowerUp to set up the parameters.
  * 
- * @brief Sets the radio to AM (LW/MW/SW) function. 
+ * @details Parameters you have to set up with setPowerUp
  * 
- * @details The example below sets the band from 550kHz to 1750kHz on AM mode. The band will start on 810kHz and step is 10kHz. 
+ * | Parameter | Description |
+ * | --------- | ----------- |
+ * | CTSIEN    | Interrupt anabled or disabled |
+ * | GPO2OEN   | GPO2 Output Enable or disabled |
+ * | PATCH     | Boot normally or patch |
+ * | XOSCEN    | Use external crystal oscillator. 1 = Use crystal oscillator;  (crystal oscillator disabled) |
+ * | FUNC      | defaultFunction = 0 = FM Receive; 1 = AM (LW/MW/SW) Receiver |
+ * | OPMODE    | SI473X_ANALOG_AUDIO (B00000101) or SI473X_DIGITAL_AUDIO (B00001011) |
  * 
- * @code
- * si4735.setAM(520, 1750, 810, 10); 
- * @endcode
- *  
- * @see setFM()
- * @see setSSB()
+ * ATTENTION: The document AN383; "Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES"; rev 0.8; page 6; there is the following note:
+ *            Crystal and digital audio mode cannot be used at the same time. Populate R1 and remove C10, C11, and X1 when using digital audio.
  * 
- * @param fromFreq minimum frequency for the band
- * @param toFreq maximum frequency for the band
- * @param initialFreq initial frequency 
- * @param step step used to go to the next channel
+ *see setMaxDelaySetFrequency()
+ * @see MAX_DELAY_AFTER_POWERUP 
+ * @see  SI4735::setPowerUp()
+ * @see  Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 64, 129
  */
-void SI4735::setAM(uint16_t fromFreq, uint16_t toFreq, uint16_t initialFreq, uint16_t step)
+void SI4735::radioPowerUp(void)
 {
+    // delayMicroseconds(1000);
+    sendCommand(POWER_UP, 2, powerUp.raw); // ARG1 and ARG2
+    // Delay at least 500 ms between powerup command and first tune command to wait for
+    // the oscillator to stabilize if XOSCEN is set and crystal is used as the RCLK.
+    waitToSend();
+    waitMicroseconds(maxDelayAfterPouwerUp * 1000UL);
 
-    currentMinimumFrequency = fromFreq;
-    currentMaximumFrequency = toFreq;
-    currentStep = step;
-
-    if (initialFreq < fromFreq || initialFreq > toFreq)
-        initialFreq = fromFreq;
-
-    setAM();
-    currentWorkFrequency = initialFreq;
-    setFrequency(currentWorkFrequency);
+    completePowerUp();
 }
 
 /**
- * @ingroup group08 Set mode and Band
- * 
- * @brief Sets the radio to FM function. 
- * 
- * @details Defines the band range you want to use for the FM mode. 
- * 
- * @details The example below sets the band from 64MHz to 108MHzkHz on FM mode. The band will start on 103.9MHz and step is 100kHz.
- * On FM mode, the step 10 means 100kHz. If you want a 1MHz step, use 100.     
- * 
- * @code
- * si4735.setFM(6400, 10800, 10390, 10);
- * @endcode
+ * @ingroup group07 Device Power Up 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 70
- * @see setFM()
- * @see setFrequencyStep()
+ * @brief Finishes the power up sequence (interrupt sources, external mute circuit and reference clock).
+ * @details Called after the POWER_UP command is done. 
  * 
- * @param fromFreq minimum frequency for the band
- * @param toFreq maximum frequency for the band
- * @param initialFreq initial frequency (default frequency)
- * @param step step used to go to the next channel   
+ * @see radioPowerUp, beginModeChange
  */
-void SI4735::setFM(uint16_t fromFreq, uint16_t toFreq, uint16_t initialFreq, uint16_t step)
+void SI4735::completePowerUp()
 {
-    currentMinimumFrequency = fromFreq;
-    currentMaximumFrequency = toFreq;
-    currentStep = step;
-
-    if (initialFreq < fromFreq || initialFreq > toFreq)
-        initialFreq = fromFreq;
+    // The CTSIEN and GPO2OEN power up arguments tell if the device will pulse GPO2/INT when CTS is set.
+    this->ctsInterruptArmed = powerUp.arg.CTSIEN && powerUp.arg.GPO2OEN && this->currentInterruptEnable;
+    // The STC interrupt source has to be armed after each power up.
+    if (this->waitMode == WAIT_MODE_INTERRUPT && this->ctsInterruptArmed)
+        setGpioIen(1, 0, 0, 1, 0, 0);
 
-    setFM();
+    // Turns the external mute circuit off
+    if (audioMuteMcuPin >= 0)
+        setHardwareAudioMute(false);
 
-    currentWorkFrequency = initialFreq;
-    setFrequency(currentWorkFrequency);
+    if (this->currentClockType == 0)
+    {
+        setRefClock(this->refClock);
+        setRefClockPrescaler(this->refClockPrescale, this->refClockSourcePin);
+    }
 }
 
-/** @defgroup group08 Tune */
-
 /**
- * @ingroup group08 Set bandwidth
- * 
- * @brief Selects the bandwidth of the channel filter for AM reception. 
- * 
- * @details The choices are 6, 4, 3, 2, 2.5, 1.8, or 1 (kHz). The default bandwidth is 2 kHz. It works only in AM / SSB (LW/MW/SW) 
- * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 125, 151, 277, 181.
+ * @ingroup group07 Device Power Up 
  * 
- * @param AMCHFLT the choices are:   0 = 6 kHz Bandwidth                    
- *                                   1 = 4 kHz Bandwidth
- *                                   2 = 3 kHz Bandwidth
- *                                   3 = 2 kHz Bandwidth
- *                                   4 = 1 kHz Bandwidth
- *                                   5 = 1.8 kHz Bandwidth
- *                                   6 = 2.5 kHz Bandwidth, gradual roll off
- *                                   7–15 = Reserved (Do not use).
- * @param AMPLFLT Enables the AM Power Line Noise Rejection Filter.
+ * @brief You have to call setPowerUp method before. 
+ * @details This function is still available only for legacy reasons. 
+ *          If you are using this function, please, replace it by radioPowerup().
+ * @deprecated Use radioPowerUp instead.
+ * @see  SI4735::setPowerUp()
+ * @see  Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 64, 129
  */
-void SI4735::setBandwidth(uint8_t AMCHFLT, uint8_t AMPLFLT)
+void SI4735::analogPowerUp(void)
 {
-    si47x_bandwidth_config filter;
-    si47x_property property;
-
-    if (currentTune != AM_TUNE_FREQ) // Only for AM/SSB mode
-        return;
-
-    if (AMCHFLT > 6)
-        return;
-
-    filter.raw[0] = filter.raw[1] = 0;
-
-    property.value = AM_CHANNEL_FILTER;
-
-    filter.param.AMCHFLT = AMCHFLT;
-    filter.param.AMPLFLT = AMPLFLT;
-
-    waitToSend();
-    this->volume = volume;
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(SET_PROPERTY);
-    Wire.write(0x00);                  // Always 0x00
-    Wire.write(property.raw.byteHigh); // High byte first
-    Wire.write(property.raw.byteLow);  // Low byte after
-    Wire.write(filter.raw[1]);         // Raw data for AMCHFLT and
-    Wire.write(filter.raw[0]);         // AMPLFLT
-    Wire.endTransmission();
-    waitToSend();
+    radioPowerUp();
 }
 
-/**
- * @ingroup group08 Frequency 
+/** 
+ * @ingroup group07 Device Power Down 
  * 
- * @brief Gets the current frequency of the Si4735 (AM or FM)
+ * @brief Moves the device from powerup to powerdown mode.
  * 
- * @details The method status do it an more. See getStatus below. 
+ * @details After Power Down command, only the Power Up command is accepted.
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 73 (FM) and 139 (AM)
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 67, 132
+ * @see radioPowerUp()
  */
-uint16_t SI4735::getFrequency()
+void SI4735::powerDown(void)
 {
-    si47x_frequency freq;
-    getStatus(0, 1);
-
-    freq.raw.FREQL = currentStatus.resp.READFREQL;
-    freq.raw.FREQH = currentStatus.resp.READFREQH;
+    // Turns the external mute circuit on
+    if (audioMuteMcuPin >= 0)
+        setHardwareAudioMute(true);
 
-    currentWorkFrequency = freq.value;
-    return freq.value;
+    sendCommand(POWER_DOWN, 0, NULL);
+    waitMicroseconds(2500);
 }
 
 /**
- * @ingroup group08 Frequency 
- * 
- * @brief Gets the current status  of the Si4735 (AM or FM)
+ * @ingroup group07 Firmware Information 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 73 (FM) and 139 (AM)
+ * @brief Gets firmware information 
+ * @details The firmware information will be stored in firmwareInfo member variable 
  * 
- * @param uint8_t INTACK Seek/Tune Interrupt Clear. If set, clears the seek/tune complete interrupt status indicator;
- * @param uint8_t CANCEL Cancel seek. If set, aborts a seek currently in progress;
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 66, 131
+ * @see firmwareInfo
  */
-void SI4735::getStatus(uint8_t INTACK, uint8_t CANCEL)
+void SI4735::getFirmware(void)
 {
-    si47x_tune_status status;
-    uint8_t cmd;
-
-    if (currentTune == FM_TUNE_FREQ)
-        cmd = FM_TUNE_STATUS;
-    else if (currentTune == AM_TUNE_FREQ)
-        cmd = AM_TUNE_STATUS;
-    else if (currentTune == NBFM_TUNE_FREQ)
-        cmd = NBFM_TUNE_STATUS;
-
-    waitToSend();
-
-    status.arg.INTACK = INTACK;
-    status.arg.CANCEL = CANCEL;
-    status.arg.RESERVED2 = 0;
+    sendCommand(GET_REV, 0, NULL);
 
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(cmd);
-    Wire.write(status.raw);
-    Wire.endTransmission();
-    // Reads the current status (including current frequency).
-    do
+    // Request for 9 bytes response
+    getCommandResponse(9, firmwareInfo.raw);
+    while (firmwareInfo.resp.ERR)
     {
-        waitToSend();
-        Wire.requestFrom(deviceAddress, 8); // Check it
-        // Gets response information
-        for (uint8_t i = 0; i < 8; i++)
-            currentStatus.raw[i] = Wire.read();
-    } while (currentStatus.resp.ERR); // If error, try it again
-    waitToSend();
+        statsErrRetry();
+        getCommandResponse(9, firmwareInfo.raw);
+    }
 }
 
 /**
- * @ingroup group08 AGC 
- * 
- * @brief Queries Automatic Gain Control STATUS
+ * @ingroup group07 
+ * @brief Sets the frequency of the REFCLK from the output of the prescaler
+ * @details The REFCLK range is 31130 to 34406 Hz (32768 ±5% Hz) in 1 Hz steps, or 0 (to disable AFC). For example, an RCLK of 13 MHz would require a prescaler value of 400 to divide it to 32500 Hz REFCLK.
+ * @details The reference clock frequency property would then need to be set to 32500 Hz. 
+ * @details RCLK frequencies between 31130 Hz and 40 MHz are supported, however, there are gaps in frequency coverage for prescaler values ranging from 1 to 10, or frequencies up to 311300 Hz. See table below.
  * 
- * @details After call this method, you can call isAgcEnabled to know the AGC status and getAgcGainIndex to know the gain index value.
- * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); For FM page 80; for AM page 142.
- * @see AN332 REV 0.8 Universal Programming Guide Amendment for SI4735-D60 SSB and NBFM patches; page 18. 
+ * Table REFCLK Prescaler
+ * | Prescaler  | RCLK Low (Hz) | RCLK High (Hz)   |
+ * | ---------- | ------------- | ---------------- | 
+ * |    1       |   31130       |   34406          |
+ * |    2       |   62260       |   68812          |
+ * |    3       |   93390       |  103218          |
+ * |    4       |  124520       |  137624          |
+ * |    5       |  155650       |  172030          | 
+ * |    6       |  186780       |  206436          |
+ * |    7       |  217910       |  240842          | 
+ * |    8       |  249040       |  275248          | 
+ * |    9       |  280170       |  309654          | 
+ * |   10       |  311300       |  344060          |       
+ *  
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 34 and 35
  * 
+ * @param refclk The allowed REFCLK frequency range is between 31130 and 34406 Hz (32768 ±5%), or 0 (to disable AFC).
  */
-void SI4735::getAutomaticGainControl()
+void SI4735::setRefClock(uint16_t refclk)
 {
-    uint8_t cmd;
-
-    if (currentTune == FM_TUNE_FREQ) { // FM TUNE
-        cmd = FM_AGC_STATUS;
-    }
-    else if (currentTune == NBFM_TUNE_FREQ) {
-        cmd = NBFM_AGC_STATUS;
-    }
-    else { // AM TUNE - SAME COMMAND used on SSB mode
-        cmd = AM_AGC_STATUS;
-    }
-
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(cmd);
-    Wire.endTransmission();
-
-    do
-    {
-        waitToSend();
-        Wire.requestFrom(deviceAddress, 3);
-        currentAgcStatus.raw[0] = Wire.read(); // STATUS response
-        currentAgcStatus.raw[1] = Wire.read(); // RESP 1
-        currentAgcStatus.raw[2] = Wire.read(); // RESP 2
-    } while (currentAgcStatus.refined.ERR);    // If error, try get AGC status again.
+    sendProperty(REFCLK_FREQ, refclk);
+    this->refClock = refclk;
 }
 
-/** 
- * @ingroup group08 AGC 
+/**
+ * @ingroup group07
+ * @brief Sets the number used by the prescaler to divide the external RCLK down to the internal REFCLK. 
+ * @details The range may be between 1 and 4095 in 1 unit steps. 
+ * @details For example, an RCLK of 13 MHz would require a prescaler value of 400 to divide it to 32500 Hz. The reference clock frequency property would then need to be set to 32500 Hz. 
+ * @details ATTENTION by default, this function considers you are using the RCLK pin as clock source. 
  * 
- * @brief Automatic Gain Control setup 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 34 and 35
  * 
- * @details If FM, overrides AGC setting by disabling the AGC and forcing the LNA to have a certain gain that ranges between 0 
- * (minimum attenuation) and 26 (maximum attenuation).
- * @details If AM/SSB, Overrides the AGC setting by disabling the AGC and forcing the gain index that ranges between 0 
- * (minimum attenuation) and 37+ATTN_BACKUP (maximum attenuation).
+ * @param prescale  Prescaler for Reference Clock value; Between 1 and 4095 in 1 unit steps. Default is 1. 
+ * @param rclk_sel  0 = RCLK pin is clock source (default); 1 = DCLK pin is clock source
+ */
+void SI4735::setRefClockPrescaler(uint16_t prescale, uint8_t rclk_sel)
+{
+    sendProperty(REFCLK_PRESCALE, prescale); //| (rclk_sel << 13)); // Sets the D12 to rclk_sel
+    this->refClockPrescale = prescale;
+    this->refClockSourcePin = rclk_sel;
+}
+
+/** 
+ * @ingroup   group07 Device start up 
+ *  
+ * @brief Starts the Si473X device. 
+ *
+ * @details Use this function to start the device up with the parameters shown below.
+ * @details If the audio mode parameter is not entered, analog mode will be considered.
+ * @details You can use any Arduino digital pin. Be sure you are using less than 3.6V on Si47XX RST pin.   
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); For FM page 81; for AM page 143 
+ * ATTENTION: The document AN383; "Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES"; rev 0.8; page 6; there is the following note:
+ *            Crystal and digital audio mode cannot be used at the same time. Populate R1 and remove C10, C11, and X1 when using digital audio.
  * 
- * @param uint8_t AGCDIS This param selects whether the AGC is enabled or disabled (0 = AGC enabled; 1 = AGC disabled);
- * @param uint8_t AGCIDX AGC Index (0 = Minimum attenuation (max gain); 1 – 36 = Intermediate attenuation); 
- *                if >greater than 36 - Maximum attenuation (min gain) ).
+ * @param resetPin Digital Arduino Pin used to RESET de Si47XX device. 
+ * @param interruptPin interrupt Arduino Pin (see your Arduino pinout). If less than 0, iterrupt disabled.
+ * @param defaultFunction is the mode you want the receiver starts.
+ * @param audioMode default SI473X_ANALOG_AUDIO (Analog Audio). Use SI473X_ANALOG_AUDIO or SI473X_DIGITAL_AUDIO.
+ * @param clockType 0 = Use external RCLK (crystal oscillator disabled); 1 = Use crystal oscillator 
  */
-void SI4735::setAutomaticGainControl(uint8_t AGCDIS, uint8_t AGCIDX)
+void SI4735::setup(uint8_t resetPin, int interruptPin, uint8_t defaultFunction, uint8_t audioMode, uint8_t clockType)
 {
-    si47x_agc_overrride agc;
+    this->currentInterruptEnable = 0;
+    transport->begin();
 
-    uint8_t cmd;
+    this->resetPin = resetPin;
+    this->interruptPin = interruptPin;
 
-    // cmd = (currentTune == FM_TUNE_FREQ) ? FM_AGC_OVERRIDE : AM_AGC_OVERRIDE; // AM_AGC_OVERRIDE = SSB_AGC_OVERRIDE = 0x48
+    // Arduino interrupt setup (you have to know which Arduino Pins can deal with interrupt).
+    if (interruptPin >= 0)
+    {
+        pinMode(interruptPin, INPUT);
+        attachInterruptHandler();
+        this->currentInterruptEnable = (interruptSlot >= 0);
+    }
 
-    if (currentTune == FM_TUNE_FREQ)
-        cmd = FM_AGC_OVERRIDE;
-    else if (currentTune == FM_TUNE_FREQ)
-        cmd = NBFM_AGC_OVERRIDE;
-    else
-        cmd = AM_AGC_OVERRIDE;
+    interruptFlag = false;
 
-    agc.arg.AGCDIS = AGCDIS;
-    agc.arg.AGCIDX = AGCIDX;
+    currentAudioMode = audioMode;
 
-    waitToSend();
+    // Set the initial SI473X behavior
+    // CTSIEN   interruptEnable -> Interrupt anabled or disable;
+    // GPO2OEN  interruptEnable -> GPO2 Output Enable (the GPO2/INT pin has to drive the interrupt pin);
+    // PATCH    0 -> Boot normally;
+    // XOSCEN   clockType -> Use external crystal oscillator (XOSCEN_CRYSTAL) or reference clock (XOSCEN_RCLK);
+    // FUNC     defaultFunction = 0 = FM Receive; 1 = AM (LW/MW/SW) Receiver.
+    // OPMODE   SI473X_ANALOG_AUDIO or SI473X_DIGITAL_AUDIO.
 
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(cmd);
-    Wire.write(agc.raw[0]);
-    Wire.write(agc.raw[1]);
-    Wire.endTransmission();
+    setPowerUp(this->currentInterruptEnable, this->currentInterruptEnable, 0, clockType, defaultFunction, audioMode);
 
-    waitToSend();
+    if (audioMuteMcuPin >= 0)
+        setHardwareAudioMute(true); // If you are using external citcuit to mute the audio, it turns the audio mute
+
+    reset();
+
+    radioPowerUp();
+    setVolume(30); // Default volume level.
+    getFirmware();
 }
 
-/**
- * @ingroup group08 Automatic Volume Control
+/** 
+ * @ingroup   group07 Device start up 
  * 
- * @brief Sets the maximum gain for automatic volume control.
- *  
- * @details If no parameter is sent, it will be consider 48dB.
+ * @brief  Starts the Si473X device.  
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 152
- * @see setAvcAmMaxGain()
+ * @details Use this setup if you are not using interrupt resource.
+ * @details If the audio mode parameter is not entered, analog mode will be considered.
+ * @details You can use any Arduino digital pin. Be sure you are using less than 3.6V on Si47XX RST pin.   
  * 
- * @param uint8_t gain  Select a value between 12 and 192.  Defaul value 48dB.
+ * @param uint8_t resetPin Digital Arduino Pin used to RESET command. 
+ * @param uint8_t defaultFunction. 0 =  FM mode; 1 = AM 
  */
-void SI4735::setAvcAmMaxGain(uint8_t gain)
+void SI4735::setup(uint8_t resetPin, uint8_t defaultFunction)
 {
-    uint16_t aux;
-    aux = (gain > 12 && gain < 193) ? (gain * 340) : (48 * 340);
-    currentAvcAmMaxGain = gain;
-    sendProperty(AM_AUTOMATIC_VOLUME_CONTROL_MAX_GAIN, aux);
+    setup(resetPin, -1, defaultFunction, SI473X_ANALOG_AUDIO, XOSCEN_CRYSTAL);
+    waitMicroseconds(250000);
 }
 
+/** @defgroup group08 Tune, Device Mode and Filter setup */
+
 /**
- * @ingroup group08 Received Signal Quality
+ * @ingroup   group08 Internal Antenna Tuning capacitor
  * 
- * @brief Queries the status of the Received Signal Quality (RSQ) of the current channel.
+ * @brief Selects the tuning capacitor value.
  * 
- * @details This method sould be called berore call getCurrentRSSI(), getCurrentSNR() etc.
- * Command FM_RSQ_STATUS
+ * @details On FM mode, the Antenna Tuning Capacitor is valid only when using TXO/LPI pin as the antenna input.
+ * This selects the value of the antenna tuning capacitor manually, or automatically if set to zero. 
+ * The valid range is 0 to 191. Automatic capacitor tuning is recommended. 
+ * For example, if the varactor is set to a value of 5 manually, when read back the value will be 1. 
+ * @details on AM mode, If the value is set to anything other than 0, the tuning capacitance is manually set as 95 fF x ANTCAP + 7 pF. 
+ * ANTCAP manual range is 1–6143. Automatic capacitor tuning is recommended. In SW mode, ANTCAPH[15:8] (high byte) needs to be set to 0 and ANTCAPL[7:0] (low byte) needs to be set to 1. 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 75 and 141
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 71 and 136
  * 
- * @param INTACK Interrupt Acknowledge. 
- *        0 = Interrupt status preserved; 
- *        1 = Clears RSQINT, BLENDINT, SNRHINT, SNRLINT, RSSIHINT, RSSILINT, MULTHINT, MULTLINT.
+ * @param capacitor If zero, the tuning capacitor value is selected automatically. 
+ *                  If the value is set to anything other than 0:
+ *                  AM - the tuning capacitance is manually set as 95 fF x ANTCAP + 7 pF. 
+ *                       ANTCAP manual range is 1–6143;
+ *                  FM - the valid range is 0 to 191.    
+ *                  According to Silicon Labs, automatic capacitor tuning is recommended (value 0). 
  */
-void SI4735::getCurrentReceivedSignalQuality(uint8_t INTACK)
+void SI4735::setTuneFrequencyAntennaCapacitor(uint16_t capacitor)
 {
-    uint8_t arg;
-    uint8_t cmd;
-    int sizeResponse;
+    si47x_antenna_capacitor cap;
 
-    if (currentTune == FM_TUNE_FREQ)
-    { // FM TUNE
-        cmd = FM_RSQ_STATUS;
-        sizeResponse = 8; 
+    cap.value = capacitor;
+
+    currentFrequencyParams.arg.DUMMY1 = 0;
+
+    if (currentTune != AM_TUNE_FREQ) 
+    {
+        // For FM, the capacitor value has just one byte
+        currentFrequencyParams.arg.ANTCAPH = (capacitor <= 191) ? cap.raw.ANTCAPL : 0;
     }
-    else if (currentTune == NBFM_TUNE_FREQ) {
-        cmd = NBFM_RSQ_STATUS;
-        sizeResponse = 8; // Check it
-    } 
     else
-    { // AM TUNE
-        cmd = AM_RSQ_STATUS;
-        sizeResponse = 6; // Check it
+    {
+        if (capacitor <= 6143)
+        {
+            currentFrequencyParams.arg.FREEZE = 0; // This parameter is not used for AM
+            currentFrequencyParams.arg.ANTCAPH = cap.raw.ANTCAPH;
+            currentFrequencyParams.arg.ANTCAPL = cap.raw.ANTCAPL;
+        }
     }
+    // Tune the device again with the current frequency.
+    this->setFrequency(this->currentWorkFrequency);
+}
 
-    waitToSend();
+/**
+ * @ingroup   group08 Tune Frequency 
+ * 
+ * @brief Set the frequency to the corrent function of the Si4735 (FM, AM or SSB)
+ * 
+ * @details You have to call setup or setPowerUp before call setFrequency.
+ * @details Returns when the device signals Seek/Tune Complete (STC interrupt in WAIT_MODE_INTERRUPT; otherwise, STCINT polling).
+ * 
+ * @see setWaitMode, waitStc
+ * @see maxDelaySetFrequency()
+ * @see MAX_DELAY_AFTER_SET_FREQUENCY
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 70, 135
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 13
+ * 
+ * @param uint16_t  freq is the frequency to change. For example, FM => 10390 = 103.9 MHz; AM => 810 = 810 kHz.
+ */
+void SI4735::setFrequency(uint16_t freq)
+{
+    uint32_t start;
+    uint8_t polls = 0;
+    bool settled;
 
-    arg = INTACK;
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(cmd);
-    Wire.write(arg); // send B00000001
-    Wire.endTransmission();
-
-    // Check it
-    // do
-    //{
-    waitToSend();
-    Wire.requestFrom(deviceAddress, sizeResponse);
-    // Gets response information
-    for (uint8_t i = 0; i < sizeResponse; i++)
-        currentRqsStatus.raw[i] = Wire.read();
-    //} while (currentRqsStatus.resp.ERR); // Try again if error found
+    startTune(freq);
+    start = micros();
+    waitToSend();                // Wait for the si473x is ready.
+    currentWorkFrequency = freq; // check it
+    // Waits for the tune complete. maxDelaySetFrequency is the upper bound.
+    settled = waitStc((currentTune == AM_TUNE_FREQ) ? LATENCY_AM_STC : LATENCY_FM_STC, maxDelaySetFrequency);
+    if (settled && settleTolerance != 0)
+        settled = waitSignalSettle(start, maxDelaySetFrequency, &polls);
+    statsSettle(micros() - start, settled, polls);
 }
 
 /**
- * @ingroup group08 Received Signal Quality
+ * @ingroup group08 Tune Frequency 
  * 
- * @brief Queries the status of the Received Signal Quality (RSQ) of the current channel (FM_RSQ_STATUS)
+ * @brief Waits for the RSSI and SNR to settle after a tune (see setSettleDetection)
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 75 and 141
+ * @details Reads the RSSI and SNR (RSQ status) every SETTLE_POLL_INTERVAL us until two readings differ by settleTolerance dB or less.
  * 
- * @param INTACK Interrupt Acknowledge. 
- *        0 = Interrupt status preserved; 
- *        1 = Clears RSQINT, BLENDINT, SNRHINT, SNRLINT, RSSIHINT, RSSILINT, MULTHINT, MULTLINT.
+ * @param start micros() when the tune command was sent
+ * @param maxDelay max time in ms since start
+ * @param polls incremented by the number of RSQ reads (up to 255)
+ * @return true if the signal settled; false if maxDelay has elapsed
  */
-void SI4735::getCurrentReceivedSignalQuality(void)
+bool SI4735::waitSignalSettle(uint32_t start, uint16_t maxDelay, uint8_t *polls)
 {
-    getCurrentReceivedSignalQuality(0);
+    uint32_t limit = maxDelay * 1000UL;
+    uint8_t rssi, snr;
+
+    getCurrentReceivedSignalQuality(0, FIELD_RSSI | FIELD_SNR);
+    do
+    {
+        if (*polls < 255)
+            (*polls)++;
+        rssi = currentRqsStatus.resp.RSSI;
+        snr = currentRqsStatus.resp.SNR;
+        if ((micros() - start) >= limit)
+            return false;
+        waitMicroseconds(SETTLE_POLL_INTERVAL);
+        getCurrentReceivedSignalQuality(0, FIELD_RSSI | FIELD_SNR);
+    } while (((rssi > currentRqsStatus.resp.RSSI) ? rssi - currentRqsStatus.resp.RSSI : currentRqsStatus.resp.RSSI - rssi) > settleTolerance ||
+             ((snr > currentRqsStatus.resp.SNR) ? snr - currentRqsStatus.resp.SNR : currentRqsStatus.resp.SNR - snr) > settleTolerance);
+
+    if (*polls < 255)
+        (*polls)++;
+    return true;
 }
 
 /**
- * @ingroup group08 Seek 
+ * @ingroup group08 Tune Frequency 
  * 
- * @brief Look for a station (Automatic tune)
- * @details Starts a seek process for a channel that meets the RSSI and SNR criteria for AM.  
- * @details __This function does not work on SSB mode__.  
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 55, 72, 125 and 137
+ * @brief Sends the tune command (FM_TUNE_FREQ, AM_TUNE_FREQ or SSB_TUNE_FREQ) and returns.
  * 
- * @param SEEKUP Seek Up/Down. Determines the direction of the search, either UP = 1, or DOWN = 0. 
- * @param Wrap/Halt. Determines whether the seek should Wrap = 1, or Halt = 0 when it hits the band limit.
+ * @see setFrequency, beginSetFrequency
+ * 
+ * @param uint16_t  freq is the frequency to change. For example, FM => 10390 = 103.9 MHz; AM => 810 = 810 kHz. 
  */
-void SI4735::seekStation(uint8_t SEEKUP, uint8_t WRAP)
+void SI4735::startTune(uint16_t freq)
 {
-    si47x_seek seek;
-    si47x_seek_am_complement seek_am_complement;
+    currentFrequency.value = freq;
+    currentFrequencyParams.arg.FREQH = currentFrequency.raw.FREQH;
+    currentFrequencyParams.arg.FREQL = currentFrequency.raw.FREQL;
 
-    // Check which FUNCTION (AM or FM) is working now
-    uint8_t seek_start_cmd = (currentTune == FM_TUNE_FREQ) ? FM_SEEK_START : AM_SEEK_START;
-
-    waitToSend();
-
-    seek.arg.SEEKUP = SEEKUP;
-    seek.arg.WRAP = WRAP;
-    seek.arg.RESERVED1 = 0;
-    seek.arg.RESERVED2 = 0;
-
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(seek_start_cmd);
-    Wire.write(seek.raw); // ARG1
-
-    if (seek_start_cmd == AM_SEEK_START) // Sets additional configuration for AM mode
+    if (currentSsbStatus != 0)
     {
-        seek_am_complement.ARG2 = seek_am_complement.ARG3 = 0;
-        seek_am_complement.ANTCAPH = 0;
-        seek_am_complement.ANTCAPL = (currentWorkFrequency > 1800) ? 1 : 0; // if SW = 1
-        Wire.write(seek_am_complement.ARG2);                                // ARG2 - Always 0
-        Wire.write(seek_am_complement.ARG3);                                // ARG3 - Always 0
-        Wire.write(seek_am_complement.ANTCAPH);                             // ARG4 - Tuning Capacitor: The tuning capacitor value
-        Wire.write(seek_am_complement.ANTCAPL);                             // ARG5 - will be selected automatically.
+        currentFrequencyParams.arg.DUMMY1 = 0;
+        currentFrequencyParams.arg.USBLSB = currentSsbStatus; // Set to LSB or USB
+        currentFrequencyParams.arg.FAST = 1;                  // Used just on AM and FM
+        currentFrequencyParams.arg.FREEZE = 0;                // Used just on FM
     }
 
-    Wire.endTransmission();
-    delay(MAX_DELAY_AFTER_SET_FREQUENCY << 2);
+    // ARG1 (FAST and FREEZE information; if not FM must be 0), FREQH, FREQL and ANTCAPH.
+    // If current tune is not FM (AM or SSB) sends one more byte (ANTCAPL).
+    sendCommand(currentTune, (currentTune == AM_TUNE_FREQ) ? 5 : 4, currentFrequencyParams.raw);
 }
 
 /**
- * @ingroup group08 Seek 
- * 
- * @brief Search for the next station.
- * @details Like seekStationUp this function goes to a next station.  
- * @details The main difference is the method used to look for a station.
+ * @ingroup group08 Tune Frequency 
+ *  
+ * @brief Increments the current frequency on current band/function by using the current step.
+ * @details If tune coalescing is enabled (see setTuneCoalescing), the tune is queued and the function returns immediately.
  * 
- * @see seekStation, seekStationUp, seekStationDown, seekPreviousStation, seekStationProgress
+ * @see setFrequencyStep(), setTuneCoalescing()
  */
-void SI4735::seekNextStation()
+void SI4735::frequencyUp()
 {
-    seekStation(1, 1);
-    delay(maxDelaySetFrequency);
-    getFrequency();
+    if (currentWorkFrequency >= currentMaximumFrequency)
+        currentWorkFrequency = currentMinimumFrequency;
+    else
+        currentWorkFrequency += currentStep;
+
+    if (tuneCoalescing)
+        queueFrequency(currentWorkFrequency);
+    else
+        setFrequency(currentWorkFrequency);
 }
 
 /**
- * @ingroup group08 Seek 
+ * @ingroup group08 Tune Frequency 
  * 
- * @brief Search the previous station
- * @details Like seekStationDown this function goes to a previous station.  
- * @details The main difference is the method used to look for a station.
- * @see seekStation, seekStationUp, seekStationDown, seekPreviousStation, seekStationProgress
+ * @brief Decrements the current frequency on current band/function by using the current step.
+ * @details If tune coalescing is enabled (see setTuneCoalescing), the tune is queued and the function returns immediately.
+ *  
+ * @see setFrequencyStep(), setTuneCoalescing()
  */
-void SI4735::seekPreviousStation()
+void SI4735::frequencyDown()
 {
-    seekStation(0, 1);
-    delay(maxDelaySetFrequency);
-    getFrequency();
+
+    if (currentWorkFrequency <= currentMinimumFrequency)
+        currentWorkFrequency = currentMaximumFrequency;
+    else
+        currentWorkFrequency -= currentStep;
+
+    if (tuneCoalescing)
+        queueFrequency(currentWorkFrequency);
+    else
+        setFrequency(currentWorkFrequency);
 }
 
 /**
- * @ingroup group08 Seek 
- * @brief Seeks a station up or down.
- * @details Seek up or down a station and call a function defined by the developer to show the frequency. 
- * @details The first parameter of this function is a name of your function that you have to implement to show the current frequency. 
- * @details If you do not want to show the seeking progress,  you can set NULL instead the name of the function.   
- * @details The code below shows an example using ta function the shows the current frequency on he Serial Monitor. You might want to implement a function that shows the frequency on your display device. 
- * @details Also, you have to declare the frequency parameter that will be used by the function to show the frequency value. 
- * @details __This function does not work on SSB mode__. 
- * @code
- * void showFrequency( uint16_t freq ) {
- *    Serial.print(freq); 
- *    Serial.println("MHz ");
- * }
+ * @ingroup group08 Tune Frequency 
  * 
- * void loop() {
+ * @brief Tunes a frequency without waiting. Requests made while a tune is running are coalesced.
  * 
- *  receiver.seekStationProgress(showFrequency,1); // Seek Up
- *  .
- *  .
- *  .
- *  receiver.seekStationProgress(showFrequency,0); // Seek Down
+ * @details If no asynchronous operation is running, the tune is started at once (see beginSetFrequency). Otherwise, the 
+ * @details frequency becomes the target: it replaces any target not sent yet and is tuned by service() as soon as the running 
+ * @details operation is done (STC). Only the last target is sent. So, fast encoder spins do not queue dozens of tunes.
+ * @details The current frequency (getCurrentFrequency) is the target at once. The callback (see setAsyncCallback) is called 
+ * @details only when the last target is tuned. Call service() from your loop().
+ * @details During a band scan, bandscope or seek, the target waits for the end of the operation. The scan table and the bandscope 
+ * @details bins keep their own frequencies, and the seek position no longer changes the current frequency.
  * 
- * }
+ * @code
+ *   void loop() {
+ *      if (encoderCount > 0) rx.frequencyUp(); // with setTuneCoalescing(true)
+ *      ...
+ *      rx.service();
+ *      showFrequency(rx.getCurrentFrequency());
+ *   }
  * @endcode
  * 
- * @see seekStation, seekStationUp, seekStationDown, getStatus, setMaxSeekTime   
- * @param showFunc  function that you have to implement to show the frequency during the seeking process. Set NULL if you do not want to show the progress. 
- * @param up_down   set up_down = 1 for seeking station up; set up_down = 0 for seeking station down
+ * @see setTuneCoalescing, frequencyUp, frequencyDown, service
+ * 
+ * @param freq frequency. For example, FM => 10390 = 103.9 MHz; AM => 810 = 810 kHz.
  */
-void SI4735::seekStationProgress(void (*showFunc)(uint16_t f), uint8_t up_down)
+void SI4735::queueFrequency(uint16_t freq)
 {
-    si47x_frequency freq;
-    long elapsed_seek = millis();
-
-    // seek command does not work for SSB
-    if (lastMode == SSB_CURRENT_MODE)
-        return;
-    do
-    {
-        seekStation(up_down, 0);
-        delay(maxDelaySetFrequency);
-        getStatus(0, 0);
-        delay(maxDelaySetFrequency);
-        freq.raw.FREQH = currentStatus.resp.READFREQH;
-        freq.raw.FREQL = currentStatus.resp.READFREQL;
-        currentWorkFrequency = freq.value;
-        if (showFunc != NULL)
-            showFunc(freq.value);
-    } while (!currentStatus.resp.VALID && !currentStatus.resp.BLTF && (millis() - elapsed_seek) < maxSeekTime);
+    currentWorkFrequency = freq;
+    if (asyncOperation == ASYNC_IDLE)
+        beginSetFrequency(freq);
+    else
+        pendingFrequency = freq;
+    service();
 }
 
 /**
- * @ingroup group08 Seek 
- * @brief Seeks a station up or down.
- * @details Seek up or down a station and call a function defined by the developer to show the frequency and stop seeking process by the user. 
- * @details The first parameter of this function is a name of your function that you have to implement to show the current frequency. 
- * @details The second parameter is the name function that will check stop seeking action. Thus function should return true or false and should read a button, encoder or some status to make decision to stop or keep seeking. 
- * @details If you do not want to show the seeking progress,  you can set NULL instead the name of the function. 
- * @details If you do not want stop seeking checking, you can set NULL instead the name of a function.    
- * @details The code below shows an example using ta function the shows the current frequency on he Serial Monitor. You might want to implement a function that shows the frequency on your display device. 
- * @details Also, you have to declare the frequency parameter that will be used by the function to show the frequency value. 
- * @details __This function does not work on SSB mode__. 
- * @code
- * void showFrequency( uint16_t freq ) {
- *    Serial.print(freq); 
- *    Serial.println("MHz ");
- * }
+ * @ingroup group08 Set mode and Band
  * 
- * void loop() {
+ * @todo Adjust the power up parameters
  * 
- *  receiver.seekStationProgress(showFrequency, checkStopSeeking, 1); // Seek Up
- *  .
- *  .
- *  .
- *  receiver.seekStationProgress(showFrequency, checkStopSeeking, 0); // Seek Down
+ * @brief Sets the radio to AM function. It means: LW MW and SW.
  * 
- * }
- * @endcode
+ * @details Define the band range you want to use for the AM mode. 
  * 
- * @see seekStation, seekStationUp, seekStationDown, getStatus, setMaxSeekTime   
- * @param showFunc  function that you have to implement to show the frequency during the seeking process. Set NULL if you do not want to show the progress. 
- * @param stopSeeking functionthat you have to implement if you want to control the stop seeking action. 
- * @param up_down   set up_down = 1 for seeking station up; set up_down = 0 for seeking station down
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 129.
  */
-void SI4735::seekStationProgress(void (*showFunc)(uint16_t f), bool (*stopSeking)(), uint8_t up_down)
+void SI4735::setAM()
 {
-    si47x_frequency freq;
-    long elapsed_seek = millis();
-
-    // seek command does not work for SSB
-    if (lastMode == SSB_CURRENT_MODE)
-        return;
-    do
+    // If you’re already using AM mode, it is not necessary to call powerDown and radioPowerUp.
+    // The other properties also should have the same value as the previous status.
+    if (lastMode != AM_CURRENT_MODE)
     {
-        seekStation(up_down, 0);
-        delay(maxDelaySetFrequency);
-        getStatus(0, 0);
-        delay(maxDelaySetFrequency);
-        freq.raw.FREQH = currentStatus.resp.READFREQH;
-        freq.raw.FREQL = currentStatus.resp.READFREQL;
-        currentWorkFrequency = freq.value;
-        if (showFunc != NULL)
-            showFunc(freq.value);
-        if (stopSeking != NULL ) 
-           if ( stopSeking() ) return;
-           
-    } while (!currentStatus.resp.VALID && !currentStatus.resp.BLTF && (millis() - elapsed_seek) < maxSeekTime);
+        powerDown();
+        setPowerUp(this->currentInterruptEnable, this->currentInterruptEnable, 0, this->currentClockType, AM_CURRENT_MODE, currentAudioMode);
+        radioPowerUp();
+        setAvcAmMaxGain(currentAvcAmMaxGain); // Set AM Automatic Volume Gain to 48
+        setVolume(volume);                    // Set to previus configured volume
+    }
+    currentSsbStatus = 0;
+    lastMode = AM_CURRENT_MODE;
 }
 
 /**
- * @ingroup group08 Seek 
+ * @ingroup group08 Set mode and Band
  * 
- * @brief Sets the bottom frequency and top frequency of the AM band for seek. Default is 520 to 1710.
+ * @todo Adjust the power up parameters
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 127, 161, and 162
+ * @brief Sets the radio to FM function
  * 
- * @param uint16_t bottom - the bottom of the AM (MW/SW) mode for seek
- * @param uint16_t    top - the top of the AM (MW/SW) mode for seek
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 64. 
  */
-void SI4735::setSeekAmLimits(uint16_t bottom, uint16_t top)
+void SI4735::setFM()
 {
-    sendProperty(AM_SEEK_BAND_BOTTOM, bottom);
-    sendProperty(AM_SEEK_BAND_TOP, top);
+    powerDown();
+    setPowerUp(this->currentInterruptEnable, this->currentInterruptEnable, 0, this->currentClockType, FM_CURRENT_MODE, currentAudioMode);
+    radioPowerUp();
+    setVolume(volume); // Set to previus configured volume
+    currentSsbStatus = 0;
+    disableFmDebug();
+    lastMode = FM_CURRENT_MODE;
 }
 
 /**
- * @ingroup group08 Seek 
- * 
- * @brief Sets the bottom frequency and top frequency of the FM band for seek. Default is 8750 to 10790.
- * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 100 and  101
+ * @ingroup group08 Set mode and Band
  * 
- * @param uint16_t bottom - the bottom of the FM(VHF) mode for seek
- * @param uint16_t    top - the top of the FM(VHF) mode for seek
- */
-void SI4735::setSeekFmLimits(uint16_t bottom, uint16_t top)
-{
-    sendProperty(FM_SEEK_BAND_BOTTOM, bottom);
-    sendProperty(FM_SEEK_BAND_TOP, top);
-}
-
-/**
- * @ingroup group08 Seek 
+ * @brief Sets the radio to AM (LW/MW/SW) function. 
  * 
- * @brief Selects frequency spacingfor AM seek. Default is 10 kHz spacing.
+ * @details The example below sets the band from 550kHz to 1750kHz on AM mode. The band will start on 810kHz and step is 10kHz. 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 163, 229 and 283
+ * @code
+ * si4735.setAM(520, 1750, 810, 10); 
+ * @endcode
+ *  
+ * @see setFM()
+ * @see setSSB()
  * 
- * @param uint16_t spacing - step in kHz
+ * @param fromFreq minimum frequency for the band
+ * @param toFreq maximum frequency for the band
+ * @param initialFreq initial frequency 
+ * @param step step used to go to the next channel
  */
-void SI4735::setSeekAmSpacing(uint16_t spacing)
+void SI4735::setAM(uint16_t fromFreq, uint16_t toFreq, uint16_t initialFreq, uint16_t step)
 {
-    sendProperty(AM_SEEK_FREQ_SPACING, spacing);
+
+    currentMinimumFrequency = fromFreq;
+    currentMaximumFrequency = toFreq;
+    currentStep = step;
+
+    if (initialFreq < fromFreq || initialFreq > toFreq)
+        initialFreq = fromFreq;
+
+    setAM();
+    currentWorkFrequency = initialFreq;
+    setFrequency(currentWorkFrequency);
 }
 
 /**
- * @ingroup group08 Seek 
+ * @ingroup group08 Set mode and Band
  * 
- * @brief Selects frequency spacingfor FM seek. Default is 100 kHz kHz spacing. There are only 3 valid values: 5, 10, and 20.
+ * @brief Sets the radio to FM function. 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 101
+ * @details Defines the band range you want to use for the FM mode. 
  * 
- * @param uint16_t spacing - step in kHz
- */
-void SI4735::setSeekFmSpacing(uint16_t spacing)
-{
-    sendProperty(FM_SEEK_FREQ_SPACING, spacing);
-}
-
-/**
- * @ingroup group08 Seek 
+ * @details The example below sets the band from 64MHz to 108MHzkHz on FM mode. The band will start on 103.9MHz and step is 100kHz.
+ * On FM mode, the step 10 means 100kHz. If you want a 1MHz step, use 100.     
  * 
- * @brief Sets the SNR threshold for a valid AM Seek/Tune. 
+ * @code
+ * si4735.setFM(6400, 10800, 10390, 10);
+ * @endcode
  * 
- * @details If the value is zero then SNR threshold is not considered when doing a seek. Default value is 5 dB.
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 70
+ * @see setFM()
+ * @see setFrequencyStep()
  * 
- * @see Si47XX PROGRAMMING GUIDE;  (REV 1.0); page 127
+ * @param fromFreq minimum frequency for the band
+ * @param toFreq maximum frequency for the band
+ * @param initialFreq initial frequency (default frequency)
+ * @param step step used to go to the next channel   
  */
-void SI4735::setSeekAmSrnThreshold(uint16_t value)
+void SI4735::setFM(uint16_t fromFreq, uint16_t toFreq, uint16_t initialFreq, uint16_t step)
 {
-    sendProperty(AM_SEEK_SNR_THRESHOLD, value);
+    currentMinimumFrequency = fromFreq;
+    currentMaximumFrequency = toFreq;
+    currentStep = step;
+
+    if (initialFreq < fromFreq || initialFreq > toFreq)
+        initialFreq = fromFreq;
+
+    setFM();
+
+    currentWorkFrequency = initialFreq;
+    setFrequency(currentWorkFrequency);
 }
 
+/** @defgroup group08 Tune */
+
 /**
- * @ingroup group08 Seek 
+ * @ingroup group08 Set bandwidth
  * 
- * @brief Sets the SNR threshold for a valid FM Seek/Tune. 
+ * @brief Selects the bandwidth of the channel filter for AM reception. 
  * 
- * @details SNR Threshold which determines if a valid channel has been found during Seek/Tune. Specified in units of dB in 1 dB steps (0–127). Default is 3 dB
+ * @details The choices are 6, 4, 3, 2, 2.5, 1.8, or 1 (kHz). The default bandwidth is 2 kHz. It works only in AM / SSB (LW/MW/SW) 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 102
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 125, 151, 277, 181.
  * 
- * @param value between 0 and 127.
- */
-void SI4735::setSeekFmSrnThreshold(uint16_t value)
+ * @param AMCHFLT the choices are:   0 = 6 kHz Bandwidth                    
+ *                                   1 = 4 kHz Bandwidth
+ *                                   2 = 3 kHz Bandwidth
+ *                                   3 = 2 kHz Bandwidth
+ *                                   4 = 1 kHz Bandwidth
+ *                                   5 = 1.8 kHz Bandwidth
+ *                                   6 = 2.5 kHz Bandwidth, gradual roll off
+ *                                   7–15 = Reserved (Do not use).
+ * @param AMPLFLT Enables the AM Power Line Noise Rejection Filter.
+ */
+void SI4735::setBandwidth(uint8_t AMCHFLT, uint8_t AMPLFLT)
 {
-    sendProperty(FM_SEEK_TUNE_SNR_THRESHOLD, value);
+    si47x_bandwidth_config filter;
+    si47x_property property;
+
+    if (currentTune != AM_TUNE_FREQ) // Only for AM/SSB mode
+        return;
+
+    if (AMCHFLT > 6)
+        return;
+
+    filter.raw[0] = filter.raw[1] = 0;
+
+    property.value = AM_CHANNEL_FILTER;
+
+    filter.param.AMCHFLT = AMCHFLT;
+    filter.param.AMPLFLT = AMPLFLT;
+
+    uint8_t arg[] = {
+        0x00,                  // Always 0x00
+        property.raw.byteHigh, // High byte first
+        property.raw.byteLow,  // Low byte after
+        filter.raw[1],         // Raw data for AMCHFLT and
+        filter.raw[0]};        // AMPLFLT
+
+    sendCommand(SET_PROPERTY, sizeof arg, arg);
+    waitToSend();
 }
 
 /**
- * @ingroup group08 Seek 
+ * @ingroup group08 Frequency 
  * 
- * @brief Sets the RSSI threshold for a valid AM Seek/Tune. 
+ * @brief Gets the current frequency of the Si4735 (AM or FM)
  * 
- * @details If the value is zero then RSSI threshold is not considered when doing a seek. Default value is 25 dBμV.
+ * @details The method status do it an more. See getStatus below. 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 127
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 73 (FM) and 139 (AM)
  */
-void SI4735::setSeekAmRssiThreshold(uint16_t value)
+uint16_t SI4735::getFrequency()
 {
-    sendProperty(AM_SEEK_RSSI_THRESHOLD, value);
+    si47x_frequency freq;
+    getStatus(0, 1);
+
+    freq.raw.FREQL = currentStatus.resp.READFREQL;
+    freq.raw.FREQH = currentStatus.resp.READFREQH;
+
+    currentWorkFrequency = freq.value;
+    return freq.value;
 }
 
 /**
- * @ingroup group08 Seek 
+ * @ingroup group08 Frequency 
  * 
- * @brief Sets the RSSI threshold for a valid FM Seek/Tune.
+ * @brief Gets the current status  of the Si4735 (AM or FM)
  * 
- * @details RSSI threshold which determines if a valid channel has been found during seek/tune. Specified in units of dBμV in 1 dBμV steps (0–127). Default is 20 dBμV.
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 73 (FM) and 139 (AM)
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 102
+ * @param uint8_t INTACK Seek/Tune Interrupt Clear. If set, clears the seek/tune complete interrupt status indicator;
+ * @param uint8_t CANCEL Cancel seek. If set, aborts a seek currently in progress;
  */
-void SI4735::setSeekFmRssiThreshold(uint16_t value)
+void SI4735::getStatus(uint8_t INTACK, uint8_t CANCEL)
 {
-    sendProperty(FM_SEEK_TUNE_RSSI_THRESHOLD, value);
+    getStatus(INTACK, CANCEL, FIELD_ALL);
 }
 
-/** @defgroup group10 Tools method 
- * @details A set of functions used to support other functions
-*/
+// Index of the last response byte needed by each field (FIELD_VALID, FIELD_PILOT, FIELD_FREQUENCY, FIELD_RSSI, FIELD_SNR, FIELD_MULT, FIELD_FREQOFF and FIELD_ANTCAP).
+// 0 = the field is not available in the response.
+static const uint8_t tuneStatusFieldLastByte[] = {1, 0, 3, 4, 5, 6, 0, 7};
+static const uint8_t rsqStatusFieldLastByte[] = {2, 3, 0, 4, 5, 6, 7, 0};
 
 /**
- * @ingroup group10 Generic send property
- * 
- * @brief Sends (sets) property to the SI47XX
- * 
- * @details This method is used for others to send generic properties and params to SI47XX
+ * @ingroup group08 Frequency 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 68, 124 and  133.
- * @see setProperty, sendCommand, getProperty, getCommandResponse
+ * @brief Gets the number of response bytes needed to get a set of fields
  * 
- * @param propertyNumber property number (example: RX_VOLUME)
- * @param parameter   property value that will be seted
+ * @param fields field mask (FIELD_VALID | FIELD_RSSI ...)
+ * @param lastByte index of the last byte of each field 
+ * @param maxSize full response size
+ * @return uint8_t response size (at least 1: the status byte)
  */
-void SI4735::sendProperty(uint16_t propertyNumber, uint16_t parameter)
+static uint8_t getFieldsResponseSize(uint8_t fields, const uint8_t *lastByte, uint8_t maxSize)
 {
-    si47x_property property;
-    si47x_property param;
+    uint8_t size = 1;
 
-    property.value = propertyNumber;
-    param.value = parameter;
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(SET_PROPERTY);
-    Wire.write(0x00);
-    Wire.write(property.raw.byteHigh); // Send property - High byte - most significant first
-    Wire.write(property.raw.byteLow);  // Send property - Low byte - less significant after
-    Wire.write(param.raw.byteHigh);    // Send the argments. High Byte - Most significant first
-    Wire.write(param.raw.byteLow);     // Send the argments. Low Byte - Less significant after
-    Wire.endTransmission();
-    delayMicroseconds(550);
-}
+    for (uint8_t i = 0; i < 8; i++)
+        if ((fields & (1 << i)) && lastByte[i] >= size)
+            size = lastByte[i] + 1;
 
-/**
- * @ingroup group10 Generic Command and Response
- * @brief Sends a given command to the SI47XX devices. 
- * @details This function can be useful when you want to execute a SI47XX device command and it was not implemented by this library.
- * @details In this case you have to check the  AN332-Si47XX PROGRAMMING GUIDE to know how the command works. 
- * @details Also, you need to work with bit operators to compose the parameters of the command [ &(and), ˆ(xor), |(or) etc ].   
- *
- * @see getCommandResponse, setProperty
- *  
- * @param cmd command number (see AN332-Si47XX PROGRAMMING GUIDE)
- * @param parameter_size Parameter size in bytes. Tell the number of argument used by the command.
- * @param parameter unsigned byte array with the arguments of the command  
- */
-void SI4735::sendCommand(uint8_t cmd, int parameter_size, const uint8_t *parameter)
-{
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    // Sends the command to the device
-    Wire.write(cmd);
-    // Sends the argments (parameters) of the command
-    for (byte i = 0; i < parameter_size; i++)
-        Wire.write(parameter[i]);
-    Wire.endTransmission();
+    return (size < maxSize) ? size : maxSize;
 }
 
 /**
- * @ingroup group10 Generic Command and Response
- * @brief   Returns with the command response.  
- * @details After a command is executed by the device, you can get the result (response) of the command by calling this method.
+ * @ingroup group08 Frequency 
  * 
- * @see sendCommand, setProperty
+ * @brief Gets the current status of the Si4735 (AM or FM) reading just the bytes needed by the given fields
  * 
- * @param response_size  num of bytes returned by the command.
- * @param response  byte array where the response will be stored.     
+ * @details The response is read up to the last byte needed by the fields. The other bytes of the status are not updated.
+ * @details For example, FIELD_RSSI | FIELD_SNR reads 6 bytes instead of 8.
+ * 
+ * | Field           | Status byte | Methods |
+ * | --------------- | ----------- | ------- |
+ * | FIELD_VALID     | RESP1       | getStatusValid, getBandLimit |
+ * | FIELD_FREQUENCY | RESP2, 3    | getStatus READFREQH and READFREQL |
+ * | FIELD_RSSI      | RESP4       | getReceivedSignalStrengthIndicator |
+ * | FIELD_SNR       | RESP5       | getStatusSNR |
+ * | FIELD_MULT      | RESP6       | getStatusMULT |
+ * | FIELD_ANTCAP    | RESP7       | getAntennaTuningCapacitor |
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 73 (FM) and 139 (AM)
+ * @see si47x_response_status
+ * 
+ * @param uint8_t INTACK Seek/Tune Interrupt Clear. If set, clears the seek/tune complete interrupt status indicator;
+ * @param uint8_t CANCEL Cancel seek. If set, aborts a seek currently in progress;
+ * @param uint8_t fields field mask (FIELD_VALID, FIELD_FREQUENCY, FIELD_RSSI, FIELD_SNR, FIELD_MULT and FIELD_ANTCAP). FIELD_ALL reads all.
  */
-void SI4735::getCommandResponse(int response_size, uint8_t *response)
+void SI4735::getStatus(uint8_t INTACK, uint8_t CANCEL, uint8_t fields)
 {
+    si47x_tune_status status;
+    uint8_t cmd = FM_TUNE_STATUS;
+    uint8_t size = getFieldsResponseSize(fields, tuneStatusFieldLastByte, 8);
+
+    if (currentTune == FM_TUNE_FREQ)
+        cmd = FM_TUNE_STATUS;
+    else if (currentTune == AM_TUNE_FREQ)
+        cmd = AM_TUNE_STATUS;
+    else if (currentTune == NBFM_TUNE_FREQ)
+        cmd = NBFM_TUNE_STATUS;
+
+    status.arg.INTACK = INTACK;
+    status.arg.CANCEL = CANCEL;
+    status.arg.RESERVED2 = 0;
+
+    // Reads the current status (including current frequency).
+    sendCommandResponse(cmd, 1, &status.raw, size, currentStatus.raw);
+    while (currentStatus.resp.ERR) // If error, try it again
+    {
+        statsErrRetry();
+        getCommandResponse(size, currentStatus.raw);
+    }
     waitToSend();
-    // Asks the device to return a given number o bytes response
-    Wire.requestFrom(deviceAddress, response_size);
-    // Gets response information
-    for (byte i = 0; i < response_size; i++)
-        response[i] = Wire.read();
 }
 
 /**
- * @ingroup group10 Generic Command and Response
- * @brief Gets the first byte response. 
- * @details In this context status is the first response byte for any SI47XX command. See si47x_status structure. 
- * @details This function can be useful to check, for example, the success or failure of a command. 
+ * @ingroup group08 AGC 
  * 
- * @see si47x_status
+ * @brief Queries Automatic Gain Control STATUS
+ * 
+ * @details After call this method, you can call isAgcEnabled to know the AGC status and getAgcGainIndex to know the gain index value.
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); For FM page 80; for AM page 142.
+ * @see AN332 REV 0.8 Universal Programming Guide Amendment for SI4735-D60 SSB and NBFM patches; page 18. 
  * 
- * @return si47x_status 
  */
-si47x_status SI4735::getStatusResponse()
+void SI4735::getAutomaticGainControl()
 {
-    si47x_status status;
+    uint8_t cmd;
 
-    Wire.requestFrom(deviceAddress, 1);
-    status.raw = Wire.read();
+    if (currentTune == FM_TUNE_FREQ) { // FM TUNE
+        cmd = FM_AGC_STATUS;
+    }
+    else if (currentTune == NBFM_TUNE_FREQ) {
+        cmd = NBFM_AGC_STATUS;
+    }
+    else { // AM TUNE - SAME COMMAND used on SSB mode
+        cmd = AM_AGC_STATUS;
+    }
 
-    return status;
+    sendCommandResponse(cmd, 0, NULL, 3, currentAgcStatus.raw); // STATUS response, RESP 1 and RESP 2
+    while (currentAgcStatus.refined.ERR)                          // If error, try get AGC status again.
+    {
+        statsErrRetry();
+        getCommandResponse(3, currentAgcStatus.raw);
+    }
 }
 
-/**
- * @ingroup group10 Generic get property
- * 
- * @brief Gets a given property from the SI47XX
+/** 
+ * @ingroup group08 AGC 
  * 
- * @details This method is used to get a given property from SI47XX
- * @details You might need to extract set of bits information from the returned value to know the real value
+ * @brief Automatic Gain Control setup 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 55, 69, 124 and  134.
- * @see sendProperty, setProperty, sendCommand, getCommandResponse
+ * @details If FM, overrides AGC setting by disabling the AGC and forcing the LNA to have a certain gain that ranges between 0 
+ * (minimum attenuation) and 26 (maximum attenuation).
+ * @details If AM/SSB, Overrides the AGC setting by disabling the AGC and forcing the gain index that ranges between 0 
+ * (minimum attenuation) and 37+ATTN_BACKUP (maximum attenuation).
  * 
- * @param propertyNumber property number (example: RX_VOLUME)
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); For FM page 81; for AM page 143 
  * 
- * @return property value  (the content of the property)
+ * @param uint8_t AGCDIS This param selects whether the AGC is enabled or disabled (0 = AGC enabled; 1 = AGC disabled);
+ * @param uint8_t AGCIDX AGC Index (0 = Minimum attenuation (max gain); 1 – 36 = Intermediate attenuation); 
+ *                if >greater than 36 - Maximum attenuation (min gain) ).
  */
-int32_t
-SI4735::getProperty(uint16_t propertyNumber)
+void SI4735::setAutomaticGainControl(uint8_t AGCDIS, uint8_t AGCIDX)
 {
-    si47x_property property;
-    si47x_status status;
+    si47x_agc_overrride agc;
 
-    property.value = propertyNumber;
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(GET_PROPERTY);
-    Wire.write(0x00);
-    Wire.write(property.raw.byteHigh); // Send property - High byte - most significant first
-    Wire.write(property.raw.byteLow);  // Send property - Low byte - less significant after
-    Wire.endTransmission();
+    uint8_t cmd;
 
-    waitToSend();
-    Wire.requestFrom(deviceAddress, 4);
-    status.raw = Wire.read();
+    // cmd = (currentTune == FM_TUNE_FREQ) ? FM_AGC_OVERRIDE : AM_AGC_OVERRIDE; // AM_AGC_OVERRIDE = SSB_AGC_OVERRIDE = 0x48
 
-    // if error, return 0;
-    if (status.refined.ERR == 1)
-        return -1;
+    if (currentTune == FM_TUNE_FREQ)
+        cmd = FM_AGC_OVERRIDE;
+    else if (currentTune == FM_TUNE_FREQ)
+        cmd = NBFM_AGC_OVERRIDE;
+    else
+        cmd = AM_AGC_OVERRIDE;
 
-    Wire.read(); // dummy
+    agc.arg.AGCDIS = AGCDIS;
+    agc.arg.AGCIDX = AGCIDX;
 
-    // gets the property value
-    property.raw.byteHigh = Wire.read();
-    property.raw.byteLow = Wire.read();
+    sendCommand(cmd, 2, agc.raw);
 
-    return property.value;
+    waitToSend();
 }
 
-/** @defgroup group12 FM Mono Stereo audio setup */
-
 /**
- * @ingroup group12 FM Mono Stereo audio setup
- *  
- * @brief Sets RSSI threshold for stereo blend (Full stereo above threshold, blend below threshold). 
+ * @ingroup group08 Automatic Volume Control
  * 
- * @details To force stereo, set this to 0. To force mono, set this to 127.
+ * @brief Sets the maximum gain for automatic volume control.
+ *  
+ * @details If no parameter is sent, it will be consider 48dB.
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 90. 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 152
+ * @see setAvcAmMaxGain()
  * 
- * @param parameter  valid values: 0 to 127
+ * @param uint8_t gain  Select a value between 12 and 192.  Defaul value 48dB.
  */
-void SI4735::setFmBlendStereoThreshold(uint8_t parameter)
+void SI4735::setAvcAmMaxGain(uint8_t gain)
 {
-    sendProperty(FM_BLEND_STEREO_THRESHOLD, parameter);
+    uint16_t aux;
+    aux = (gain > 12 && gain < 193) ? (gain * 340) : (48 * 340);
+    currentAvcAmMaxGain = gain;
+    sendProperty(AM_AUTOMATIC_VOLUME_CONTROL_MAX_GAIN, aux);
 }
 
 /**
- * @ingroup group12 FM Mono Stereo audio setup
+ * @ingroup group08 Received Signal Quality
  * 
- * @brief Sets RSSI threshold for mono blend (Full mono below threshold, blend above threshold). 
+ * @brief Queries the status of the Received Signal Quality (RSQ) of the current channel.
  * 
- * @details To force stereo set this to 0. To force mono set this to 127. Default value is 30 dBμV.
+ * @details This method sould be called berore call getCurrentRSSI(), getCurrentSNR() etc.
+ * Command FM_RSQ_STATUS
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 56.
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 75 and 141
  * 
- * @param parameter valid values: 0 to 127
+ * @param INTACK Interrupt Acknowledge. 
+ *        0 = Interrupt status preserved; 
+ *        1 = Clears RSQINT, BLENDINT, SNRHINT, SNRLINT, RSSIHINT, RSSILINT, MULTHINT, MULTLINT.
  */
-void SI4735::setFmBlendMonoThreshold(uint8_t parameter)
+void SI4735::getCurrentReceivedSignalQuality(uint8_t INTACK)
 {
-    sendProperty(FM_BLEND_MONO_THRESHOLD, parameter);
+    getCurrentReceivedSignalQuality(INTACK, FIELD_ALL);
 }
 
-/** 
- * @ingroup group12 FM Mono Stereo audio setup
+/**
+ * @ingroup group08 Received Signal Quality
  * 
- * @brief Sets RSSI threshold for stereo blend. (Full stereo above threshold, blend below threshold.) 
+ * @brief Queries the Received Signal Quality (RSQ) of the current channel reading just the bytes needed by the given fields
  * 
- * @details To force stereo, set this to 0. To force mono, set this to 127. Default value is 49 dBμV.
+ * @details The response is read up to the last byte needed by the fields. The other bytes of the RSQ status are not updated.
+ * @details For example, an S-meter that needs just RSSI and SNR (FIELD_RSSI | FIELD_SNR) reads 6 bytes instead of 8 on FM.
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 59. 
+ * | Field         | RSQ byte | Methods |
+ * | ------------- | -------- | ------- |
+ * | FIELD_VALID   | RESP2    | getCurrentValidChannel, getCurrentAfcRailIndicator, getCurrentSoftMuteIndicator |
+ * | FIELD_PILOT   | RESP3    | getCurrentPilot, getCurrentStereoBlend |
+ * | FIELD_RSSI    | RESP4    | getCurrentRSSI |
+ * | FIELD_SNR     | RESP5    | getCurrentSNR |
+ * | FIELD_MULT    | RESP6    | getCurrentMultipath |
+ * | FIELD_FREQOFF | RESP7    | getCurrentSignedFrequencyOffset |
  * 
- * @param parameter valid values: 0 to 127
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 75 and 141
+ * @see si47x_rqs_status
+ * 
+ * @code
+ *   rx.getCurrentReceivedSignalQuality(0, FIELD_RSSI | FIELD_SNR);
+ *   showSmeter(rx.getCurrentRSSI(), rx.getCurrentSNR());
+ * @endcode
+ * 
+ * @param INTACK Interrupt Acknowledge (see getCurrentReceivedSignalQuality(uint8_t INTACK)).
+ * @param fields field mask (FIELD_VALID, FIELD_PILOT, FIELD_RSSI, FIELD_SNR, FIELD_MULT and FIELD_FREQOFF). FIELD_ALL reads all.
  */
-void SI4735::setFmBlendRssiStereoThreshold(uint8_t parameter)
+void SI4735::getCurrentReceivedSignalQuality(uint8_t INTACK, uint8_t fields)
 {
-    sendProperty(FM_BLEND_RSSI_STEREO_THRESHOLD, parameter);
+    uint8_t arg;
+    uint8_t cmd;
+    int sizeResponse;
+
+    if (currentTune == FM_TUNE_FREQ)
+    { // FM TUNE
+        cmd = FM_RSQ_STATUS;
+        sizeResponse = 8; 
+    }
+    else if (currentTune == NBFM_TUNE_FREQ) {
+        cmd = NBFM_RSQ_STATUS;
+        sizeResponse = 8; // Check it
+    } 
+    else
+    { // AM TUNE
+        cmd = AM_RSQ_STATUS;
+        sizeResponse = 6; // Check it
+    }
+
+    sizeResponse = getFieldsResponseSize(fields, rsqStatusFieldLastByte, sizeResponse);
+
+    arg = INTACK;
+    // send B00000001 and gets the response
+    sendCommandResponse(cmd, 1, &arg, sizeResponse, currentRqsStatus.raw);
 }
 
-/** 
- * @ingroup group12 FM Mono Stereo audio setup
- * 
- * @brief Sets RSSI threshold for mono blend (Full mono below threshold, blend above threshold). 
+/**
+ * @ingroup group08 Received Signal Quality
  * 
- * @details To force stereo, set this to 0. To force mono, set this to 127. Default value is 30 dBμV.
+ * @brief Queries the status of the Received Signal Quality (RSQ) of the current channel (FM_RSQ_STATUS)
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 59.  
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 75 and 141
  * 
- * @param parameter valid values: 0 to 127
+ * @param INTACK Interrupt Acknowledge. 
+ *        0 = Interrupt status preserved; 
+ *        1 = Clears RSQINT, BLENDINT, SNRHINT, SNRLINT, RSSIHINT, RSSILINT, MULTHINT, MULTLINT.
  */
-void SI4735::setFmBLendRssiMonoThreshold(uint8_t parameter)
+void SI4735::getCurrentReceivedSignalQuality(void)
 {
-    sendProperty(FM_BLEND_RSSI_MONO_THRESHOLD, parameter);
+    getCurrentReceivedSignalQuality(0);
 }
 
 /**
- * @ingroup group12 FM Mono Stereo audio setup
- * 
- * @brief Sets SNR threshold for stereo blend (Full stereo above threshold, blend below threshold). 
- * 
- * @details To force stereo, set this to 0. To force mono, set this to 127. Default value is 27 dB.
+ * @ingroup group08 Seek 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 59.  
+ * @brief Look for a station (Automatic tune)
+ * @details Starts a seek process for a channel that meets the RSSI and SNR criteria for AM.  
+ * @details __This function does not work on SSB mode__.  
+ * @details In WAIT_MODE_INTERRUPT, returns as soon as the STC interrupt arrives (see setWaitMode).
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 55, 72, 125 and 137
  * 
- * @param parameter valid values: 0 to 127
+ * @param SEEKUP Seek Up/Down. Determines the direction of the search, either UP = 1, or DOWN = 0. 
+ * @param Wrap/Halt. Determines whether the seek should Wrap = 1, or Halt = 0 when it hits the band limit.
  */
-void SI4735::setFmBlendSnrStereoThreshold(uint8_t parameter)
+void SI4735::seekStation(uint8_t SEEKUP, uint8_t WRAP)
 {
-    sendProperty(FM_BLEND_SNR_STEREO_THRESHOLD, parameter);
+    uint8_t seek_start_cmd = startSeek(SEEKUP, WRAP);
+    // The seek time depends on the band. Just waits up to MAX_DELAY_AFTER_SET_FREQUENCY * 4 for STC (no learning).
+    waitStc((seek_start_cmd == AM_SEEK_START) ? LATENCY_AM_STC : LATENCY_FM_STC, MAX_DELAY_AFTER_SET_FREQUENCY << 2, false);
 }
 
 /**
- * @ingroup group12 FM Mono Stereo audio setup
- * 
- * @brief Sets SNR threshold for mono blend (Full mono below threshold, blend above threshold). 
+ * @ingroup group08 Seek 
  * 
- * @details To force stereo, set this to 0. To force mono, set this to 127. Default value is 14 dB.
+ * @brief Sends the seek start command (FM_SEEK_START or AM_SEEK_START) and returns.
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 59. 
+ * @see seekStation, beginSeek
  * 
- * @param parameter valid values: 0 to 127 
+ * @param SEEKUP Seek Up/Down. Determines the direction of the search, either UP = 1, or DOWN = 0. 
+ * @param Wrap/Halt. Determines whether the seek should Wrap = 1, or Halt = 0 when it hits the band limit.
+ * @return uint8_t the command sent (FM_SEEK_START or AM_SEEK_START)
  */
-void SI4735::setFmBLendSnrMonoThreshold(uint8_t parameter)
+uint8_t SI4735::startSeek(uint8_t SEEKUP, uint8_t WRAP)
 {
-    sendProperty(FM_BLEND_SNR_MONO_THRESHOLD, parameter);
+    si47x_seek seek;
+    si47x_seek_am_complement seek_am_complement;
+    uint8_t arg[5];
+    uint8_t arg_size = 1;
+
+    // Check which FUNCTION (AM or FM) is working now
+    uint8_t seek_start_cmd = (currentTune == FM_TUNE_FREQ) ? FM_SEEK_START : AM_SEEK_START;
+
+    seek.arg.SEEKUP = SEEKUP;
+    seek.arg.WRAP = WRAP;
+    seek.arg.RESERVED1 = 0;
+    seek.arg.RESERVED2 = 0;
+
+    arg[0] = seek.raw; // ARG1
+
+    if (seek_start_cmd == AM_SEEK_START) // Sets additional configuration for AM mode
+    {
+        seek_am_complement.ARG2 = seek_am_complement.ARG3 = 0;
+        seek_am_complement.ANTCAPH = 0;
+        seek_am_complement.ANTCAPL = (currentWorkFrequency > 1800) ? 1 : 0; // if SW = 1
+        arg[1] = seek_am_complement.ARG2;                                   // ARG2 - Always 0
+        arg[2] = seek_am_complement.ARG3;                                   // ARG3 - Always 0
+        arg[3] = seek_am_complement.ANTCAPH;                                // ARG4 - Tuning Capacitor: The tuning capacitor value
+        arg[4] = seek_am_complement.ANTCAPL;                                // ARG5 - will be selected automatically.
+        arg_size = 5;
+    }
+
+    sendCommand(seek_start_cmd, arg_size, arg);
+    return seek_start_cmd;
 }
 
-/** 
- * @ingroup group12 FM Mono Stereo audio setup
- * 
- * @brief Sets multipath threshold for stereo blend (Full stereo below threshold, blend above threshold). 
+/**
+ * @ingroup group08 Seek 
  * 
- * @details To force stereo, set this to 100. To force mono, set this to 0. Default value is 20.
+ * @brief Search for the next station.
+ * @details Like seekStationUp this function goes to a next station.  
+ * @details The main difference is the method used to look for a station.
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 60.
+ * @see seekStation, seekStationUp, seekStationDown, seekPreviousStation, seekStationProgress
+ */
+void SI4735::seekNextStation()
+{
+    seekStation(1, 1);
+    waitMicroseconds(maxDelaySetFrequency * 1000UL);
+    getFrequency();
+}
+
+/**
+ * @ingroup group08 Seek 
  * 
- * @param parameter valid values: 0 to 100 
+ * @brief Search the previous station
+ * @details Like seekStationDown this function goes to a previous station.  
+ * @details The main difference is the method used to look for a station.
+ * @see seekStation, seekStationUp, seekStationDown, seekPreviousStation, seekStationProgress
  */
-void SI4735::setFmBlendMultiPathStereoThreshold(uint8_t parameter)
+void SI4735::seekPreviousStation()
 {
-    sendProperty(FM_BLEND_MULTIPATH_STEREO_THRESHOLD, parameter);
+    seekStation(0, 1);
+    waitMicroseconds(maxDelaySetFrequency * 1000UL);
+    getFrequency();
 }
 
 /**
- * @ingroup group12 FM Mono Stereo audio setup
+ * @ingroup group08 Seek 
+ * @brief Seeks a station up or down.
+ * @details Seek up or down a station and call a function defined by the developer to show the frequency. 
+ * @details The first parameter of this function is a name of your function that you have to implement to show the current frequency. 
+ * @details If you do not want to show the seeking progress,  you can set NULL instead the name of the function.   
+ * @details The code below shows an example using ta function the shows the current frequency on he Serial Monitor. You might want to implement a function that shows the frequency on your display device. 
+ * @details Also, you have to declare the frequency parameter that will be used by the function to show the frequency value. 
+ * @details __This function does not work on SSB mode__. 
+ * @code
+ * void showFrequency( uint16_t freq ) {
+ *    Serial.print(freq); 
+ *    Serial.println("MHz ");
+ * }
  * 
- * @brief Sets Multipath threshold for mono blend (Full mono above threshold, blend below threshold). 
+ * void loop() {
  * 
- * @details To force stereo, set to 100. To force mono, set to 0. The default is 60.
+ *  receiver.seekStationProgress(showFrequency,1); // Seek Up
+ *  .
+ *  .
+ *  .
+ *  receiver.seekStationProgress(showFrequency,0); // Seek Down
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 60.
+ * }
+ * @endcode
  * 
- * @param parameter valid values: 0 to 100 
+ * @see seekStation, seekStationUp, seekStationDown, getStatus, setMaxSeekTime   
+ * @param showFunc  function that you have to implement to show the frequency during the seeking process. Set NULL if you do not want to show the progress. 
+ * @param up_down   set up_down = 1 for seeking station up; set up_down = 0 for seeking station down
  */
-void SI4735::setFmBlendMultiPathMonoThreshold(uint8_t parameter)
+void SI4735::seekStationProgress(void (*showFunc)(uint16_t f), uint8_t up_down)
 {
-    sendProperty(FM_BLEND_MULTIPATH_MONO_THRESHOLD, parameter);
+    seekStationProgress(showFunc, NULL, up_down);
 }
 
-/** 
- * @ingroup group12 FM Mono Stereo audio setup
- * @todo 
- * @brief Turn Off Stereo operation.
+/**
+ * @ingroup group08 Seek 
+ * @brief Seeks a station up or down.
+ * @details Seek up or down a station and call a function defined by the developer to show the frequency and stop seeking process by the user. 
+ * @details The first parameter of this function is a name of your function that you have to implement to show the current frequency. 
+ * @details The second parameter is the name function that will check stop seeking action. Thus function should return true or false and should read a button, encoder or some status to make decision to stop or keep seeking. 
+ * @details If you do not want to show the seeking progress,  you can set NULL instead the name of the function. 
+ * @details If you do not want stop seeking checking, you can set NULL instead the name of a function.    
+ * @details The code below shows an example using ta function the shows the current frequency on he Serial Monitor. You might want to implement a function that shows the frequency on your display device. 
+ * @details Also, you have to declare the frequency parameter that will be used by the function to show the frequency value. 
+ * @details __This function does not work on SSB mode__. 
+ * @code
+ * void showFrequency( uint16_t freq ) {
+ *    Serial.print(freq); 
+ *    Serial.println("MHz ");
+ * }
+ * 
+ * void loop() {
+ * 
+ *  receiver.seekStationProgress(showFrequency, checkStopSeeking, 1); // Seek Up
+ *  .
+ *  .
+ *  .
+ *  receiver.seekStationProgress(showFrequency, checkStopSeeking, 0); // Seek Down
+ * 
+ * }
+ * @endcode
+ * 
+ * @details The seek is driven by the asynchronous seek engine (see beginSeek and service). showFunc is called each time the scanned frequency changes and when the seek is done. 
+ * @details When stopSeking returns true, the seek is canceled (see cancelSeek) and the receiver stays on the frequency being scanned.
+ * 
+ * @see seekStation, seekStationUp, seekStationDown, getStatus, setMaxSeekTime, beginSeek   
+ * @param showFunc  function that you have to implement to show the frequency during the seeking process. Set NULL if you do not want to show the progress. 
+ * @param stopSeeking functionthat you have to implement if you want to control the stop seeking action. 
+ * @param up_down   set up_down = 1 for seeking station up; set up_down = 0 for seeking station down
  */
-void SI4735::setFmStereoOff()
+void SI4735::seekStationProgress(void (*showFunc)(uint16_t f), bool (*stopSeking)(), uint8_t up_down)
 {
-    //! TO DO
+    void (*progress)(uint16_t freq) = seekProgressFunc;
+    void (*callback)(uint8_t operation, uint8_t result) = asyncCallback;
+
+    // One seek (WRAP = 0) driven by service(). It stops on a valid station, on the band limit or after maxSeekTime.
+    if (!beginSeek(up_down, 0))
+        return;
+
+    seekProgressFunc = showFunc;
+    asyncCallback = NULL;
+    while (service())
+    {
+        if (stopSeking != NULL && stopSeking())
+            cancelSeek();
+        else
+            waitMicroseconds(MIN_DELAY_WAIT_STC_LOOP);
+    }
+    seekProgressFunc = progress;
+    asyncCallback = callback;
+
+    if (showFunc != NULL)
+        showFunc(currentWorkFrequency);
 }
 
-/** 
- * @ingroup group12 FM Mono Stereo audio setup
- * @todo 
- * @brief Turn Off Stereo operation.
+/**
+ * @ingroup group08 Seek 
+ * 
+ * @brief Sets the bottom frequency and top frequency of the AM band for seek. Default is 520 to 1710.
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 127, 161, and 162
+ * 
+ * @param uint16_t bottom - the bottom of the AM (MW/SW) mode for seek
+ * @param uint16_t    top - the top of the AM (MW/SW) mode for seek
  */
-void SI4735::setFmStereoOn()
+void SI4735::setSeekAmLimits(uint16_t bottom, uint16_t top)
 {
-    //! TO DO
+    beginProperties().add(AM_SEEK_BAND_BOTTOM, bottom).add(AM_SEEK_BAND_TOP, top).commit();
 }
 
 /**
- * @ingroup group12 FM Mono Stereo audio setup
+ * @ingroup group08 Seek 
  * 
- * @brief There is a debug feature that remains active in Si4704/05/3x-D60 firmware which can create periodic noise in audio.
+ * @brief Sets the bottom frequency and top frequency of the FM band for seek. Default is 8750 to 10790.
  * 
- * @details Silicon Labs recommends you disable this feature by sending the following bytes (shown here in hexadecimal form):
- * 0x12 0x00 0xFF 0x00 0x00 0x00.
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 100 and  101
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 299. 
+ * @param uint16_t bottom - the bottom of the FM(VHF) mode for seek
+ * @param uint16_t    top - the top of the FM(VHF) mode for seek
  */
-void SI4735::disableFmDebug()
+void SI4735::setSeekFmLimits(uint16_t bottom, uint16_t top)
 {
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(0x12);
-    Wire.write(0x00);
-    Wire.write(0xFF);
-    Wire.write(0x00);
-    Wire.write(0x00);
-    Wire.write(0x00);
-    Wire.endTransmission();
-    delayMicroseconds(2500);
+    beginProperties().add(FM_SEEK_BAND_BOTTOM, bottom).add(FM_SEEK_BAND_TOP, top).commit();
 }
 
-/** @defgroup group13 Audio setup */
-
 /**
- * @ingroup group13 Digital Audio setup
+ * @ingroup group08 Seek 
  * 
- * @brief Configures the digital audio output format. 
+ * @brief Selects frequency spacingfor AM seek. Default is 10 kHz spacing.
  * 
- * @details Options: DCLK edge, data format, force mono, and sample precision.
- *  
- * ATTENTION: The document AN383; "Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES"; rev 0.8; page 6; there is the following note:
- *            Crystal and digital audio mode cannot be used at the same time. Populate R1 and remove C10, C11, and X1 when using digital audio.
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 163, 229 and 283
  * 
- * @see Si47XX PROGRAMINGGUIDE; AN332 (REV 1.0); page 195.
- * @see Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES"; AN383; rev 0.8; page 6; 
-
- * @param uint8_t OSIZE Dgital Output Audio Sample Precision (0=16 bits, 1=20 bits, 2=24 bits, 3=8bits).
- * @param uint8_t OMONO Digital Output Mono Mode (0=Use mono/stereo blend ).
- * @param uint8_t OMODE Digital Output Mode (0=I2S, 6 = Left-justified, 8 = MSB at second DCLK after DFS pulse, 12 = MSB at first DCLK after DFS pulse).
- * @param uint8_t OFALL Digital Output DCLK Edge (0 = use DCLK rising edge, 1 = use DCLK falling edge)
+ * @param uint16_t spacing - step in kHz
  */
-void SI4735::digitalOutputFormat(uint8_t OSIZE, uint8_t OMONO, uint8_t OMODE, uint8_t OFALL)
+void SI4735::setSeekAmSpacing(uint16_t spacing)
 {
-    si4735_digital_output_format df;
-    df.refined.OSIZE = OSIZE;
-    df.refined.OMONO = OMONO;
-    df.refined.OMODE = OMODE;
-    df.refined.OFALL = OFALL;
-    df.refined.dummy = 0;
-    sendProperty(DIGITAL_OUTPUT_FORMAT, df.raw);
+    sendProperty(AM_SEEK_FREQ_SPACING, spacing);
 }
 
 /**
- * @ingroup group13 Digital Audio setup
+ * @ingroup group08 Seek 
  * 
- * @brief Enables digital audio output and configures digital audio output sample rate in samples per second (sps).
- * 
- * ATTENTION: The document AN383; "Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES"; rev 0.8; page 6; there is the following note:
- *            Crystal and digital audio mode cannot be used at the same time. Populate R1 and remove C10, C11, and X1 when using digital audio.
+ * @brief Selects frequency spacingfor FM seek. Default is 100 kHz kHz spacing. There are only 3 valid values: 5, 10, and 20.
  * 
- * @see Si47XX PROGRAMINGGUIDE; AN332 (REV 1.0); page 196. 
- * @see Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES; AN383; rev 0.8; page 6
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 101
  * 
- * @param uint16_t DOSR Diital Output Sample Rate(32–48 ksps .0 to disable digital audio output).
+ * @param uint16_t spacing - step in kHz
  */
-void SI4735::digitalOutputSampleRate(uint16_t DOSR)
+void SI4735::setSeekFmSpacing(uint16_t spacing)
 {
-    sendProperty(DIGITAL_OUTPUT_SAMPLE_RATE, DOSR);
+    sendProperty(FM_SEEK_FREQ_SPACING, spacing);
 }
 
-/** 
- * @ingroup group13 Audio volume
+/**
+ * @ingroup group08 Seek 
  * 
- * @brief Sets volume level (0  to 63)
+ * @brief Sets the SNR threshold for a valid AM Seek/Tune. 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 62, 123, 170, 173 and 204
+ * @details If the value is zero then SNR threshold is not considered when doing a seek. Default value is 5 dB.
  * 
- * @param uint8_t volume (domain: 0 - 63) 
+ * @see Si47XX PROGRAMMING GUIDE;  (REV 1.0); page 127
  */
-void SI4735::setVolume(uint8_t volume)
+void SI4735::setSeekAmSrnThreshold(uint16_t value)
 {
-    sendProperty(RX_VOLUME, volume);
-    this->volume = volume;
+    sendProperty(AM_SEEK_SNR_THRESHOLD, value);
 }
 
 /**
- * @ingroup group13 Audio volume
- * @brief Sets the audio on or off. 
- * @details Useful to mute the audio output of the SI47XX device. This function does not work to reduce the pop in the speaker at start the system up.
- * @details If you want to remove the loud click or pop in the speaker at start, power down and power up commands, use setHardwareAudioMute with a external mute circuit. 
+ * @ingroup group08 Seek 
  * 
- * @see See Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 62, 123, 171 
- * @see setHardwareAudioMute
+ * @brief Sets the SNR threshold for a valid FM Seek/Tune. 
  * 
- * @param value if true, mute the audio; if false unmute the audio.
+ * @details SNR Threshold which determines if a valid channel has been found during Seek/Tune. Specified in units of dB in 1 dB steps (0–127). Default is 3 dB
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 102
+ * 
+ * @param value between 0 and 127.
  */
-void SI4735::setAudioMute(bool off)
+void SI4735::setSeekFmSrnThreshold(uint16_t value)
 {
-    uint16_t value = (off) ? 3 : 0; // 3 means mute; 0 means unmute
-    sendProperty(RX_HARD_MUTE, value);
+    sendProperty(FM_SEEK_TUNE_SNR_THRESHOLD, value);
 }
 
-
-
 /**
- * @ingroup group13 Aud volume
+ * @ingroup group08 Seek 
  * 
- * @brief Gets the current volume level.
+ * @brief Sets the RSSI threshold for a valid AM Seek/Tune. 
  * 
- * @see setVolume()
+ * @details If the value is zero then RSSI threshold is not considered when doing a seek. Default value is 25 dBμV.
  * 
- * @return volume (domain: 0 - 63) 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 127
  */
-uint8_t SI4735::getVolume()
+void SI4735::setSeekAmRssiThreshold(uint16_t value)
 {
-    return this->volume;
+    sendProperty(AM_SEEK_RSSI_THRESHOLD, value);
 }
 
 /**
- * @ingroup group13 Audio volume
- *  
- * @brief Set sound volume level Up   
- *  
- * @see setVolume()
+ * @ingroup group08 Seek 
+ * 
+ * @brief Sets the RSSI threshold for a valid FM Seek/Tune.
+ * 
+ * @details RSSI threshold which determines if a valid channel has been found during seek/tune. Specified in units of dBμV in 1 dBμV steps (0–127). Default is 20 dBμV.
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 102
  */
-void SI4735::volumeUp()
+void SI4735::setSeekFmRssiThreshold(uint16_t value)
 {
-    if (volume < 63)
-        volume++;
-    setVolume(volume);
+    sendProperty(FM_SEEK_TUNE_RSSI_THRESHOLD, value);
 }
 
+/** @defgroup group10 Tools method 
+ * @details A set of functions used to support other functions
+*/
+
 /**
- * @ingroup group13 Audio volume
- *  
- * @brief Set sound volume level Down   
+ * @ingroup group10 Generic send property
  * 
- * @see setVolume() 
+ * @brief Sends (sets) property to the SI47XX
+ * 
+ * @details This method is used for others to send generic properties and params to SI47XX
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 68, 124 and  133.
+ * @see setProperty, sendCommand, getProperty, getCommandResponse
+ * 
+ * @param propertyNumber property number (example: RX_VOLUME)
+ * @param parameter   property value that will be seted
  */
-void SI4735::volumeDown()
+void SI4735::sendProperty(uint16_t propertyNumber, uint16_t parameter)
 {
-    if (volume > 0)
-        volume--;
-    setVolume(volume);
-}
+    si47x_property property;
+    si47x_property param;
 
-/**
- * @defgroup group16 FM RDS/RBDS
- * @todo RDS Dynamic PS or Scrolling PS support  
- */
+    property.value = propertyNumber;
+    param.value = parameter;
 
-/*******************************************************************************
- * RDS implementation 
- ******************************************************************************/
+    uint8_t arg[] = {
+        0x00,
+        property.raw.byteHigh, // Send property - High byte - most significant first
+        property.raw.byteLow,  // Send property - Low byte - less significant after
+        param.raw.byteHigh,    // Send the argments. High Byte - Most significant first
+        param.raw.byteLow};    // Send the argments. Low Byte - Less significant after
+
+    sendCommand(SET_PROPERTY, sizeof arg, arg);
+}
 
 /**
- * @ingroup group16 RDS setup 
- *  
- * @brief  Starts the control member variables for RDS.
+ * @ingroup group10 Generic set and get property
  * 
- * @details This method is called by setRdsConfig()
+ * @brief Starts a property batch
  * 
- * @see setRdsConfig()
+ * @see SI4735::beginProperties
+ * @param rx the receiver
  */
-void SI4735::RdsInit()
+SI4735PropertyBatch::SI4735PropertyBatch(SI4735 *rx)
 {
-    clearRdsBuffer2A();
-    clearRdsBuffer2B();
-    clearRdsBuffer0A();
-    rdsTextAdress2A = rdsTextAdress2B = lastTextFlagAB = rdsTextAdress0A = 0;
+    this->rx = rx;
+    memset(&report, 0, sizeof report);
+    startTime = micros();
 }
 
 /**
- * @ingroup group16 RDS setup 
- *  
- * @brief Clear RDS buffer 2A (text) 
- * 
+ * @ingroup group10 Generic set and get property
+ * @brief Waits for CTS and accounts the time and the status reads
  */
-void SI4735::clearRdsBuffer2A()
+void SI4735PropertyBatch::waitToSend()
 {
-    for (int i = 0; i < 65; i++)
-        rds_buffer2A[i] = ' '; // Radio Text buffer - Program Information
-    rds_buffer2A[64] = '\0';
+    uint32_t start = micros();
+    uint8_t polls = rx->waitCts();
+
+    report.polls += polls;
+    report.bytes += polls;
+    report.waitTime += micros() - start;
 }
 
 /**
- * @ingroup group16 RDS setup 
+ * @ingroup group10 Generic set and get property
  * 
- * @brief Clear RDS buffer 2B (text)
+ * @brief Sends a property as soon as the device is ready for it
  * 
+ * @param propertyNumber property number (example: FM_SEEK_BAND_BOTTOM)
+ * @param parameter property value
+ * @return SI4735PropertyBatch& this batch (add calls can be chained)
  */
-void SI4735::clearRdsBuffer2B()
+SI4735PropertyBatch &SI4735PropertyBatch::add(uint16_t propertyNumber, uint16_t parameter)
 {
-    for (int i = 0; i < 33; i++)
-        rds_buffer2B[i] = ' '; // Radio Text buffer - Station Informaation
-    rds_buffer2B[32] = '\0';
+    uint8_t arg[] = {
+        0x00,
+        (uint8_t)(propertyNumber >> 8), // High byte first
+        (uint8_t)(propertyNumber & 0xFF),
+        (uint8_t)(parameter >> 8),
+        (uint8_t)(parameter & 0xFF)};
+
+    waitToSend();
+    rx->sendCommand(SET_PROPERTY, sizeof arg, arg); // CTS is known here. No wait inside.
+    report.count++;
+    report.bytes += sizeof arg + 1;
+    return *this;
 }
+
 /**
- * @ingroup group16 RDS setup 
+ * @ingroup group10 Generic set and get property
  * 
- * @brief Clear RDS buffer 0A (text)
+ * @brief Waits the last property of the batch and reports the batch costs
  * 
+ * @param result if not NULL, receives the report (see si4735_property_batch_report)
  */
-void SI4735::clearRdsBuffer0A()
+void SI4735PropertyBatch::commit(si4735_property_batch_report *result)
 {
-    for (int i = 0; i < 9; i++)
-        rds_buffer0A[i] = ' '; // Station Name buffer
-    rds_buffer0A[8] = '\0';
+    waitToSend();
+    report.elapsed = micros() - startTime;
+
+    // The former path: fixed delay after each property and one status poll preceded by MIN_DELAY_WAIT_SEND_LOOP.
+    report.savedBytes = (int32_t)report.count - (int32_t)report.polls;
+    report.savedTime = (int32_t)report.count * (LEGACY_DELAY_AFTER_SET_PROPERTY + MIN_DELAY_WAIT_SEND_LOOP) - (int32_t)report.waitTime;
+
+    if (result != NULL)
+        *result = report;
 }
 
 /**
- * @ingroup group16 RDS setup 
- * 
- * @brief Sets RDS property
- * 
- * @details Configures RDS settings to enable RDS processing (RDSEN) and set RDS block error thresholds. 
- * @details When a RDS Group is received, all block errors must be less than or equal the associated block 
- * error threshold for the group to be stored in the RDS FIFO. 
- * @details IMPORTANT: 
- * All block errors must be less than or equal the associated block error threshold 
- * for the group to be stored in the RDS FIFO. 
- * |Value | Description |
- * |------| ----------- | 
- * | 0    | No errors |
- * | 1    | 1–2 bit errors detected and corrected |
- * | 2    | 3–5 bit errors detected and corrected |
- * | 3    | Uncorrectable |
- * 
- * @details Recommended Block Error Threshold options:
- * | Exemples | Description |
- * | -------- | ----------- |
- * | 2,2,2,2  | No group stored if any errors are uncorrected |
- * | 3,3,3,3  | Group stored regardless of errors |
- * | 0,0,0,0  | No group stored containing corrected or uncorrected errors |
- * | 3,2,3,3  | Group stored with corrected errors on B, regardless of errors on A, C, or D | 
+ * @ingroup group10 Generic Command and Response
+ * @brief Sends a given command to the SI47XX devices. 
+ * @details This function can be useful when you want to execute a SI47XX device command and it was not implemented by this library.
+ * @details In this case you have to check the  AN332-Si47XX PROGRAMMING GUIDE to know how the command works. 
+ * @details Also, you need to work with bit operators to compose the parameters of the command [ &(and), ˆ(xor), |(or) etc ].   
+ *
+ * @see getCommandResponse, setProperty
  *  
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 104
- * 
- * @param uint8_t RDSEN RDS Processing Enable; 1 = RDS processing enabled.
- * @param uint8_t BLETHA Block Error Threshold BLOCKA.   
- * @param uint8_t BLETHB Block Error Threshold BLOCKB.  
- * @param uint8_t BLETHC Block Error Threshold BLOCKC.  
- * @param uint8_t BLETHD Block Error Threshold BLOCKD. 
+ * @details The device accepts up to 8 bytes in a single transaction (the command and up to seven arguments). 
+ * @details Arguments beyond the seventh are ignored.
+ *
+ * @param cmd command number (see AN332-Si47XX PROGRAMMING GUIDE)
+ * @param parameter_size Parameter size in bytes. Tell the number of argument used by the command.
+ * @param parameter unsigned byte array with the arguments of the command  
  */
-void SI4735::setRdsConfig(uint8_t RDSEN, uint8_t BLETHA, uint8_t BLETHB, uint8_t BLETHC, uint8_t BLETHD)
+void SI4735::sendCommand(uint8_t cmd, int parameter_size, const uint8_t *parameter)
 {
-    si47x_property property;
-    si47x_rds_config config;
-
-    waitToSend();
-
-    // Set property value
-    property.value = FM_RDS_CONFIG;
-
-    // Arguments
-    config.arg.RDSEN = RDSEN;
-    config.arg.BLETHA = BLETHA;
-    config.arg.BLETHB = BLETHB;
-    config.arg.BLETHC = BLETHC;
-    config.arg.BLETHD = BLETHD;
-    config.arg.DUMMY1 = 0;
+    uint8_t buffer[8];
+    uint8_t size = prepareCommand(buffer, cmd, parameter_size, parameter);
 
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(SET_PROPERTY);
-    Wire.write(0x00);                  // Always 0x00 (I need to check it)
-    Wire.write(property.raw.byteHigh); // Send property - High byte - most significant first
-    Wire.write(property.raw.byteLow);  // Low byte
-    Wire.write(config.raw[1]);         // Send the argments. Most significant first
-    Wire.write(config.raw[0]);
-    Wire.endTransmission();
-    delayMicroseconds(550);
-
-    RdsInit();
+    busWrite(deviceAddress, buffer, size);
+    setCommandPending(getLatencyClass(cmd));
 }
 
-/** 
- * @ingroup group16 RDS setup 
- * 
- * @brief Configures interrupt related to RDS
- * 
- * @details Use this method if want to use interrupt
+/**
+ * @ingroup group10 Generic Command and Response
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 103
+ * @brief Builds the command buffer and waits the device is ready to receive it
  * 
- * @param RDSRECV If set, generate RDSINT when RDS FIFO has at least FM_RDS_INT_FIFO_COUNT entries.
- * @param RDSSYNCLOST If set, generate RDSINT when RDS loses synchronization.
- * @param RDSSYNCFOUND set, generate RDSINT when RDS gains synchronization.
- * @param RDSNEWBLOCKA If set, generate an interrupt when Block A data is found or subsequently changed
- * @param RDSNEWBLOCKB If set, generate an interrupt when Block B data is found or subsequently changed
+ * @param buffer at least 8 bytes 
+ * @param cmd command number
+ * @param parameter_size number of arguments (up to 7)
+ * @param parameter arguments
+ * @return uint8_t number of bytes to be sent 
  */
-void SI4735::setRdsIntSource(uint8_t RDSNEWBLOCKB, uint8_t RDSNEWBLOCKA, uint8_t RDSSYNCFOUND, uint8_t RDSSYNCLOST, uint8_t RDSRECV)
+uint8_t SI4735::prepareCommand(uint8_t *buffer, uint8_t cmd, int parameter_size, const uint8_t *parameter)
 {
-    si47x_property property;
-    si47x_rds_int_source rds_int_source;
+    if (parameter_size > 7)
+        parameter_size = 7;
 
-    if (currentTune != FM_TUNE_FREQ)
-        return;
+    // The command followed by its argments (parameters)
+    buffer[0] = cmd;
+    for (byte i = 0; i < parameter_size; i++)
+        buffer[i + 1] = parameter[i];
 
-    rds_int_source.refined.RDSNEWBLOCKB = RDSNEWBLOCKB;
-    rds_int_source.refined.RDSNEWBLOCKA = RDSNEWBLOCKA;
-    rds_int_source.refined.RDSSYNCFOUND = RDSSYNCFOUND;
-    rds_int_source.refined.RDSSYNCLOST = RDSSYNCLOST;
-    rds_int_source.refined.RDSRECV = RDSRECV;
-    rds_int_source.refined.DUMMY1 = 0;
-    rds_int_source.refined.DUMMY2 = 0;
+    waitToSend();
+    statsCommand(cmd);
 
-    property.value = FM_RDS_INT_SOURCE;
+    // A power up or power down command changes the interrupt setup of the device.
+    if (cmd == POWER_UP || cmd == POWER_DOWN)
+        ctsInterruptArmed = false;
 
-    waitToSend();
+    // Discards old edges. The next waitToSend will wait for the CTS interrupt of this command.
+    interruptFlag = false;
+    ctsPending = (waitMode == WAIT_MODE_INTERRUPT && ctsInterruptArmed);
 
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(SET_PROPERTY);
-    Wire.write(0x00);                  // Always 0x00 (I need to check it)
-    Wire.write(property.raw.byteHigh); // Send property - High byte - most significant first
-    Wire.write(property.raw.byteLow);  // Low byte
-    Wire.write(rds_int_source.raw[1]); // Send the argments. Most significant first
-    Wire.write(rds_int_source.raw[0]);
-    Wire.endTransmission();
-    waitToSend();
+    return parameter_size + 1;
 }
 
 /**
- * @ingroup group16 RDS status 
+ * @ingroup group10 Generic Command and Response
  * 
- * @brief Gets the RDS status. Store the status in currentRdsStatus member. RDS COMMAND FM_RDS_STATUS
+ * @brief Sends a command and gets its response with the minimum number of bus transactions
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 55 and 77
+ * @details If the transport supports repeated start (see setI2CRepeatedStart), the command and the response are 
+ * @details read in a single combined transaction. If the device is not ready yet (CTS = 0), or there is no repeated start,
+ * @details the response is read by getCommandResponse, where the CTS poll itself is the response read.
+ * @details Like getCommandResponse, it does not check the ERR bit.
  * 
- * @param INTACK Interrupt Acknowledge; 0 = RDSINT status preserved. 1 = Clears RDSINT.
- * @param MTFIFO 0 = If FIFO not empty, read and remove oldest FIFO entry; 1 = Clear RDS Receive FIFO.
- * @param STATUSONLY Determines if data should be removed from the RDS FIFO.
+ * @see sendCommand, getCommandResponse
+ * 
+ * @param cmd command number (see AN332-Si47XX PROGRAMMING GUIDE)
+ * @param parameter_size number of arguments
+ * @param parameter arguments
+ * @param response_size response size in bytes
+ * @param response buffer where the response will be stored
  */
-void SI4735::getRdsStatus(uint8_t INTACK, uint8_t MTFIFO, uint8_t STATUSONLY)
+void SI4735::sendCommandResponse(uint8_t cmd, int parameter_size, const uint8_t *parameter, int response_size, uint8_t *response)
 {
-    si47x_rds_command rds_cmd;
-    static uint16_t lastFreq;
-    // checking current FUNC (Am or FM)
-    if (currentTune != FM_TUNE_FREQ)
-        return;
+    uint8_t buffer[8];
+    uint8_t size = prepareCommand(buffer, cmd, parameter_size, parameter);
 
-    if (lastFreq != currentWorkFrequency)
+    if (transport->hasRepeatedStart())
     {
-        lastFreq = currentWorkFrequency;
-        clearRdsBuffer2A();
-        clearRdsBuffer2B();
-        clearRdsBuffer0A();
+        busWriteRead(deviceAddress, buffer, size, response, response_size);
+        setCommandPending(getLatencyClass(cmd));
+        if (response[0] & B10000000)
+        {
+            // The response is already here
+            ctsPending = false;
+            pendingLatencyClass = LATENCY_NONE;
+            return;
+        }
     }
-
-    waitToSend();
-
-    rds_cmd.arg.INTACK = INTACK;
-    rds_cmd.arg.MTFIFO = MTFIFO;
-    rds_cmd.arg.STATUSONLY = STATUSONLY;
-
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(FM_RDS_STATUS);
-    Wire.write(rds_cmd.raw);
-    Wire.endTransmission();
-
-    do
+    else
     {
-        waitToSend();
-        // Gets response information
-        Wire.requestFrom(deviceAddress, 13);
-        for (uint8_t i = 0; i < 13; i++)
-            currentRdsStatus.raw[i] = Wire.read();
-    } while (currentRdsStatus.resp.ERR);
-    delayMicroseconds(550);
+        busWrite(deviceAddress, buffer, size);
+        setCommandPending(getLatencyClass(cmd));
+    }
+
+    getCommandResponse(response_size, response);
 }
 
 /**
- * @ingroup group16 RDS status 
- * 
- * @brief Gets RDS Status.
+ * @ingroup group10 Generic Command and Response
+ * @brief   Returns with the command response.  
+ * @details After a command is executed by the device, you can get the result (response) of the command by calling this method.
+ * @details The CTS poll reads the whole response. So, the read that finds CTS set is also the response (no extra transaction). 
  * 
- * @details Same result of calling getRdsStatus(0,0,0).
- * @details Please, call getRdsStatus(uint8_t INTACK, uint8_t MTFIFO, uint8_t STATUSONLY) instead getRdsStatus() 
- * if you want other behaviour. 
+ * @see sendCommand, sendCommandResponse, setProperty
  * 
- * @see SI4735::getRdsStatus(uint8_t INTACK, uint8_t MTFIFO, uint8_t STATUSONLY)
+ * @param response_size  num of bytes returned by the command.
+ * @param response  byte array where the response will be stored.     
  */
-void SI4735::getRdsStatus()
+void SI4735::getCommandResponse(int response_size, uint8_t *response)
 {
-    getRdsStatus(0, 0, 0);
+    // Asks the device to return a given number o bytes response. The last status poll is the response.
+    waitCts(response_size, response, true);
 }
 
-// See inlines methods / functions on SI4735.h
-
-/**  
- * @ingroup group16 RDS status 
- * 
- * @brief Returns the programa type. 
- * 
- * @details Read the Block A content
+/**
+ * @ingroup group10 Generic Command and Response
+ * @brief Gets the first byte response. 
+ * @details In this context status is the first response byte for any SI47XX command. See si47x_status structure. 
+ * @details This function can be useful to check, for example, the success or failure of a command. 
  * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 77 and 78
+ * @see si47x_status
  * 
- * @return BLOCKAL
+ * @return si47x_status 
  */
-uint16_t SI4735::getRdsPI(void)
+si47x_status SI4735::getStatusResponse()
 {
-    if (getRdsReceived() && getRdsNewBlockA())
-    {
-        return currentRdsStatus.resp.BLOCKAL;
-    }
-    return 0;
+    si47x_status status;
+
+    busRead(deviceAddress, &status.raw, 1);
+
+    return status;
 }
 
 /**
- * @ingroup group16 RDS status 
+ * @ingroup group10 Generic get property
  * 
- * @brief Returns the Group Type (extracted from the Block B)
+ * @brief Gets a given property from the SI47XX
  * 
- * @return BLOCKBL 
+ * @details This method is used to get a given property from SI47XX
+ * @details You might need to extract set of bits information from the returned value to know the real value
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 55, 69, 124 and  134.
+ * @see sendProperty, setProperty, sendCommand, getCommandResponse
+ * 
+ * @param propertyNumber property number (example: RX_VOLUME)
+ * 
+ * @return property value  (the content of the property)
  */
-uint8_t SI4735::getRdsGroupType(void)
+int32_t
+SI4735::getProperty(uint16_t propertyNumber)
 {
-    si47x_rds_blockb blkb;
+    si47x_property property;
+    si47x_status status;
 
-    blkb.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
-    blkb.raw.highValue = currentRdsStatus.resp.BLOCKBH;
+    uint8_t response[4];
 
-    return blkb.refined.groupType;
+    property.value = propertyNumber;
+
+    uint8_t arg[] = {
+        0x00,
+        property.raw.byteHigh, // Send property - High byte - most significant first
+        property.raw.byteLow}; // Send property - Low byte - less significant after
+
+    sendCommandResponse(GET_PROPERTY, sizeof arg, arg, 4, response);
+    status.raw = response[0];
+
+    // if error, return 0;
+    if (status.refined.ERR == 1)
+        return -1;
+
+    // response[1] is dummy
+
+    // gets the property value
+    property.raw.byteHigh = response[2];
+    property.raw.byteLow = response[3];
+
+    return property.value;
 }
 
+/** @defgroup group12 FM Mono Stereo audio setup */
+
 /**
- * @ingroup group16 RDS status 
+ * @ingroup group12 FM Mono Stereo audio setup
+ *  
+ * @brief Sets RSSI threshold for stereo blend (Full stereo above threshold, blend below threshold). 
  * 
- * @brief Returns the current Text Flag A/B  
+ * @details To force stereo, set this to 0. To force mono, set this to 127.
  * 
- * @return uint8_t current Text Flag A/B  
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 90. 
+ * 
+ * @param parameter  valid values: 0 to 127
  */
-uint8_t SI4735::getRdsFlagAB(void)
+void SI4735::setFmBlendStereoThreshold(uint8_t parameter)
 {
-    si47x_rds_blockb blkb;
-
-    blkb.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
-    blkb.raw.highValue = currentRdsStatus.resp.BLOCKBH;
-
-    return blkb.refined.textABFlag;
+    sendProperty(FM_BLEND_STEREO_THRESHOLD, parameter);
 }
 
 /**
- * @ingroup group16 RDS status 
+ * @ingroup group12 FM Mono Stereo audio setup
  * 
- * @brief Returns the address of the text segment.
+ * @brief Sets RSSI threshold for mono blend (Full mono below threshold, blend above threshold). 
  * 
- * @details 2A - Each text segment in version 2A groups consists of four characters. A messages of this group can be 
- * have up to 64 characters. 
- * @details 2B - In version 2B groups, each text segment consists of only two characters. When the current RDS status is
- *      using this version, the maximum message length will be 32 characters.
+ * @details To force stereo set this to 0. To force mono set this to 127. Default value is 30 dBμV.
  * 
- * @return uint8_t the address of the text segment.
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 56.
+ * 
+ * @param parameter valid values: 0 to 127
  */
-uint8_t SI4735::getRdsTextSegmentAddress(void)
+void SI4735::setFmBlendMonoThreshold(uint8_t parameter)
 {
-    si47x_rds_blockb blkb;
-    blkb.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
-    blkb.raw.highValue = currentRdsStatus.resp.BLOCKBH;
-
-    return blkb.refined.content;
+    sendProperty(FM_BLEND_MONO_THRESHOLD, parameter);
 }
 
-/**
- * @ingroup group16 RDS status 
+/** 
+ * @ingroup group12 FM Mono Stereo audio setup
  * 
- * @brief Gets the version code (extracted from the Block B)
+ * @brief Sets RSSI threshold for stereo blend. (Full stereo above threshold, blend below threshold.) 
  * 
- * @returns  0=A or 1=B
+ * @details To force stereo, set this to 0. To force mono, set this to 127. Default value is 49 dBμV.
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 59. 
+ * 
+ * @param parameter valid values: 0 to 127
  */
-uint8_t SI4735::getRdsVersionCode(void)
+void SI4735::setFmBlendRssiStereoThreshold(uint8_t parameter)
 {
-    si47x_rds_blockb blkb;
-
-    blkb.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
-    blkb.raw.highValue = currentRdsStatus.resp.BLOCKBH;
-
-    return blkb.refined.versionCode;
+    sendProperty(FM_BLEND_RSSI_STEREO_THRESHOLD, parameter);
 }
 
-/**  
- * @ingroup group16 RDS status 
+/** 
+ * @ingroup group12 FM Mono Stereo audio setup
  * 
- * @brief Returns the Program Type (extracted from the Block B)
+ * @brief Sets RSSI threshold for mono blend (Full mono below threshold, blend above threshold). 
  * 
- * @see https://en.wikipedia.org/wiki/Radio_Data_System
+ * @details To force stereo, set this to 0. To force mono, set this to 127. Default value is 30 dBμV.
  * 
- * @return program type (an integer betwenn 0 and 31)
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 59.  
+ * 
+ * @param parameter valid values: 0 to 127
  */
-uint8_t SI4735::getRdsProgramType(void)
+void SI4735::setFmBLendRssiMonoThreshold(uint8_t parameter)
 {
-    si47x_rds_blockb blkb;
-
-    blkb.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
-    blkb.raw.highValue = currentRdsStatus.resp.BLOCKBH;
-
-    return blkb.refined.programType;
+    sendProperty(FM_BLEND_RSSI_MONO_THRESHOLD, parameter);
 }
 
 /**
- * @ingroup group16 RDS status 
+ * @ingroup group12 FM Mono Stereo audio setup
  * 
- * @brief Process data received from group 2B
+ * @brief Sets SNR threshold for stereo blend (Full stereo above threshold, blend below threshold). 
  * 
- * @param c  char array reference to the "group 2B" text 
+ * @details To force stereo, set this to 0. To force mono, set this to 127. Default value is 27 dB.
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 59.  
+ * 
+ * @param parameter valid values: 0 to 127
  */
-void SI4735::getNext2Block(char *c)
+void SI4735::setFmBlendSnrStereoThreshold(uint8_t parameter)
 {
-    char raw[2];
-    int i, j;
-
-    raw[1] = currentRdsStatus.resp.BLOCKDL;
-    raw[0] = currentRdsStatus.resp.BLOCKDH;
-
-    for (i = j = 0; i < 2; i++)
-    {
-        if (raw[i] == 0xD || raw[i] == 0xA)
-        {
-            c[j] = '\0';
-            return;
-        }
-        if (raw[i] >= 32)
-        {
-            c[j] = raw[i];
-            j++;
-        }
-        else
-        {
-            c[i] = ' ';
-        }
-    }
+    sendProperty(FM_BLEND_SNR_STEREO_THRESHOLD, parameter);
 }
 
 /**
- * @ingroup group16 RDS status 
+ * @ingroup group12 FM Mono Stereo audio setup
  * 
- * @brief Process data received from group 2A
+ * @brief Sets SNR threshold for mono blend (Full mono below threshold, blend above threshold). 
  * 
- * @param c  char array reference to the "group  2A" text 
+ * @details To force stereo, set this to 0. To force mono, set this to 127. Default value is 14 dB.
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 59. 
+ * 
+ * @param parameter valid values: 0 to 127 
  */
-void SI4735::getNext4Block(char *c)
+void SI4735::setFmBLendSnrMonoThreshold(uint8_t parameter)
 {
-    char raw[4];
-    int i, j;
-
-    raw[0] = currentRdsStatus.resp.BLOCKCH;
-    raw[1] = currentRdsStatus.resp.BLOCKCL;
-    raw[2] = currentRdsStatus.resp.BLOCKDH;
-    raw[3] = currentRdsStatus.resp.BLOCKDL;
-    for (i = j = 0; i < 4; i++)
-    {
-        if (raw[i] == 0xD || raw[i] == 0xA)
-        {
-            c[j] = '\0';
-            return;
-        }
-        if (raw[i] >= 32)
-        {
-            c[j] = raw[i];
-            j++;
-        }
-        else
-        {
-            c[i] = ' ';
-        }
-    }
+    sendProperty(FM_BLEND_SNR_MONO_THRESHOLD, parameter);
 }
 
-/**
+/** 
+ * @ingroup group12 FM Mono Stereo audio setup
+ * 
+ * @brief Sets multipath threshold for stereo blend (Full stereo below threshold, blend above threshold). 
+ * 
+ * @details To force stereo, set this to 100. To force mono, set this to 0. Default value is 20.
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 60.
+ * 
+ * @param parameter valid values: 0 to 100 
+ */
+void SI4735::setFmBlendMultiPathStereoThreshold(uint8_t parameter)
+{
+    sendProperty(FM_BLEND_MULTIPATH_STEREO_THRESHOLD, parameter);
+}
+
+/**
+ * @ingroup group12 FM Mono Stereo audio setup
+ * 
+ * @brief Sets Multipath threshold for mono blend (Full mono above threshold, blend below threshold). 
+ * 
+ * @details To force stereo, set to 100. To force mono, set to 0. The default is 60.
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 60.
+ * 
+ * @param parameter valid values: 0 to 100 
+ */
+void SI4735::setFmBlendMultiPathMonoThreshold(uint8_t parameter)
+{
+    sendProperty(FM_BLEND_MULTIPATH_MONO_THRESHOLD, parameter);
+}
+
+/** 
+ * @ingroup group12 FM Mono Stereo audio setup
+ * @todo 
+ * @brief Turn Off Stereo operation.
+ */
+void SI4735::setFmStereoOff()
+{
+    //! TO DO
+}
+
+/** 
+ * @ingroup group12 FM Mono Stereo audio setup
+ * @todo 
+ * @brief Turn Off Stereo operation.
+ */
+void SI4735::setFmStereoOn()
+{
+    //! TO DO
+}
+
+/**
+ * @ingroup group12 FM Mono Stereo audio setup
+ * 
+ * @brief There is a debug feature that remains active in Si4704/05/3x-D60 firmware which can create periodic noise in audio.
+ * 
+ * @details Silicon Labs recommends you disable this feature by sending the following bytes (shown here in hexadecimal form):
+ * 0x12 0x00 0xFF 0x00 0x00 0x00.
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 299. 
+ */
+void SI4735::disableFmDebug()
+{
+    const uint8_t debug_off[] = {0x12, 0x00, 0xFF, 0x00, 0x00, 0x00};
+
+    busWrite(deviceAddress, debug_off, sizeof debug_off);
+    statsCommand(SET_PROPERTY);
+    setCommandPending(LATENCY_PROPERTY);
+    waitMicroseconds(2500);
+}
+
+/** @defgroup group13 Audio setup */
+
+/**
+ * @ingroup group13 Digital Audio setup
+ * 
+ * @brief Configures the digital audio output format. 
+ * 
+ * @details Options: DCLK edge, data format, force mono, and sample precision.
+ *  
+ * ATTENTION: The document AN383; "Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES"; rev 0.8; page 6; there is the following note:
+ *            Crystal and digital audio mode cannot be used at the same time. Populate R1 and remove C10, C11, and X1 when using digital audio.
+ * 
+ * @see Si47XX PROGRAMINGGUIDE; AN332 (REV 1.0); page 195.
+ * @see Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES"; AN383; rev 0.8; page 6; 
+
+ * @param uint8_t OSIZE Dgital Output Audio Sample Precision (0=16 bits, 1=20 bits, 2=24 bits, 3=8bits).
+ * @param uint8_t OMONO Digital Output Mono Mode (0=Use mono/stereo blend ).
+ * @param uint8_t OMODE Digital Output Mode (0=I2S, 6 = Left-justified, 8 = MSB at second DCLK after DFS pulse, 12 = MSB at first DCLK after DFS pulse).
+ * @param uint8_t OFALL Digital Output DCLK Edge (0 = use DCLK rising edge, 1 = use DCLK falling edge)
+ */
+void SI4735::digitalOutputFormat(uint8_t OSIZE, uint8_t OMONO, uint8_t OMODE, uint8_t OFALL)
+{
+    si4735_digital_output_format df;
+    df.refined.OSIZE = OSIZE;
+    df.refined.OMONO = OMONO;
+    df.refined.OMODE = OMODE;
+    df.refined.OFALL = OFALL;
+    df.refined.dummy = 0;
+    sendProperty(DIGITAL_OUTPUT_FORMAT, df.raw);
+}
+
+/**
+ * @ingroup group13 Digital Audio setup
+ * 
+ * @brief Enables digital audio output and configures digital audio output sample rate in samples per second (sps).
+ * 
+ * ATTENTION: The document AN383; "Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES"; rev 0.8; page 6; there is the following note:
+ *            Crystal and digital audio mode cannot be used at the same time. Populate R1 and remove C10, C11, and X1 when using digital audio.
+ * 
+ * @see Si47XX PROGRAMINGGUIDE; AN332 (REV 1.0); page 196. 
+ * @see Si47XX ANTENNA, SCHEMATIC, LAYOUT, AND DESIGN GUIDELINES; AN383; rev 0.8; page 6
+ * 
+ * @param uint16_t DOSR Diital Output Sample Rate(32–48 ksps .0 to disable digital audio output).
+ */
+void SI4735::digitalOutputSampleRate(uint16_t DOSR)
+{
+    sendProperty(DIGITAL_OUTPUT_SAMPLE_RATE, DOSR);
+}
+
+/** 
+ * @ingroup group13 Audio volume
+ * 
+ * @brief Sets volume level (0  to 63)
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 62, 123, 170, 173 and 204
+ * 
+ * @param uint8_t volume (domain: 0 - 63) 
+ */
+void SI4735::setVolume(uint8_t volume)
+{
+    sendProperty(RX_VOLUME, volume);
+    this->volume = volume;
+}
+
+/**
+ * @ingroup group13 Audio volume
+ * @brief Sets the audio on or off. 
+ * @details Useful to mute the audio output of the SI47XX device. This function does not work to reduce the pop in the speaker at start the system up.
+ * @details If you want to remove the loud click or pop in the speaker at start, power down and power up commands, use setHardwareAudioMute with a external mute circuit. 
+ * 
+ * @see See Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 62, 123, 171 
+ * @see setHardwareAudioMute
+ * 
+ * @param value if true, mute the audio; if false unmute the audio.
+ */
+void SI4735::setAudioMute(bool off)
+{
+    uint16_t value = (off) ? 3 : 0; // 3 means mute; 0 means unmute
+    sendProperty(RX_HARD_MUTE, value);
+}
+
+
+
+/**
+ * @ingroup group13 Aud volume
+ * 
+ * @brief Gets the current volume level.
+ * 
+ * @see setVolume()
+ * 
+ * @return volume (domain: 0 - 63) 
+ */
+uint8_t SI4735::getVolume()
+{
+    return this->volume;
+}
+
+/**
+ * @ingroup group13 Audio volume
+ *  
+ * @brief Set sound volume level Up   
+ *  
+ * @see setVolume()
+ */
+void SI4735::volumeUp()
+{
+    if (volume < 63)
+        volume++;
+    setVolume(volume);
+}
+
+/**
+ * @ingroup group13 Audio volume
+ *  
+ * @brief Set sound volume level Down   
+ * 
+ * @see setVolume() 
+ */
+void SI4735::volumeDown()
+{
+    if (volume > 0)
+        volume--;
+    setVolume(volume);
+}
+
+/**
+ * @defgroup group16 FM RDS/RBDS
+ * @todo RDS Dynamic PS or Scrolling PS support  
+ */
+
+/*******************************************************************************
+ * RDS implementation 
+ ******************************************************************************/
+
+/**
+ * @ingroup group16 RDS setup 
+ *  
+ * @brief  Starts the control member variables for RDS.
+ * 
+ * @details This method is called by setRdsConfig()
+ * 
+ * @see setRdsConfig()
+ */
+void SI4735::RdsInit()
+{
+    clearRdsBuffer2A();
+    clearRdsBuffer2B();
+    clearRdsBuffer0A();
+    rdsTextAdress2A = rdsTextAdress2B = lastTextFlagAB = rdsTextAdress0A = 0;
+}
+
+/**
+ * @ingroup group16 RDS setup 
+ *  
+ * @brief Clear RDS buffer 2A (text) 
+ * 
+ */
+void SI4735::clearRdsBuffer2A()
+{
+    for (int i = 0; i < 65; i++)
+        rds_buffer2A[i] = ' '; // Radio Text buffer - Program Information
+    rds_buffer2A[64] = '\0';
+}
+
+/**
+ * @ingroup group16 RDS setup 
+ * 
+ * @brief Clear RDS buffer 2B (text)
+ * 
+ */
+void SI4735::clearRdsBuffer2B()
+{
+    for (int i = 0; i < 33; i++)
+        rds_buffer2B[i] = ' '; // Radio Text buffer - Station Informaation
+    rds_buffer2B[32] = '\0';
+}
+/**
+ * @ingroup group16 RDS setup 
+ * 
+ * @brief Clear RDS buffer 0A (text)
+ * 
+ */
+void SI4735::clearRdsBuffer0A()
+{
+    for (int i = 0; i < 9; i++)
+        rds_buffer0A[i] = ' '; // Station Name buffer
+    rds_buffer0A[8] = '\0';
+}
+
+/**
+ * @ingroup group16 RDS setup 
+ * 
+ * @brief Sets RDS property
+ * 
+ * @details Configures RDS settings to enable RDS processing (RDSEN) and set RDS block error thresholds. 
+ * @details When a RDS Group is received, all block errors must be less than or equal the associated block 
+ * error threshold for the group to be stored in the RDS FIFO. 
+ * @details IMPORTANT: 
+ * All block errors must be less than or equal the associated block error threshold 
+ * for the group to be stored in the RDS FIFO. 
+ * |Value | Description |
+ * |------| ----------- | 
+ * | 0    | No errors |
+ * | 1    | 1–2 bit errors detected and corrected |
+ * | 2    | 3–5 bit errors detected and corrected |
+ * | 3    | Uncorrectable |
+ * 
+ * @details Recommended Block Error Threshold options:
+ * | Exemples | Description |
+ * | -------- | ----------- |
+ * | 2,2,2,2  | No group stored if any errors are uncorrected |
+ * | 3,3,3,3  | Group stored regardless of errors |
+ * | 0,0,0,0  | No group stored containing corrected or uncorrected errors |
+ * | 3,2,3,3  | Group stored with corrected errors on B, regardless of errors on A, C, or D | 
+ *  
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 104
+ * 
+ * @param uint8_t RDSEN RDS Processing Enable; 1 = RDS processing enabled.
+ * @param uint8_t BLETHA Block Error Threshold BLOCKA.   
+ * @param uint8_t BLETHB Block Error Threshold BLOCKB.  
+ * @param uint8_t BLETHC Block Error Threshold BLOCKC.  
+ * @param uint8_t BLETHD Block Error Threshold BLOCKD. 
+ */
+void SI4735::setRdsConfig(uint8_t RDSEN, uint8_t BLETHA, uint8_t BLETHB, uint8_t BLETHC, uint8_t BLETHD)
+{
+    si47x_property property;
+    si47x_rds_config config;
+
+    // Set property value
+    property.value = FM_RDS_CONFIG;
+
+    // Arguments
+    config.arg.RDSEN = RDSEN;
+    config.arg.BLETHA = BLETHA;
+    config.arg.BLETHB = BLETHB;
+    config.arg.BLETHC = BLETHC;
+    config.arg.BLETHD = BLETHD;
+    config.arg.DUMMY1 = 0;
+
+    uint8_t arg[] = {
+        0x00,                  // Always 0x00 (I need to check it)
+        property.raw.byteHigh, // Send property - High byte - most significant first
+        property.raw.byteLow,  // Low byte
+        config.raw[1],         // Send the argments. Most significant first
+        config.raw[0]};
+
+    sendCommand(SET_PROPERTY, sizeof arg, arg);
+
+    RdsInit();
+}
+
+/** 
+ * @ingroup group16 RDS setup 
+ * 
+ * @brief Configures interrupt related to RDS
+ * 
+ * @details Use this method if want to use interrupt
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 103
+ * 
+ * @param RDSRECV If set, generate RDSINT when RDS FIFO has at least FM_RDS_INT_FIFO_COUNT entries.
+ * @param RDSSYNCLOST If set, generate RDSINT when RDS loses synchronization.
+ * @param RDSSYNCFOUND set, generate RDSINT when RDS gains synchronization.
+ * @param RDSNEWBLOCKA If set, generate an interrupt when Block A data is found or subsequently changed
+ * @param RDSNEWBLOCKB If set, generate an interrupt when Block B data is found or subsequently changed
+ */
+void SI4735::setRdsIntSource(uint8_t RDSNEWBLOCKB, uint8_t RDSNEWBLOCKA, uint8_t RDSSYNCFOUND, uint8_t RDSSYNCLOST, uint8_t RDSRECV)
+{
+    si47x_property property;
+    si47x_rds_int_source rds_int_source;
+
+    if (currentTune != FM_TUNE_FREQ)
+        return;
+
+    rds_int_source.refined.RDSNEWBLOCKB = RDSNEWBLOCKB;
+    rds_int_source.refined.RDSNEWBLOCKA = RDSNEWBLOCKA;
+    rds_int_source.refined.RDSSYNCFOUND = RDSSYNCFOUND;
+    rds_int_source.refined.RDSSYNCLOST = RDSSYNCLOST;
+    rds_int_source.refined.RDSRECV = RDSRECV;
+    rds_int_source.refined.DUMMY1 = 0;
+    rds_int_source.refined.DUMMY2 = 0;
+
+    property.value = FM_RDS_INT_SOURCE;
+
+    uint8_t arg[] = {
+        0x00,                  // Always 0x00 (I need to check it)
+        property.raw.byteHigh, // Send property - High byte - most significant first
+        property.raw.byteLow,  // Low byte
+        rds_int_source.raw[1], // Send the argments. Most significant first
+        rds_int_source.raw[0]};
+
+    sendCommand(SET_PROPERTY, sizeof arg, arg);
+    waitToSend();
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Gets the RDS status. Store the status in currentRdsStatus member. RDS COMMAND FM_RDS_STATUS
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 55 and 77
+ * 
+ * @param INTACK Interrupt Acknowledge; 0 = RDSINT status preserved. 1 = Clears RDSINT.
+ * @param MTFIFO 0 = If FIFO not empty, read and remove oldest FIFO entry; 1 = Clear RDS Receive FIFO.
+ * @param STATUSONLY Determines if data should be removed from the RDS FIFO.
+ */
+void SI4735::getRdsStatus(uint8_t INTACK, uint8_t MTFIFO, uint8_t STATUSONLY)
+{
+    si47x_rds_command rds_cmd;
+    // checking current FUNC (Am or FM)
+    if (currentTune != FM_TUNE_FREQ)
+        return;
+
+    if (rdsLastFrequency != currentWorkFrequency)
+    {
+        rdsLastFrequency = currentWorkFrequency;
+        clearRdsBuffer2A();
+        clearRdsBuffer2B();
+        clearRdsBuffer0A();
+    }
+
+    rds_cmd.arg.INTACK = INTACK;
+    rds_cmd.arg.MTFIFO = MTFIFO;
+    rds_cmd.arg.STATUSONLY = STATUSONLY;
+
+    // Gets response information
+    sendCommandResponse(FM_RDS_STATUS, 1, &rds_cmd.raw, 13, currentRdsStatus.raw);
+    while (currentRdsStatus.resp.ERR)
+    {
+        statsErrRetry();
+        getCommandResponse(13, currentRdsStatus.raw);
+    }
+    waitMicroseconds(550);
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Gets RDS Status.
+ * 
+ * @details Same result of calling getRdsStatus(0,0,0).
+ * @details Please, call getRdsStatus(uint8_t INTACK, uint8_t MTFIFO, uint8_t STATUSONLY) instead getRdsStatus() 
+ * if you want other behaviour. 
+ * 
+ * @see SI4735::getRdsStatus(uint8_t INTACK, uint8_t MTFIFO, uint8_t STATUSONLY)
+ */
+void SI4735::getRdsStatus()
+{
+    getRdsStatus(0, 0, 0);
+}
+
+// See inlines methods / functions on SI4735.h
+
+/**  
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Returns the programa type. 
+ * 
+ * @details Read the Block A content
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 77 and 78
+ * 
+ * @return BLOCKAL
+ */
+uint16_t SI4735::getRdsPI(void)
+{
+    if (getRdsReceived() && getRdsNewBlockA())
+    {
+        return currentRdsStatus.resp.BLOCKAL;
+    }
+    return 0;
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Returns the Group Type (extracted from the Block B)
+ * 
+ * @return BLOCKBL 
+ */
+uint8_t SI4735::getRdsGroupType(void)
+{
+    si47x_rds_blockb blkb;
+
+    blkb.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
+    blkb.raw.highValue = currentRdsStatus.resp.BLOCKBH;
+
+    return blkb.refined.groupType;
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Returns the current Text Flag A/B  
+ * 
+ * @return uint8_t current Text Flag A/B  
+ */
+uint8_t SI4735::getRdsFlagAB(void)
+{
+    si47x_rds_blockb blkb;
+
+    blkb.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
+    blkb.raw.highValue = currentRdsStatus.resp.BLOCKBH;
+
+    return blkb.refined.textABFlag;
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Returns the address of the text segment.
+ * 
+ * @details 2A - Each text segment in version 2A groups consists of four characters. A messages of this group can be 
+ * have up to 64 characters. 
+ * @details 2B - In version 2B groups, each text segment consists of only two characters. When the current RDS status is
+ *      using this version, the maximum message length will be 32 characters.
+ * 
+ * @return uint8_t the address of the text segment.
+ */
+uint8_t SI4735::getRdsTextSegmentAddress(void)
+{
+    si47x_rds_blockb blkb;
+    blkb.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
+    blkb.raw.highValue = currentRdsStatus.resp.BLOCKBH;
+
+    return blkb.refined.content;
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Gets the version code (extracted from the Block B)
+ * 
+ * @returns  0=A or 1=B
+ */
+uint8_t SI4735::getRdsVersionCode(void)
+{
+    si47x_rds_blockb blkb;
+
+    blkb.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
+    blkb.raw.highValue = currentRdsStatus.resp.BLOCKBH;
+
+    return blkb.refined.versionCode;
+}
+
+/**  
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Returns the Program Type (extracted from the Block B)
+ * 
+ * @see https://en.wikipedia.org/wiki/Radio_Data_System
+ * 
+ * @return program type (an integer betwenn 0 and 31)
+ */
+uint8_t SI4735::getRdsProgramType(void)
+{
+    si47x_rds_blockb blkb;
+
+    blkb.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
+    blkb.raw.highValue = currentRdsStatus.resp.BLOCKBH;
+
+    return blkb.refined.programType;
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Process data received from group 2B
+ * 
+ * @param c  char array reference to the "group 2B" text 
+ */
+void SI4735::getNext2Block(char *c)
+{
+    char raw[2];
+    int i, j;
+
+    raw[1] = currentRdsStatus.resp.BLOCKDL;
+    raw[0] = currentRdsStatus.resp.BLOCKDH;
+
+    for (i = j = 0; i < 2; i++)
+    {
+        if (raw[i] == 0xD || raw[i] == 0xA)
+        {
+            c[j] = '\0';
+            return;
+        }
+        if (raw[i] >= 32)
+        {
+            c[j] = raw[i];
+            j++;
+        }
+        else
+        {
+            // Non printable characters keep their position in the segment
+            c[j] = ' ';
+            j++;
+        }
+    }
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Process data received from group 2A
+ * 
+ * @param c  char array reference to the "group  2A" text 
+ */
+void SI4735::getNext4Block(char *c)
+{
+    char raw[4];
+    int i, j;
+
+    raw[0] = currentRdsStatus.resp.BLOCKCH;
+    raw[1] = currentRdsStatus.resp.BLOCKCL;
+    raw[2] = currentRdsStatus.resp.BLOCKDH;
+    raw[3] = currentRdsStatus.resp.BLOCKDL;
+    for (i = j = 0; i < 4; i++)
+    {
+        if (raw[i] == 0xD || raw[i] == 0xA)
+        {
+            c[j] = '\0';
+            return;
+        }
+        if (raw[i] >= 32)
+        {
+            c[j] = raw[i];
+            j++;
+        }
+        else
+        {
+            // Non printable characters keep their position in the segment
+            c[j] = ' ';
+            j++;
+        }
+    }
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Gets the RDS Text when the message is of the Group Type 2 version A
+ * 
+ * @return char*  The string (char array) with the content (Text) received from group 2A 
+ */
+char *SI4735::getRdsText(void)
+{
+
+    // Needs to get the "Text segment address code".
+    // Each message should be ended by the code 0D (Hex)
+
+    if (rdsTextAdress2A >= 16)
+        rdsTextAdress2A = 0;
+
+    getNext4Block(&rds_buffer2A[rdsTextAdress2A * 4]);
+
+    rdsTextAdress2A += 4;
+
+    return rds_buffer2A;
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * @todo RDS Dynamic PS or Scrolling PS 
+ * @brief Gets the station name and other messages. 
+ * 
+ * @return char* should return a string with the station name. 
+ *         However, some stations send other kind of messages
+ */
+char *SI4735::getRdsText0A(void)
+{
+    si47x_rds_blockb blkB;
+
+    // getRdsStatus();
+
+    if (getRdsReceived())
+    {
+        if (getRdsGroupType() == 0)
+        {
+            // Process group type 0
+            blkB.raw.highValue = currentRdsStatus.resp.BLOCKBH;
+            blkB.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
+
+            rdsTextAdress0A = blkB.group0.address;
+            if (rdsTextAdress0A >= 0 && rdsTextAdress0A < 4)
+            {
+                getNext2Block(&rds_buffer0A[rdsTextAdress0A * 2]);
+                rds_buffer0A[8] = '\0';
+                return rds_buffer0A;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Gets the Text processed for the 2A group
+ * 
+ * @return char* string with the Text of the group A2  
+ */
+char *SI4735::getRdsText2A(void)
+{
+    si47x_rds_blockb blkB;
+
+    // getRdsStatus();
+    if (getRdsReceived())
+    {
+        if (getRdsGroupType() == 2 /* && getRdsVersionCode() == 0 */)
+        {
+            // Process group 2A
+            // Decode B block information
+            blkB.raw.highValue = currentRdsStatus.resp.BLOCKBH;
+            blkB.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
+            rdsTextAdress2A = blkB.group2.address;
+
+            if (rdsTextAdress2A >= 0 && rdsTextAdress2A < 16)
+            {
+                getNext4Block(&rds_buffer2A[rdsTextAdress2A * 4]);
+                rds_buffer2A[63] = '\0';
+                return rds_buffer2A;
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @ingroup group16 RDS status 
+ * 
+ * @brief Gets the Text processed for the 2B group
+ * 
+ * @return char* string with the Text of the group AB  
+ */
+char *SI4735::getRdsText2B(void)
+{
+    si47x_rds_blockb blkB;
+
+    // getRdsStatus();
+    // if (getRdsReceived())
+    // {
+    // if (getRdsNewBlockB())
+    // {
+    if (getRdsGroupType() == 2 /* && getRdsVersionCode() == 1 */)
+    {
+        // Process group 2B
+        blkB.raw.highValue = currentRdsStatus.resp.BLOCKBH;
+        blkB.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
+        rdsTextAdress2B = blkB.group2.address;
+        if (rdsTextAdress2B >= 0 && rdsTextAdress2B < 16)
+        {
+            getNext2Block(&rds_buffer2B[rdsTextAdress2B * 2]);
+            rds_buffer2B[32] = '\0'; 
+            return rds_buffer2B;
+        }
+    }
+    //  }
+    // }
+    return NULL;
+}
+
+/**
  * @ingroup group16 RDS status 
  * 
- * @brief Gets the RDS Text when the message is of the Group Type 2 version A
+ * @brief Gets the RDS time and date when the Group type is 4 
+ * 
+ * @return char* a string with hh:mm +/- offset
+ */
+char *SI4735::getRdsTime()
+{
+    // Under Test and construction
+    // Need to check the Group Type before.
+    si47x_rds_date_time dt;
+
+    uint16_t minute;
+    uint16_t hour;
+
+    if (getRdsGroupType() == 4)
+    {
+        char offset_sign;
+        int offset_h;
+        int offset_m;
+
+        // uint16_t y, m, d;
+
+        dt.raw[4] = currentRdsStatus.resp.BLOCKBL;
+        dt.raw[5] = currentRdsStatus.resp.BLOCKBH;
+        dt.raw[2] = currentRdsStatus.resp.BLOCKCL;
+        dt.raw[3] = currentRdsStatus.resp.BLOCKCH;
+        dt.raw[0] = currentRdsStatus.resp.BLOCKDL;
+        dt.raw[1] = currentRdsStatus.resp.BLOCKDH;
+
+        // Unfortunately it was necessary to wotk well on the GCC compiler on 32-bit
+        // platforms. See si47x_rds_date_time (typedef union) and CGG “Crosses boundary” issue/features.
+        // Now it is working on Atmega328, STM32, Arduino DUE, ESP32 and more.
+        minute = (dt.refined.minute2 << 2) | dt.refined.minute1;
+        hour = (dt.refined.hour2 << 4) | dt.refined.hour1;
+
+        offset_sign = (dt.refined.offset_sense == 1) ? '+' : '-';
+        offset_h = (dt.refined.offset * 30) / 60;
+        offset_m = (dt.refined.offset * 30) - (offset_h * 60);
+        // sprintf(rds_time, "%02u:%02u %c%02u:%02u", dt.refined.hour, dt.refined.minute, offset_sign, offset_h, offset_m);
+        sprintf(rds_time, "%02u:%02u %c%02u:%02u", hour, minute, offset_sign, offset_h, offset_m);
+
+        return rds_time;
+    }
+
+    return NULL;
+}
+
+/**
+ * @defgroup group17 Si4735-D60 Single Side Band (SSB) support
+ * 
+ * @brief Single Side Band (SSB) implementation.<br>  
+ * First of all, it is important to say that the SSB patch content **is not part of this library**. 
+ * The paches used here were made available by Mr. Vadim Afonkin on his [Dropbox repository](https://www.dropbox.com/sh/xzofrl8rfaaqh59/AAA5au2_CVdi50NBtt0IivyIa?dl=0). 
+ * It is important to note that the author of this library does not encourage anyone to use the SSB patches content for commercial purposes.
+ * In other words, this library only supports SSB patches, the patches themselves are not part of this library.  
+ * 
+ * @details This implementation was tested only on Si4735-D60  and SI4732-A10 devices. 
+ * @details SSB modulation is a refinement of amplitude modulation that one of the side band and the carrier are suppressed.
+ * 
+ * @details What does SSB patch means?
+ * In this context, a patch is a piece of software used to change the behavior of the SI4735-D60/SI4732-A10 device.
+ * There is little information available about patching the SI4735-D60/SI4732-A10.
+ *  
+ * The following information is the understanding of the author of this project and 
+ * it is not necessarily correct. 
+ * 
+ * A patch is executed internally (run by internal MCU) of the device. Usually, 
+ * patches are used to fixes bugs or add improvements and new features of the firmware
+ * installed in the internal ROM of the device. Patches to the SI4735 are distributed
+ * in binary form and have to be transferred to the internal RAM of the device by the 
+ * host MCU (in this case Arduino boards). 
+ * Since the RAM is volatile memory, the patch stored into the device gets lost when 
+ * you turn off the system. Consequently, the content of the patch has to be transferred
+ * again to the device each time after turn on the system or reset the device.
+ * 
+ * I would like to thank Mr Vadim Afonkin for making available the SSBRX patches for 
+ * SI4735-D60/SI4732-A10 on his Dropbox repository. On this repository you have two files, 
+ * amrx_6_0_1_ssbrx_patch_full_0x9D29.csg and amrx_6_0_1_ssbrx_patch_init_0xA902.csg. 
+ * It is important to know that the patch content of the original files is constant 
+ * hexadecimal representation used by the language C/C++. Actally, the original files 
+ * are in ASCII format (not in binary format). 
+ * If you are not using C/C++ or if you want to load the files directly to the SI4735, 
+ * you must convert the values to numeric value of the hexadecimal constants. 
+ * For example: 0x15 = 21 (00010101); 0x16 = 22 (00010110); 0x01 = 1 (00000001); 
+ * 0xFF = 255 (11111111);
+ * 
+ * @details ATTENTION: The author of this project does not guarantee that procedures shown 
+ * here will work in your development environment. Given this, it is at your own risk 
+ * to continue with the procedures suggested here. This library works with the I²C 
+ * communication protocol and it is designed to apply a SSB extension PATCH to  
+ * SI4735-D60 and SI4732-A10 devices. Once again, the author disclaims any liability for any damage this 
+ * procedure may cause to your SI4735-D60 or SI4732-A10 or other devices that you are using.
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; pages 3 and 5 
+ */
+
+/**
+ * @ingroup group17 Patch and SSB support 
+ *  
+ * @brief Sets the SSB Beat Frequency Offset (BFO). 
+ * 
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; pages 5 and 23
+ * 
+ * @param offset 16-bit signed value (unit in Hz). The valid range is -16383 to +16383 Hz. 
+ */
+void SI4735::setSSBBfo(int offset)
+{
+
+    si47x_property property;
+    si47x_frequency bfo_offset;
+
+    if (currentTune == FM_TUNE_FREQ) // Only for AM/SSB mode
+        return;
+
+    property.value = SSB_BFO;
+    bfo_offset.value = offset;
+
+    uint8_t arg[] = {
+        0x00,                  // Always 0x00
+        property.raw.byteHigh, // High byte first
+        property.raw.byteLow,  // Low byte after
+        bfo_offset.raw.FREQH,  // Offset freq. high byte first
+        bfo_offset.raw.FREQL}; // Offset freq. low byte first
+
+    sendCommand(SET_PROPERTY, sizeof arg, arg);
+}
+
+/**
+ * @ingroup group17 Patch and SSB support
+ * 
+ * @brief Sets the SSB receiver mode.
+ * 
+ * @details You can use this method for:  
+ * @details 1) Enable or disable AFC track to carrier function for receiving normal AM signals;
+ * @details 2) Set the audio bandwidth;
+ * @details 3) Set the side band cutoff filter;
+ * @details 4) Set soft-mute based on RSSI or SNR;
+ * @details 5) Enable or disbable automatic volume control (AVC) function. 
+ * 
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
+ * 
+ * @param AUDIOBW SSB Audio bandwidth; 0 = 1.2kHz (default); 1=2.2kHz; 2=3kHz; 3=4kHz; 4=500Hz; 5=1kHz.
+ * @param SBCUTFLT SSB side band cutoff filter for band passand low pass filter
+ *                 if 0, the band pass filter to cutoff both the unwanted side band and high frequency 
+ *                  component > 2kHz of the wanted side band (default).
+ * @param AVC_DIVIDER set 0 for SSB mode; set 3 for SYNC mode.
+ * @param AVCEN SSB Automatic Volume Control (AVC) enable; 0=disable; 1=enable (default).
+ * @param SMUTESEL SSB Soft-mute Based on RSSI or SNR.
+ * @param DSP_AFCDIS DSP AFC Disable or enable; 0=SYNC MODE, AFC enable; 1=SSB MODE, AFC disable. 
+ */
+void SI4735::setSSBConfig(uint8_t AUDIOBW, uint8_t SBCUTFLT, uint8_t AVC_DIVIDER, uint8_t AVCEN, uint8_t SMUTESEL, uint8_t DSP_AFCDIS)
+{
+    if (currentTune == FM_TUNE_FREQ) // Only AM/SSB mode
+        return;
+
+    currentSSBMode.param.AUDIOBW = AUDIOBW;
+    currentSSBMode.param.SBCUTFLT = SBCUTFLT;
+    currentSSBMode.param.AVC_DIVIDER = AVC_DIVIDER;
+    currentSSBMode.param.AVCEN = AVCEN;
+    currentSSBMode.param.SMUTESEL = SMUTESEL;
+    currentSSBMode.param.DUMMY1 = 0;
+    currentSSBMode.param.DSP_AFCDIS = DSP_AFCDIS;
+
+    sendSSBModeProperty();
+}
+
+/**
+ * @ingroup group17 Patch and SSB support
+ * 
+ * @brief Sets DSP AFC disable or enable
+ * 
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
+ * 
+ * @param DSP_AFCDIS 0 = SYNC mode, AFC enable; 1 = SSB mode, AFC disable
+ */
+void SI4735::setSSBDspAfc(uint8_t DSP_AFCDIS)
+{
+    currentSSBMode.param.DSP_AFCDIS = DSP_AFCDIS;
+    sendSSBModeProperty();
+}
+
+/**
+ * @ingroup group17 Patch and SSB support 
+ * 
+ * @brief Sets SSB Soft-mute Based on RSSI or SNR Selection: 
+ * 
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
+ * 
+ * @param SMUTESEL  0 = Soft-mute based on RSSI (default); 1 = Soft-mute based on SNR.
+ */
+void SI4735::setSSBSoftMute(uint8_t SMUTESEL)
+{
+    currentSSBMode.param.SMUTESEL = SMUTESEL;
+    sendSSBModeProperty();
+}
+
+/**
+ * @ingroup group17 Patch and SSB support
+ * 
+ * @brief Sets SSB Automatic Volume Control (AVC) for SSB mode
+ * 
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
+ * 
+ * @param AVCEN 0 = Disable AVC; 1 = Enable AVC (default).
+ */
+void SI4735::setSSBAutomaticVolumeControl(uint8_t AVCEN)
+{
+    currentSSBMode.param.AVCEN = AVCEN;
+    sendSSBModeProperty();
+}
+
+/**
+ * @ingroup group17 Patch and SSB support
+ * 
+ * @brief Sets AVC Divider
+ * 
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24  
+ * 
+ * @param AVC_DIVIDER  SSB mode, set divider = 0; SYNC mode, set divider = 3; Other values = not allowed.
+ */
+void SI4735::setSSBAvcDivider(uint8_t AVC_DIVIDER)
+{
+    currentSSBMode.param.AVC_DIVIDER = AVC_DIVIDER;
+    sendSSBModeProperty();
+}
+
+/**  
+ * @ingroup group17 Patch and SSB support
+ * 
+ * @brief Sets SBB Sideband Cutoff Filter for band pass and low pass filters.
+ * 
+ * @details 0 = Band pass filter to cutoff both the unwanted side band and high frequency components > 2.0 kHz of the wanted side band. (default)
+ * @details 1 = Low pass filter to cutoff the unwanted side band. 
+ * Other values = not allowed.
+ *
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
+ *  
+ * @param SBCUTFLT 0 or 1; see above
+ */
+void SI4735::setSBBSidebandCutoffFilter(uint8_t SBCUTFLT)
+{
+    currentSSBMode.param.SBCUTFLT = SBCUTFLT;
+    sendSSBModeProperty();
+}
+
+/**
+ * @ingroup group17 Patch and SSB support
+ * 
+ * @brief SSB Audio Bandwidth for SSB mode
+ * 
+ * @details 0 = 1.2 kHz low-pass filter  (default).
+ * @details 1 = 2.2 kHz low-pass filter.
+ * @details 2 = 3.0 kHz low-pass filter.
+ * @details 3 = 4.0 kHz low-pass filter.
+ * @details 4 = 500 Hz band-pass filter for receiving CW signal, i.e. [250 Hz, 750 Hz] with center 
+ * frequency at 500 Hz when USB is selected or [-250 Hz, -750 1Hz] with center frequency at -500Hz 
+ * when LSB is selected* .
+ * @details 5 = 1 kHz band-pass filter for receiving CW signal, i.e. [500 Hz, 1500 Hz] with center 
+ * frequency at 1 kHz when USB is selected or [-500 Hz, -1500 1 Hz] with center frequency 
+ *     at -1kHz when LSB is selected.
+ * @details Other values = reserved.
+ * 
+ * @details If audio bandwidth selected is about 2 kHz or below, it is recommended to set SBCUTFLT[3:0] to 0 
+ * to enable the band pass filter for better high- cut performance on the wanted side band. Otherwise, set it to 1.
+ * 
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
+ * 
+ * @param AUDIOBW the valid values are 0, 1, 2, 3, 4 or 5; see description above
+ */
+void SI4735::setSSBAudioBandwidth(uint8_t AUDIOBW)
+{
+    // Sets the audio filter property parameter
+    currentSSBMode.param.AUDIOBW = AUDIOBW;
+    sendSSBModeProperty();
+}
+
+/**
+ * @ingroup group17 Patch and SSB support
+ * 
+ * @brief Set the radio to AM function. 
+ * 
+ * @todo Adjust the power up parameters
+ * 
+ * @details Set the radio to SSB (LW/MW/SW) function. 
+ * 
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; pages 13 and 14 
+ * @see setAM()
+ * @see setFrequencyStep()
+ * @see void SI4735::setFrequency(uint16_t freq)
+ * 
+ * @param usblsb upper or lower side band;  1 = LSB; 2 = USB
+ */
+void SI4735::setSSB(uint8_t usblsb)
+{
+    // Is it needed to load patch when switch to SSB?
+    // powerDown();
+    // It starts with the same AM parameters.
+    // setPowerUp(1, 1, 0, 1, 1, currentAudioMode);
+    setPowerUp(this->currentInterruptEnable, this->currentInterruptEnable, 0, this->currentClockType, 1, currentAudioMode);
+    radioPowerUp();
+    // ssbPowerUp(); // Not used for regular operation
+    setVolume(volume); // Set to previus configured volume
+    currentSsbStatus = usblsb;
+    lastMode = SSB_CURRENT_MODE;
+}
+
+/**
+ * @ingroup group17 Patch and SSB support
+ *  
+ * @details Tunes the SSB (LSB or USB) receiver to a frequency between 520 and 30 MHz in 1 kHz steps. 
+ * 
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; pages 13 and 14
+ * @see setAM()
+ * @see setFrequencyStep()
+ * @see void SI4735::setFrequency(uint16_t freq)
+ * 
+ * @param fromFreq minimum frequency for the band
+ * @param toFreq maximum frequency for the band
+ * @param initialFreq initial frequency 
+ * @param step step used to go to the next channel  
+ * @param usblsb SSB Upper Side Band (USB) and Lower Side Band (LSB) Selection; 
+ *               value 2 (banary 10) = USB; 
+ *               value 1 (banary 01) = LSB.   
+ */
+void SI4735::setSSB(uint16_t fromFreq, uint16_t toFreq, uint16_t initialFreq, uint16_t step, uint8_t usblsb)
+{
+    currentMinimumFrequency = fromFreq;
+    currentMaximumFrequency = toFreq;
+    currentStep = step;
+
+    if (initialFreq < fromFreq || initialFreq > toFreq)
+        initialFreq = fromFreq;
+
+    setSSB(usblsb);
+
+    currentWorkFrequency = initialFreq;
+    setFrequency(currentWorkFrequency);
+    // delayMicroseconds(550);
+}
+
+/**  
+ * @ingroup group17 Patch and SSB support
+ * 
+ * @brief Just send the property SSB_MOD to the device.  Internal use (privete method). 
+ */
+void SI4735::sendSSBModeProperty()
+{
+    si47x_property property;
+    property.value = SSB_MODE;
+
+    uint8_t arg[] = {
+        0x00,                  // Always 0x00
+        property.raw.byteHigh, // High byte first
+        property.raw.byteLow,  // Low byte after
+        currentSSBMode.raw[1], // SSB MODE params; freq. high byte first
+        currentSSBMode.raw[0]}; // SSB MODE params; freq. low byte after
+
+    sendCommand(SET_PROPERTY, sizeof arg, arg);
+}
+
+/**
+ * @ingroup group17 AGC 
+ * 
+ * @brief Queries SSB Automatic Gain Control STATUS
+ * @details After call this method, you can call isAgcEnabled to know the AGC status and getAgcGainIndex to know the gain index value.
+ * 
+ * @see AN332 REV 0.8 Universal Programming Guide Amendment for SI4735-D60 SSB and NBFM patches; page 18. 
+ * 
+ */
+void SI4735::getSsbAgcStatus()
+{
+    sendCommandResponse(SSB_AGC_STATUS, 0, NULL, 3, currentAgcStatus.raw); // STATUS response, RESP 1 and RESP 2
+    while (currentAgcStatus.refined.ERR)                                     // If error, try get AGC status again.
+    {
+        statsErrRetry();
+        getCommandResponse(3, currentAgcStatus.raw);
+    }
+}
+
+/** 
+ * @ingroup group17  
+ * 
+ * @brief Automatic Gain Control setup 
+ * @details Overrides the SSB AGC setting by disabling the AGC and forcing the gain index that ranges between 0 (minimum attenuation) and 37+ATTN_BACKUP (maximum attenuation). 
+ * 
+ * @param uint8_t SSBAGCDIS This param selects whether the AGC is enabled or disabled (0 = AGC enabled; 1 = AGC disabled);
+ * @param uint8_t SSBAGCNDX If 1, this byte forces the AGC gain index. if 0,  Minimum attenuation (max gain)
+ *                
+ */
+void SI4735::setSsbAgcOverrite(uint8_t SSBAGCDIS, uint8_t SSBAGCNDX)
+{
+    si47x_agc_overrride agc;
+
+    agc.arg.AGCDIS = SSBAGCDIS;
+    agc.arg.AGCIDX = SSBAGCNDX;
+
+    sendCommand(SSB_AGC_OVERRIDE, 2, agc.raw);
+
+    waitToSend();
+}
+
+
+
+/***************************************************************************************
+ * SI47XX PATCH RESOURCES
+ **************************************************************************************/
+
+/** 
+ * @ingroup group17 Patch and SSB support
+ * 
+ * @brief Query the library information of the Si47XX device 
  * 
- * @return char*  The string (char array) with the content (Text) received from group 2A 
- */
-char *SI4735::getRdsText(void)
+ * @details Used to confirm if the patch is compatible with the internal device library revision.
+ * 
+ * @details You have to call this function if you are applying a patch on SI47XX (SI4735-D60/SI4732-A10).
+ * @details The first command that is sent to the device is the POWER_UP command to confirm 
+ * that the patch is compatible with the internal device library revision. 
+ * @details The device moves into the powerup mode, returns the reply, and moves into the 
+ * powerdown mode. 
+ * @details The POWER_UP command is sent to the device again to configure 
+ * the mode of the device and additionally is used to start the patching process.
+ * @details When applying the patch, the PATCH bit in ARG1 of the POWER_UP command must be 
+ * set to 1 to begin the patching process. [AN332 (REV 1.0) page 219].
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 64 and 215-220.
+ * @see struct si47x_firmware_query_library
+ *
+ * @return a struct si47x_firmware_query_library (see it in SI4735.h)
+*/
+si47x_firmware_query_library SI4735::queryLibraryId()
 {
+    si47x_firmware_query_library libraryID;
+    const uint8_t arg[] = {
+        0b00011111,           // Set to Read Library ID, disable interrupt; disable GPO2OEN; boot normaly; enable External Crystal Oscillator  .
+        SI473X_ANALOG_AUDIO}; // Set to Analog Line Input.
 
-    // Needs to get the "Text segment address code".
-    // Each message should be ended by the code 0D (Hex)
+    powerDown(); // Is it necessary
 
-    if (rdsTextAdress2A >= 16)
-        rdsTextAdress2A = 0;
+    // delay(500);
 
-    getNext4Block(&rds_buffer2A[rdsTextAdress2A * 4]);
+    sendCommand(POWER_UP, sizeof arg, arg);
 
-    rdsTextAdress2A += 4;
+    getCommandResponse(8, libraryID.raw);
+    while (libraryID.resp.ERR) // If error found, try it again.
+    {
+        statsErrRetry();
+        getCommandResponse(8, libraryID.raw);
+    }
 
-    return rds_buffer2A;
+    waitMicroseconds(2500);
+
+    return libraryID;
 }
 
-/**
- * @ingroup group16 RDS status 
- * @todo RDS Dynamic PS or Scrolling PS 
- * @brief Gets the station name and other messages. 
+/**  
+ * @ingroup group17 Patch and SSB support
+ *  
+ * @brief This method can be used to prepare the device to apply SSBRX patch
+ *  
+ * @details Call queryLibraryId before call this method. Powerup the device by issuing the POWER_UP 
+ * command with FUNC = 1 (AM/SW/LW Receive).
  * 
- * @return char* should return a string with the station name. 
- *         However, some stations send other kind of messages
+ * @see setMaxDelaySetFrequency()
+ * @see MAX_DELAY_AFTER_POWERUP 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 64 and 215-220 and
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE AMENDMENT FOR SI4735-D60 SSB AND NBFM PATCHES; page 7.
  */
-char *SI4735::getRdsText0A(void)
+void SI4735::patchPowerUp()
 {
-    si47x_rds_blockb blkB;
-
-    // getRdsStatus();
+    const uint8_t arg[] = {
+        0b00110001,           // This is a condition for loading the patch: Set to AM, Enable External Crystal Oscillator; Set patch enable; GPO2 output disabled; CTS interrupt disabled. You can change this calling setSSB.
+        SI473X_ANALOG_AUDIO}; // This is a condition for loading the patch: Set to Analog Output. You can change this calling setSSB.
 
-    if (getRdsReceived())
-    {
-        if (getRdsGroupType() == 0)
-        {
-            // Process group type 0
-            blkB.raw.highValue = currentRdsStatus.resp.BLOCKBH;
-            blkB.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
+    sendCommand(POWER_UP, sizeof arg, arg);
+    waitMicroseconds(maxDelayAfterPouwerUp * 1000UL);
+}
 
-            rdsTextAdress0A = blkB.group0.address;
-            if (rdsTextAdress0A >= 0 && rdsTextAdress0A < 4)
-            {
-                getNext2Block(&rds_buffer0A[rdsTextAdress0A * 2]);
-                rds_buffer0A[8] = '\0';
-                return rds_buffer0A;
-            }
-        }
-    }
-    return NULL;
+/**
+ * @ingroup group17 Patch and SSB support
+ * 
+ * @brief This function can be useful for debug and test. 
+ */
+void SI4735::ssbPowerUp()
+{
+    const uint8_t arg[] = {
+        0b00010001,  // This is a condition for loading the patch: Set to AM, Enable External Crystal Oscillator; Set patch enable; GPO2 output disabled; CTS interrupt disabled. You can change this calling setSSB.
+        0b00000101}; // This is a condition for loading the patch: Set to Analog Output. You can change this calling setSSB.
+
+    sendCommand(POWER_UP, sizeof arg, arg);
+    waitMicroseconds(2500);
+
+    powerUp.arg.CTSIEN = this->currentInterruptEnable;  // 1 -> Interrupt anabled;
+    powerUp.arg.GPO2OEN = this->currentInterruptEnable; // 1 -> GPO2 Output Enable;
+    powerUp.arg.PATCH = 0;                              // 0 -> Boot normally;
+    powerUp.arg.XOSCEN = this->currentClockType;        // 1 -> Use external crystal oscillator;
+    powerUp.arg.FUNC = 1;                               // 0 = FM Receive; 1 = AM/SSB (LW/MW/SW) Receiver.
+    powerUp.arg.OPMODE = 0b00000101;                    // 0x5 = 00000101 = Analog audio outputs (LOUT/ROUT).
 }
 
 /**
- * @ingroup group16 RDS status 
+ * @ingroup group17 Patch and SSB support
+ *  
+ * @brief Transfers the content of a patch stored in a array of bytes to the SI4735 device. 
+ *  
+ * @details You must mount an array as shown below and know the size of that array as well.
  * 
- * @brief Gets the Text processed for the 2A group
+ *  @details It is importante to say  that patches to the SI4735 are distributed in binary form and 
+ *  have to be transferred to the internal RAM of the device by the host MCU (in this case Arduino).
+ *  Since the RAM is volatile memory, the patch stored into the device gets lost when you turn off 
+ *  the system. Consequently, the content of the patch has to be transferred again to the device 
+ *  each time after turn on the system or reset the device.
  * 
- * @return char* string with the Text of the group A2  
+ *  @details The disadvantage of this approach is the amount of memory used by the patch content. 
+ *  This may limit the use of other radio functions you want implemented in Arduino.
+ * 
+ *  @details Example of content:
+ *  @code
+ *  const PROGMEM uint8_t ssb_patch_content_full[] =
+ *   { // SSB patch for whole SSBRX full download
+ *       0x15, 0x00, 0x0F, 0xE0, 0xF2, 0x73, 0x76, 0x2F,
+ *       0x16, 0x6F, 0x26, 0x1E, 0x00, 0x4B, 0x2C, 0x58,
+ *       0x16, 0xA3, 0x74, 0x0F, 0xE0, 0x4C, 0x36, 0xE4,
+ *          .
+ *          .
+ *          .
+ *       0x16, 0x3B, 0x1D, 0x4A, 0xEC, 0x36, 0x28, 0xB7,
+ *       0x16, 0x00, 0x3A, 0x47, 0x37, 0x00, 0x00, 0x00,
+ *       0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9D, 0x29};   
+ * 
+ *  const int size_content_full = sizeof ssb_patch_content_full;
+ *  @endcode
+ * 
+ * @see Si47XX PROGRAMMING GUIDE; ;AN332 (REV 1.0) pages 64 and 215-220.  
+ * 
+ *  @param ssb_patch_content point to array of bytes content patch.
+ *  @param ssb_patch_content_size array size (number of bytes). The maximum size allowed for a patch is 15856 bytes
+ * 
+ *  @return false if an error is found.
  */
-char *SI4735::getRdsText2A(void)
+bool SI4735::downloadPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size)
 {
-    si47x_rds_blockb blkB;
-
-    // getRdsStatus();
-    if (getRdsReceived())
+    uint8_t content[8];
+    register int i, offset;
+    // Send patch to the SI4735 device
+    for (offset = 0; offset < (int)ssb_patch_content_size; offset += 8)
     {
-        if (getRdsGroupType() == 2 /* && getRdsVersionCode() == 0 */)
+        for (i = 0; i < 8; i++)
+            content[i] = pgm_read_byte_near(ssb_patch_content + (i + offset));
+        busWrite(deviceAddress, content, 8);
+        statsCommand(content[0]);
+        setCommandPending(LATENCY_PATCH);
+
+        // Testing download performance
+        // approach 1 - Faster - less secure (it might crash in some architectures)
+        // Expected time of a patch line (see setCommandLatency). CTS is not checked here, so MIN_DELAY_WAIT_SEND_LOOP is the floor.
+        waitMicroseconds((commandLatency[LATENCY_PATCH] > MIN_DELAY_WAIT_SEND_LOOP) ? commandLatency[LATENCY_PATCH] : MIN_DELAY_WAIT_SEND_LOOP);
+
+        // approach 2 - More control. A little more secure than approach 1
+        /*
+        do
         {
-            // Process group 2A
-            // Decode B block information
-            blkB.raw.highValue = currentRdsStatus.resp.BLOCKBH;
-            blkB.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
-            rdsTextAdress2A = blkB.group2.address;
+            delayMicroseconds(150); // Minimum delay founded (Need check the minimum value)
+            Wire.requestFrom(deviceAddress, 1);
+        } while (!(Wire.read() & B10000000));
+        */
 
-            if (rdsTextAdress2A >= 0 && rdsTextAdress2A < 16)
-            {
-                getNext4Block(&rds_buffer2A[rdsTextAdress2A * 4]);
-                rds_buffer2A[63] = '\0';
-                return rds_buffer2A;
-            }
-        }
+        // approach 3 - same approach 2
+        // waitToSend();
+
+        // approach 4 - safer
+        /*
+        waitToSend();
+        uint8_t cmd_status;
+        // Uncomment the lines below if you want to check erro.
+        Wire.requestFrom(deviceAddress, 1);
+        cmd_status = Wire.read();
+        // The SI4735 issues a status after each 8 byte transfered.
+        // Just the bit 7 (CTS) should be seted. if bit 6 (ERR) is seted, the system halts.
+        if (cmd_status != 0x80)
+           return false;
+        */
     }
-    return NULL;
+    waitMicroseconds(250);
+    return true;
 }
 
 /**
- * @ingroup group16 RDS status 
+ * @ingroup group17 Patch and SSB support
+ * @brief Loads a given SSB patch content
+ * @details Configures the Si4735-D60/SI4732-A10 device to work with SSB. 
  * 
- * @brief Gets the Text processed for the 2B group
+ * @param ssb_patch_content        point to patch content array 
+ * @param ssb_patch_content_size   size of patch content 
+ * @param ssb_audiobw              SSB Audio bandwidth; 0 = 1.2kHz (default); 1=2.2kHz; 2=3kHz; 3=4kHz; 4=500Hz; 5=1kHz.
+ */
+void SI4735::loadPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size, uint8_t ssb_audiobw)
+{
+    queryLibraryId(); 
+    patchPowerUp();
+    waitMicroseconds(50000);
+    downloadPatch(ssb_patch_content, ssb_patch_content_size);
+    // Parameters
+    // AUDIOBW - SSB Audio bandwidth; 0 = 1.2kHz (default); 1=2.2kHz; 2=3kHz; 3=4kHz; 4=500Hz; 5=1kHz;
+    // SBCUTFLT SSB - side band cutoff filter for band passand low pass filter ( 0 or 1)
+    // AVC_DIVIDER  - set 0 for SSB mode; set 3 for SYNC mode.
+    // AVCEN - SSB Automatic Volume Control (AVC) enable; 0=disable; 1=enable (default).
+    // SMUTESEL - SSB Soft-mute Based on RSSI or SNR (0 or 1).
+    // DSP_AFCDIS - DSP AFC Disable or enable; 0=SYNC MODE, AFC enable; 1=SSB MODE, AFC disable.
+    setSSBConfig(ssb_audiobw, 1, 0, 0, 0, 1);
+    waitMicroseconds(25000);
+}
+
+/**
+ * @ingroup group17 Patch and SSB support
+ * @brief Transfers the content of a patch stored in an eeprom to the SI4735 device.
+ * @details To used this method, you will need an eeprom with the patch content stored into it. 
+ * @details This content have to be generated by the sketch [SI47XX_09_SAVE_SSB_PATCH_EEPROM](https://github.com/pu2clr/SI4735/tree/master/examples/TOOLS/SI47XX_09_SAVE_SSB_PATCH_EEPROM) on folder TOOLS.
  * 
- * @return char* string with the Text of the group AB  
+ * @see SI47XX_09_SAVE_SSB_PATCH_EEPROM
+ * @see si4735_eeprom_patch_header 
+ * @ref https://github.com/pu2clr/SI4735/tree/master/examples/TOOLS/SI47XX_09_SAVE_SSB_PATCH_EEPROM
+ * 
+ * @param eeprom_i2c_address 
+ * @return false if an error is found.
  */
-char *SI4735::getRdsText2B(void)
+si4735_eeprom_patch_header SI4735::downloadPatchFromEeprom(int eeprom_i2c_address)
 {
-    si47x_rds_blockb blkB;
+    si4735_eeprom_patch_header eep;
+    const int header_size = sizeof eep;
+    uint8_t bufferAux[8];
+    uint8_t eeprom_offset[2] = {0x00, 0x00}; // offset Most significant Byte and Less significant Byte
+    int offset, i;
 
-    // getRdsStatus();
-    // if (getRdsReceived())
-    // {
-    // if (getRdsNewBlockB())
-    // {
-    if (getRdsGroupType() == 2 /* && getRdsVersionCode() == 1 */)
+    // Gets the EEPROM patch header information
+    busWrite(eeprom_i2c_address, eeprom_offset, 2);
+    waitMicroseconds(5000);
+
+    // The first two bytes of the header will be ignored.
+    for (int k = 0; k < header_size; k += 8)
+        busRead(eeprom_i2c_address, &eep.raw[k], 8);
+
+    // Transferring patch from EEPROM to SI4735 device
+    offset = header_size;
+    for (i = 0; i < (int)eep.refined.patch_size; i += 8)
     {
-        // Process group 2B
-        blkB.raw.highValue = currentRdsStatus.resp.BLOCKBH;
-        blkB.raw.lowValue = currentRdsStatus.resp.BLOCKBL;
-        rdsTextAdress2B = blkB.group2.address;
-        if (rdsTextAdress2B >= 0 && rdsTextAdress2B < 16)
+        // Reads patch content from EEPROM
+        eeprom_offset[0] = (int)offset >> 8;   // header_size >> 8 wil be always 0 in this case
+        eeprom_offset[1] = (int)offset & 0XFF; // offset Less significant Byte
+        busWrite(eeprom_i2c_address, eeprom_offset, 2);
+        busRead(eeprom_i2c_address, bufferAux, 8);
+
+        busWrite(deviceAddress, bufferAux, 8);
+        statsCommand(bufferAux[0]);
+        setCommandPending(LATENCY_PATCH);
+
+        waitToSend();
+        uint8_t cmd_status;
+        busRead(deviceAddress, &cmd_status, 1);
+        // The SI4735 issues a status after each 8 byte transfered.Just the bit 7(CTS)should be seted.if bit 6(ERR)is seted, the system halts.
+        if (cmd_status != 0x80)
         {
-            getNext2Block(&rds_buffer2B[rdsTextAdress2B * 2]);
-            rds_buffer2B[32] = '\0'; 
-            return rds_buffer2B;
+            strcpy((char *)eep.refined.patch_id, "error!");
+            return eep;
         }
+        offset += 8; // Start processing the next 8 bytes
     }
-    //  }
-    // }
-    return NULL;
+
+    waitMicroseconds(50000);
+    return eep;
 }
 
 /**
- * @ingroup group16 RDS status 
- * 
- * @brief Gets the RDS time and date when the Group type is 4 
- * 
- * @return char* a string with hh:mm +/- offset
+ * @ingroup group17 Patch and SSB support
+ * @brief Writes a block of data to an I2C EEPROM (24C32 or larger; two address bytes)
+ * @details Uses the same addressing of downloadPatchFromEeprom. The data is written in EEPROM_PAGE_SIZE bytes transactions
+ * @details aligned to the EEPROM page. After each transaction, the EEPROM is polled (ACK polling) until its write cycle is done.
+ * @details So, there is no fixed 5 or 10 ms delay per page.
+ *
+ * @see eepromRead, downloadPatchFromEeprom, SI4735StationDb
+ *
+ * @param eeprom_i2c_address EEPROM I2C address (for example, 0x50)
+ * @param offset first EEPROM address
+ * @param data data to be written
+ * @param size number of bytes
+ * @return false if the EEPROM did not acknowledge a write or did not finish a write cycle in EEPROM_WRITE_TIME us
  */
-char *SI4735::getRdsTime()
+bool SI4735::eepromWrite(uint8_t eeprom_i2c_address, uint16_t offset, const uint8_t *data, uint16_t size)
 {
-    // Under Test and construction
-    // Need to check the Group Type before.
-    si47x_rds_date_time dt;
-
-    uint16_t minute;
-    uint16_t hour;
+    uint8_t buffer[EEPROM_PAGE_SIZE + 2];
 
-    if (getRdsGroupType() == 4)
+    while (size > 0)
     {
-        char offset_sign;
-        int offset_h;
-        int offset_m;
+        uint8_t chunk = EEPROM_PAGE_SIZE - (offset % EEPROM_PAGE_SIZE); // Does not cross a page
+        if (chunk > size)
+            chunk = size;
+
+        buffer[0] = offset >> 8;   // offset Most significant Byte
+        buffer[1] = offset & 0xFF; // offset Less significant Byte
+        memcpy(&buffer[2], data, chunk);
+        if (busWrite(eeprom_i2c_address, buffer, chunk + 2) != 0)
+            return false;
+
+        // ACK polling: the EEPROM does not acknowledge its address while the write cycle runs
+        uint32_t start = micros();
+        do
+        {
+            if ((micros() - start) > EEPROM_WRITE_TIME)
+                return false;
+            waitMicroseconds(EEPROM_POLL_INTERVAL);
+        } while (busWrite(eeprom_i2c_address, buffer, 2) != 0);
+
+        offset += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+    return true;
+}
 
-        // uint16_t y, m, d;
+/**
+ * @ingroup group17 Patch and SSB support
+ * @brief Reads a block of data from an I2C EEPROM (24C32 or larger; two address bytes)
+ * @details Sets the EEPROM address once and reads the block sequentially in EEPROM_PAGE_SIZE bytes transactions.
+ *
+ * @see eepromWrite, downloadPatchFromEeprom, SI4735StationDb
+ *
+ * @param eeprom_i2c_address EEPROM I2C address (for example, 0x50)
+ * @param offset first EEPROM address
+ * @param data receives the data
+ * @param size number of bytes
+ * @return false if the EEPROM did not acknowledge the address or returned less bytes than requested
+ */
+bool SI4735::eepromRead(uint8_t eeprom_i2c_address, uint16_t offset, uint8_t *data, uint16_t size)
+{
+    uint8_t eeprom_offset[2] = {(uint8_t)(offset >> 8), (uint8_t)(offset & 0xFF)};
 
-        dt.raw[4] = currentRdsStatus.resp.BLOCKBL;
-        dt.raw[5] = currentRdsStatus.resp.BLOCKBH;
-        dt.raw[2] = currentRdsStatus.resp.BLOCKCL;
-        dt.raw[3] = currentRdsStatus.resp.BLOCKCH;
-        dt.raw[0] = currentRdsStatus.resp.BLOCKDL;
-        dt.raw[1] = currentRdsStatus.resp.BLOCKDH;
+    if (busWrite(eeprom_i2c_address, eeprom_offset, 2) != 0)
+        return false;
 
-        // Unfortunately it was necessary to wotk well on the GCC compiler on 32-bit
-        // platforms. See si47x_rds_date_time (typedef union) and CGG “Crosses boundary” issue/features.
-        // Now it is working on Atmega328, STM32, Arduino DUE, ESP32 and more.
-        minute = (dt.refined.minute2 << 2) | dt.refined.minute1;
-        hour = (dt.refined.hour2 << 4) | dt.refined.hour1;
+    while (size > 0)
+    {
+        uint8_t chunk = (size > EEPROM_PAGE_SIZE) ? EEPROM_PAGE_SIZE : size;
+        if (busRead(eeprom_i2c_address, data, chunk) != chunk)
+            return false;
+        data += chunk;
+        size -= chunk;
+    }
+    return true;
+}
 
-        offset_sign = (dt.refined.offset_sense == 1) ? '+' : '-';
-        offset_h = (dt.refined.offset * 30) / 60;
-        offset_m = (dt.refined.offset * 30) - (offset_h * 60);
-        // sprintf(rds_time, "%02u:%02u %c%02u:%02u", dt.refined.hour, dt.refined.minute, offset_sign, offset_h, offset_m);
-        sprintf(rds_time, "%02u:%02u %c%02u:%02u", hour, minute, offset_sign, offset_h, offset_m);
+/**
+ * @ingroup group17 Patch and SSB support
+ * @brief Gets the first EEPROM address after the SSB patch stored by SI47XX_09_SAVE_SSB_PATCH_EEPROM
+ * @details Use it to place other data (see SI4735StationDb and SI4735EepromStore) in the same EEPROM without clobbering the patch.
+ * @details The address is rounded up to EEPROM_PAGE_SIZE. So, no page is shared with the patch.
+ * @details If the EEPROM has no patch (or the patch size in the header runs past EEPROM_MAX_SIZE), the first page after the 
+ * @details patch header is returned. So, the header stays free, but SI47XX_09_SAVE_SSB_PATCH_EEPROM writes the patch over any 
+ * @details data stored after it: store the patch first.
+ *
+ * @see downloadPatchFromEeprom, si4735_eeprom_patch_header
+ *
+ * @param eeprom_i2c_address EEPROM I2C address (for example, 0x50)
+ * @return uint16_t first free address (32 to EEPROM_MAX_SIZE - EEPROM_PAGE_SIZE); the page after the patch header if the EEPROM has no valid patch (or did not answer)
+ */
+uint16_t SI4735::getEepromPatchEnd(uint8_t eeprom_i2c_address)
+{
+    si4735_eeprom_patch_header eep;
+    uint32_t end = sizeof eep;
 
-        return rds_time;
-    }
+    // A blank EEPROM (0xFFFF) or a garbage size would run past the EEPROM (and wrap the address to the patch header)
+    if (eepromRead(eeprom_i2c_address, 0, eep.raw, sizeof eep) && end + eep.refined.patch_size <= EEPROM_MAX_SIZE - EEPROM_PAGE_SIZE)
+        end += eep.refined.patch_size;
 
-    return NULL;
+    return (uint16_t)((end + EEPROM_PAGE_SIZE - 1) / EEPROM_PAGE_SIZE * EEPROM_PAGE_SIZE);
 }
 
 /**
- * @defgroup group17 Si4735-D60 Single Side Band (SSB) support
+ * @defgroup group20 SI4735-D60 / SI4732-A10  NBFM 
  * 
- * @brief Single Side Band (SSB) implementation.<br>  
- * First of all, it is important to say that the SSB patch content **is not part of this library**. 
- * The paches used here were made available by Mr. Vadim Afonkin on his [Dropbox repository](https://www.dropbox.com/sh/xzofrl8rfaaqh59/AAA5au2_CVdi50NBtt0IivyIa?dl=0). 
- * It is important to note that the author of this library does not encourage anyone to use the SSB patches content for commercial purposes.
- * In other words, this library only supports SSB patches, the patches themselves are not part of this library.  
+ * @brief Narrow Band FM (Frequency Modulation) implementation.<br>  
+ * First of all, it is important to say that the NBFM patch content **is not part of this library**. 
+ * It is important to note that the author of this library does not encourage anyone to use the NBFM patches content for commercial purposes.
+ * In other words, this library only supports NBFM patches, the patches themselves are not part of this library.  
  * 
  * @details This implementation was tested only on Si4735-D60  and SI4732-A10 devices. 
- * @details SSB modulation is a refinement of amplitude modulation that one of the side band and the carrier are suppressed.
+ * @details This implementation is applicable to Si47035-D60 and SI4732-A10 when powering up the part in FM mode with the NBFM patch
  * 
- * @details What does SSB patch means?
+ * @details What does NBFM patch means?
  * In this context, a patch is a piece of software used to change the behavior of the SI4735-D60/SI4732-A10 device.
  * There is little information available about patching the SI4735-D60/SI4732-A10.
  *  
@@ -2532,7 +4234,7 @@ char *SI4735::getRdsTime()
  * 
  * A patch is executed internally (run by internal MCU) of the device. Usually, 
  * patches are used to fixes bugs or add improvements and new features of the firmware
- * installed in the internal ROM of the device. Patches to the SI4735 are distributed
+ * installed in the internal ROM of the device. Patches to the SI4735 or SI4732 are distributed
  * in binary form and have to be transferred to the internal RAM of the device by the 
  * host MCU (in this case Arduino boards). 
  * Since the RAM is volatile memory, the patch stored into the device gets lost when 
@@ -2559,764 +4261,1714 @@ char *SI4735::getRdsTime()
  * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; pages 3 and 5 
  */
 
+/**  
+ * @ingroup group20 Patch and NBFM support
+ *  
+ * @brief This method can be used to prepare the device to apply NBFM patch
+ *  
+ * @details Call queryLibraryId before call this method. Powerup the device by issuing the POWER_UP 
+ * command with FUNC = 0 (FM Receiver).
+ * 
+ * @see setMaxDelaySetFrequency()
+ * @see MAX_DELAY_AFTER_POWERUP 
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 64 and 215-220 and
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE AMENDMENT FOR SI4735-D60 SSB AND NBFM PATCHES; page 32.
+ */
+void SI4735::patchPowerUpNBFM()
+{
+    const uint8_t arg[] = {
+        0b00110000,           // This is a condition for loading the patch: Set to AM, Enable External Crystal Oscillator; Set patch enable; GPO2 output disabled; CTS interrupt disabled.
+        SI473X_ANALOG_AUDIO}; // This is a condition for loading the patch: Set to Analog Output. You can change this calling setNBFM.
+
+    sendCommand(POWER_UP, sizeof arg, arg);
+    waitMicroseconds(maxDelayAfterPouwerUp * 1000UL);
+}
+
+/**
+ * @ingroup group20 Patch and NBFM support
+ * @brief Loads a given NBFM patch content
+ * @details Configures the Si4735-D60/SI4732-A10 device to work with NBFM. 
+ * 
+ * @param patch_content        point to patch content array 
+ * @param patch_content_size   size of patch content 
+ */
+void SI4735::loadPatchNBFM(const uint8_t *patch_content, const uint16_t patch_content_size)
+{
+    queryLibraryId();
+    patchPowerUpNBFM();
+    waitMicroseconds(50000);
+    downloadPatch(patch_content, patch_content_size);
+    // TODO 
+    waitMicroseconds(25000);
+}
+
 /**
- * @ingroup group17 Patch and SSB support 
+ * @ingroup group20 Patch and NBFM support
+ * 
+ * @brief Set the radio to FM function. 
+ * 
+ * @todo Adjust the power up parameters
+ * 
+ * @details Set the radio to NBFM function. 
+ * 
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; pages 32 and 14 
+ * @see setAM(), setSSB(), setFM()
+ * @see setFrequencyStep()
+ * @see void SI4735::setFrequency(uint16_t freq)
+ */
+void SI4735::setNBFM()
+{
+    // Is it needed to load patch when switch to SSB?
+    // powerDown();
+    // It starts with the same AM parameters.
+    // setPowerUp(1, 1, 0, 1, 1, currentAudioMode);
+    setPowerUp(this->currentInterruptEnable, this->currentInterruptEnable, 0, this->currentClockType, 0, currentAudioMode);
+    radioPowerUp();
+    currentTune = NBFM_TUNE_FREQ; // Force current tune to NBFM commands
+    // ssbPowerUp(); // Not used for regular operation
+    setVolume(volume); // Set to previus configured volume
+    currentSsbStatus = 0;
+    lastMode = NBFM_CURRENT_MODE;
+}
+
+/**
+ * @ingroup group20 Patch and NBFM support
  *  
- * @brief Sets the SSB Beat Frequency Offset (BFO). 
+ * @details Tunes the SSB (LSB or USB) receiver to a frequency between 64 and 108 MHz. 
  * 
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; pages 5 and 23
+ * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; 
+ * @see setAM(), setFM(), setSSB()
+ * @see setFrequencyStep()
+ * @see void SI4735::setFrequency(uint16_t freq)
  * 
- * @param offset 16-bit signed value (unit in Hz). The valid range is -16383 to +16383 Hz. 
+ * @param fromFreq minimum frequency for the band
+ * @param toFreq maximum frequency for the band
+ * @param initialFreq initial frequency 
+ * @param step step used to go to the next channel  
+ 
  */
-void SI4735::setSSBBfo(int offset)
+void SI4735::setNBFM(uint16_t fromFreq, uint16_t toFreq, uint16_t initialFreq, uint16_t step)
 {
+    currentMinimumFrequency = fromFreq;
+    currentMaximumFrequency = toFreq;
+    currentStep = step;
 
-    si47x_property property;
-    si47x_frequency bfo_offset;
+    if (initialFreq < fromFreq || initialFreq > toFreq)
+        initialFreq = fromFreq;
 
-    if (currentTune == FM_TUNE_FREQ) // Only for AM/SSB mode
-        return;
+    setNBFM();
 
-    waitToSend();
+    currentWorkFrequency = initialFreq;
+    setFrequency(currentWorkFrequency);
+}
 
-    property.value = SSB_BFO;
-    bfo_offset.value = offset;
+/** @defgroup group21 Asynchronous (non-blocking) commands */
+
+// Steps of the asynchronous operations
+#define ASYNC_STEP_TUNE 0                 // Sends the tune command
+#define ASYNC_STEP_SEEK 1                 // Sends the seek start command
+#define ASYNC_STEP_STC_START 2            // The tune or seek command is accepted (CTS)
+#define ASYNC_STEP_STC 3                  // Polls STCINT
+#define ASYNC_STEP_STC_DONE 4             // Clears STCINT and gets the tune status
+#define ASYNC_STEP_POWER_DOWN 5           // Sends POWER_DOWN
+#define ASYNC_STEP_POWER_UP 6             // Sends POWER_UP (FM or AM)
+#define ASYNC_STEP_POWER_UP_WAIT 7        // Waits maxDelayAfterPouwerUp
+#define ASYNC_STEP_POWER_UP_DONE 8        // Sets up the new mode
+#define ASYNC_STEP_PATCH_POWER_DOWN 9     // Sends POWER_DOWN before the library ID query
+#define ASYNC_STEP_LIBRARY_ID 10          // Sends POWER_UP (query library ID)
+#define ASYNC_STEP_LIBRARY_ID_RESPONSE 11 // Reads the library ID
+#define ASYNC_STEP_PATCH_POWER_UP 12      // Sends POWER_UP (patch mode)
+#define ASYNC_STEP_PATCH_LINE 13          // Sends the patch lines
+#define ASYNC_STEP_PATCH_CONFIG 14        // Sets up the SSB mode
+#define ASYNC_STEP_DONE 15                // Nothing else to do
+#define ASYNC_STEP_SCAN_CHANNEL 16        // Band scan: clears STCINT, reads the RSQ status and goes to the next channel
+#define ASYNC_STEP_BANDSCOPE_BIN 17       // Bandscope: clears STCINT, reads the RSSI and goes to the next bin (or back to the listened frequency)
+
+#define ASYNC_SCAN_CHANNELS 0 // Band scan and bandscope phase: tuning the channels (bins)
+#define ASYNC_SCAN_RETURN 1   // Band scan and bandscope phase: tuning the frequency used before the scan
+
+#define ASYNC_PATCH_LINES 16 // Max number of patch lines sent by each service() call
+
+/**
+ * @ingroup group21 Asynchronous commands
+ * 
+ * @brief Starts tuning a given frequency and returns immediately.
+ * 
+ * @details The tune is driven by service(). When it is done (STC or maxDelaySetFrequency elapsed), 
+ * @details the result is available by getAsyncResult() and the callback (see setAsyncCallback) is called.
+ * @details Do not call the blocking functions (setFrequency, seekStation, setAM, setFM...) while an asynchronous operation is running.
+ * 
+ * @code
+ *   void loop() {
+ *      if (encoderCount != 0 && !rx.isAsyncBusy()) {
+ *         rx.beginSetFrequency(rx.getCurrentFrequency() + step * encoderCount);
+ *         encoderCount = 0;
+ *      }
+ *      rx.service();
+ *      ...
+ *   }
+ * @endcode
+ * 
+ * @see service, setAsyncCallback, setFrequency
+ * 
+ * @param freq frequency. For example, FM => 10390 = 103.9 MHz; AM => 810 = 810 kHz.
+ * @return true if started; false if another asynchronous operation is running.
+ */
+bool SI4735::beginSetFrequency(uint16_t freq)
+{
+    if (asyncOperation != ASYNC_IDLE)
+        return false;
+
+    asyncOperation = ASYNC_SET_FREQUENCY;
+    asyncStep = ASYNC_STEP_TUNE;
+    asyncFrequency = freq;
+    asyncResult = ASYNC_RESULT_NONE;
+    asyncDelay = 0;
+    return true;
+}
+
+/**
+ * @ingroup group21 Asynchronous commands
+ * 
+ * @brief Starts a seek and returns immediately.
+ * 
+ * @details The seek command is sent once. service() follows the seek by reading the tune status (READFREQ, VALID and BLTF) 
+ * @details and reports each new frequency (see setSeekProgressCallback). When it is done (STC or maxSeekTime elapsed), the current frequency is updated. 
+ * @details If maxSeekTime elapses, the seek is stopped (CANCEL) and its STC is acknowledged before the operation finishes with ASYNC_RESULT_TIMEOUT.
+ * @details Use getCurrentFrequency, getStatusValid and getStatusBandLimit to check the result. Use cancelSeek to stop it.
+ * @details __This function does not work on SSB mode__.
+ * 
+ * @see service, setAsyncCallback, setSeekProgressCallback, cancelSeek, seekStation, setMaxSeekTime
+ * 
+ * @param up_down SEEK_UP or SEEK_DOWN
+ * @param wrap 1 = wraps at the band limit; 0 = halts at the band limit
+ * @return true if started; false if another asynchronous operation is running or SSB mode.
+ */
+bool SI4735::beginSeek(uint8_t up_down, uint8_t wrap)
+{
+    if (asyncOperation != ASYNC_IDLE || lastMode == SSB_CURRENT_MODE)
+        return false;
+
+    asyncOperation = ASYNC_SEEK;
+    asyncStep = ASYNC_STEP_SEEK;
+    asyncCancel = false;
+    asyncParam = (up_down & 1) | ((wrap & 1) << 1);
+    asyncResult = ASYNC_RESULT_NONE;
+    asyncDelay = 0;
+    return true;
+}
+
+/**
+ * @ingroup group21 Asynchronous commands
+ * 
+ * @brief Cancels the running seek (see beginSeek)
+ * 
+ * @details Returns immediately. The next service() call that finds the device ready (CTS) sends the tune status command with 
+ * @details the CANCEL bit. The device stops on the frequency being scanned and sets STC. service() waits for that STC, acknowledges 
+ * @details it and finishes the seek with the result ASYNC_RESULT_CANCELED. So, no STCINT is left for the next wait.
+ * 
+ * @see beginSeek, service, getStatus
+ * 
+ * @return true if a seek was running
+ */
+bool SI4735::cancelSeek()
+{
+    if (asyncOperation != ASYNC_SEEK)
+        return false;
 
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(SET_PROPERTY);
-    Wire.write(0x00);                  // Always 0x00
-    Wire.write(property.raw.byteHigh); // High byte first
-    Wire.write(property.raw.byteLow);  // Low byte after
-    Wire.write(bfo_offset.raw.FREQH);  // Offset freq. high byte first
-    Wire.write(bfo_offset.raw.FREQL);  // Offset freq. low byte first
+    if (asyncStep == ASYNC_STEP_SEEK)
+    {
+        // The seek command was not sent yet
+        asyncFinish(ASYNC_RESULT_CANCELED);
+        return true;
+    }
 
-    Wire.endTransmission();
-    delayMicroseconds(550);
+    // The CANCEL is sent by service() (see ASYNC_STEP_STC)
+    asyncCancel = true;
+    asyncDelay = 0;
+    return true;
 }
 
 /**
- * @ingroup group17 Patch and SSB support
+ * @ingroup group21 Asynchronous commands
  * 
- * @brief Sets the SSB receiver mode.
+ * @brief Starts changing the device mode (FM or AM) and returns immediately.
  * 
- * @details You can use this method for:  
- * @details 1) Enable or disable AFC track to carrier function for receiving normal AM signals;
- * @details 2) Set the audio bandwidth;
- * @details 3) Set the side band cutoff filter;
- * @details 4) Set soft-mute based on RSSI or SNR;
- * @details 5) Enable or disbable automatic volume control (AVC) function. 
+ * @details Does the same of setFM() or setAM(). The power down and power up sequence is driven by service(). 
+ * @details If initialFreq is not 0, the frequency is tuned after the mode change and the operation is done after that. 
+ * @details The band limits and the step are not changed. 
  * 
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
+ * @see service, setAsyncCallback, setAM, setFM
  * 
- * @param AUDIOBW SSB Audio bandwidth; 0 = 1.2kHz (default); 1=2.2kHz; 2=3kHz; 3=4kHz; 4=500Hz; 5=1kHz.
- * @param SBCUTFLT SSB side band cutoff filter for band passand low pass filter
- *                 if 0, the band pass filter to cutoff both the unwanted side band and high frequency 
- *                  component > 2kHz of the wanted side band (default).
- * @param AVC_DIVIDER set 0 for SSB mode; set 3 for SYNC mode.
- * @param AVCEN SSB Automatic Volume Control (AVC) enable; 0=disable; 1=enable (default).
- * @param SMUTESEL SSB Soft-mute Based on RSSI or SNR.
- * @param DSP_AFCDIS DSP AFC Disable or enable; 0=SYNC MODE, AFC enable; 1=SSB MODE, AFC disable. 
+ * @param mode FM_CURRENT_MODE or AM_CURRENT_MODE
+ * @param initialFreq frequency to be tuned after the mode change (0 = none)
+ * @return true if started; false if another asynchronous operation is running or invalid mode.
  */
-void SI4735::setSSBConfig(uint8_t AUDIOBW, uint8_t SBCUTFLT, uint8_t AVC_DIVIDER, uint8_t AVCEN, uint8_t SMUTESEL, uint8_t DSP_AFCDIS)
+bool SI4735::beginModeChange(uint8_t mode, uint16_t initialFreq)
 {
-    if (currentTune == FM_TUNE_FREQ) // Only AM/SSB mode
-        return;
+    if (asyncOperation != ASYNC_IDLE || (mode != FM_CURRENT_MODE && mode != AM_CURRENT_MODE))
+        return false;
 
-    currentSSBMode.param.AUDIOBW = AUDIOBW;
-    currentSSBMode.param.SBCUTFLT = SBCUTFLT;
-    currentSSBMode.param.AVC_DIVIDER = AVC_DIVIDER;
-    currentSSBMode.param.AVCEN = AVCEN;
-    currentSSBMode.param.SMUTESEL = SMUTESEL;
-    currentSSBMode.param.DUMMY1 = 0;
-    currentSSBMode.param.DSP_AFCDIS = DSP_AFCDIS;
+    asyncOperation = ASYNC_MODE_CHANGE;
+    asyncParam = mode;
+    asyncFrequency = initialFreq;
+    asyncResult = ASYNC_RESULT_NONE;
+    asyncDelay = 0;
 
-    sendSSBModeProperty();
+    // If you’re already using AM mode, it is not necessary to call powerDown and radioPowerUp.
+    if (mode == AM_CURRENT_MODE && lastMode == AM_CURRENT_MODE)
+    {
+        currentSsbStatus = 0;
+        asyncStep = (initialFreq != 0) ? ASYNC_STEP_TUNE : ASYNC_STEP_DONE;
+    }
+    else
+        asyncStep = ASYNC_STEP_POWER_DOWN;
+
+    return true;
 }
 
 /**
- * @ingroup group17 Patch and SSB support
+ * @ingroup group21 Asynchronous commands
+ * 
+ * @brief Starts loading a SSB patch and returns immediately.
+ * 
+ * @details Does the same of loadPatch(). The patch lines are sent by service() (up to ASYNC_PATCH_LINES lines per call). 
+ * @details Unlike downloadPatch, CTS is checked after each line.
+ * 
+ * @see service, setAsyncCallback, loadPatch
+ * 
+ * @param ssb_patch_content point to patch content array 
+ * @param ssb_patch_content_size size of patch content
+ * @param ssb_audiobw SSB Audio bandwidth; 0 = 1.2KHz; 1 = 2.2KHz (default); 2 = 3KHz; 3 = 4KHz; 4 = 500Hz; 5 = 1KHz.
+ * @return true if started; false if another asynchronous operation is running.
+ */
+bool SI4735::beginLoadPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size, uint8_t ssb_audiobw)
+{
+    if (asyncOperation != ASYNC_IDLE)
+        return false;
+
+    asyncOperation = ASYNC_LOAD_PATCH;
+    asyncStep = ASYNC_STEP_PATCH_POWER_DOWN;
+    asyncPatch = ssb_patch_content;
+    asyncPatchSize = ssb_patch_content_size;
+    asyncPatchOffset = 0;
+    asyncParam = ssb_audiobw;
+    asyncResult = ASYNC_RESULT_NONE;
+    asyncDelay = 0;
+    return true;
+}
+
+/**
+ * @ingroup group21 Band scan
+ * 
+ * @brief Starts scanning the current band and returns immediately.
+ * 
+ * @details Tunes each channel from the band minimum to the band maximum frequency (see setFM, setAM and setFrequencyStep) 
+ * @details and stores its RSSI, SNR, VALID bit and multipath (FM) in the table (3 bytes per channel; see si4735_scan_channel). 
+ * @details The tunes use the FAST bit (see setTuneFrequencyFast). After STC, only the needed bytes of the RSQ status are read. 
+ * @details The scan is driven by service(), one channel per step. So, the loop keeps running (encoder, display) while the band is scanned.  
+ * @details When the table is full or the band maximum frequency is reached, the frequency used before the scan is tuned again and 
+ * @details the operation is done (ASYNC_RESULT_DONE). Use getBandScanCount and getBandScanFrequency to read the table and cancelBandScan to stop it.
+ * @details If a channel does not complete in maxDelaySetFrequency, the scan stops, the frequency used before it is tuned again and 
+ * @details the operation finishes with ASYNC_RESULT_TIMEOUT (the channels already stored are kept).
+ * @details getCurrentFrequency keeps the frequency used before the scan (or the target of queueFrequency) while the channels are tuned.
+ * @details __This function does not work on SSB mode__.
  * 
- * @brief Sets DSP AFC disable or enable
+ * @code
+ *   si4735_scan_channel table[205]; // 87.5 to 108 MHz; 100 kHz step
+ *   ...
+ *   rx.beginBandScan(table, 205);
+ *   while (rx.service())
+ *      showProgress(rx.getBandScanCount());
+ *   for (uint16_t i = 0; i < rx.getBandScanCount(); i++)
+ *      if (table[i].valid)
+ *         addStation(rx.getBandScanFrequency(i), table[i].rssi);
+ * @endcode
  * 
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
+ * @see service, setAsyncCallback, cancelBandScan, getBandScanCount, getBandScanFrequency
  * 
- * @param DSP_AFCDIS 0 = SYNC mode, AFC enable; 1 = SSB mode, AFC disable
+ * @param table channel quality table
+ * @param size number of channels the table can store
+ * @return true if started; false if another asynchronous operation is running, SSB mode or empty table.
  */
-void SI4735::setSSBDspAfc(uint8_t DSP_AFCDIS)
+bool SI4735::beginBandScan(si4735_scan_channel *table, uint16_t size)
 {
-    currentSSBMode.param.DSP_AFCDIS = DSP_AFCDIS;
-    sendSSBModeProperty();
+    if (asyncOperation != ASYNC_IDLE || lastMode == SSB_CURRENT_MODE || table == NULL || size == 0 || currentStep == 0)
+        return false;
+
+    uint16_t channels = (currentMaximumFrequency - currentMinimumFrequency) / currentStep + 1;
+
+    scanTable = table;
+    scanSize = (size < channels) ? size : channels;
+    scanCount = 0;
+    scanFirst = currentMinimumFrequency;
+    scanStep = currentStep;
+    scanReturn = currentWorkFrequency;
+
+    asyncOperation = ASYNC_BAND_SCAN;
+    asyncStep = ASYNC_STEP_TUNE;
+    asyncCancel = false;
+    asyncParam = ASYNC_SCAN_CHANNELS;
+    asyncFrequency = scanFirst;
+    asyncResult = ASYNC_RESULT_NONE;
+    asyncDelay = 0;
+    return true;
 }
 
 /**
- * @ingroup group17 Patch and SSB support 
+ * @ingroup group21 Band scan
  * 
- * @brief Sets SSB Soft-mute Based on RSSI or SNR Selection: 
+ * @brief Cancels the running band scan (see beginBandScan)
  * 
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
+ * @details The channel being tuned is finished and stored. Then, the frequency used before the scan is tuned again 
+ * @details and the scan is finished with the result ASYNC_RESULT_CANCELED. The channels already stored are kept (see getBandScanCount).
  * 
- * @param SMUTESEL  0 = Soft-mute based on RSSI (default); 1 = Soft-mute based on SNR.
+ * @return true if a band scan was running
  */
-void SI4735::setSSBSoftMute(uint8_t SMUTESEL)
+bool SI4735::cancelBandScan()
 {
-    currentSSBMode.param.SMUTESEL = SMUTESEL;
-    sendSSBModeProperty();
+    if (asyncOperation != ASYNC_BAND_SCAN && asyncOperation != ASYNC_BANDSCOPE)
+        return false;
+
+    asyncCancel = true;
+    if (asyncStep == ASYNC_STEP_TUNE && asyncParam == ASYNC_SCAN_CHANNELS)
+    {
+        // Bandscope between two excursions: the listened frequency is already tuned
+        if (asyncOperation == ASYNC_BANDSCOPE && !scopeAway)
+        {
+            asyncFinish(ASYNC_RESULT_CANCELED);
+            return true;
+        }
+        asyncParam = ASYNC_SCAN_RETURN;
+        asyncFrequency = scanReturn;
+    }
+    return true;
 }
 
 /**
- * @ingroup group17 Patch and SSB support
+ * @ingroup group21 Bandscope
+ * 
+ * @brief Starts a bandscope sweep and returns immediately.
+ * 
+ * @details Measures the RSSI of count bins evenly spread over span, centered on center (the window is kept inside the band limits). 
+ * @details Like the band scan, each bin is tuned with the FAST bit and, after STC, only the RSSI byte of the RSQ status is read. 
+ * @details The sweep is driven by service(). binFunc is called as soon as a bin is measured, if its RSSI changed by threshold dB or more 
+ * @details since the last value delivered. So, the display is redrawn only where the spectrum changed.
+ * @details Call beginBandscope again (same center, span, bins and count) for the next sweep. A bin unchanged for BANDSCOPE_IDLE_SWEEPS
+ * @details sweeps is idle and is measured only once every BANDSCOPE_REFRESH_SWEEPS sweeps. The bus time follows the band activity, not the span.
+ * @details A different window (or bins) restarts all bins and delivers them again.
+ * @details To limit the audio outage, the sweep is split into excursions (see setBandscopeOutage). At the end of each excursion and at the 
+ * @details end of the sweep, the frequency used before the sweep is tuned again. Use cancelBandScan to stop it.
+ * @details If a bin does not complete in maxDelaySetFrequency, the sweep stops, the frequency used before it is tuned again, 
+ * @details the audio is un-muted after that tune and the operation finishes with ASYNC_RESULT_TIMEOUT.
+ * @details getCurrentFrequency keeps the listened frequency during the sweep. So, frequencyUp and frequencyDown (with tune 
+ * @details coalescing) step from it; the new target is tuned when the sweep is done.
+ * @details __This function does not work on SSB mode__.
  * 
- * @brief Sets SSB Automatic Volume Control (AVC) for SSB mode
+ * @code
+ *   si4735_bandscope_bin bins[64];
+ *
+ *   void drawBin(uint8_t bin, uint16_t freq, uint8_t rssi) {
+ *      tft.drawFastVLine(bin * 4, 0, 100, BLACK);
+ *      tft.drawFastVLine(bin * 4, 100 - rssi, rssi, GREEN);
+ *   }
+ *
+ *   void loop() {
+ *      if (!rx.isAsyncBusy())
+ *         rx.beginBandscope(rx.getCurrentFrequency(), 200, bins, 64, drawBin); // +-1 MHz on FM
+ *      rx.service();
+ *      ...
+ *   }
+ * @endcode
  * 
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
+ * @see service, setBandscopeOutage, cancelBandScan, getBandscopeFrequency, beginBandScan
  * 
- * @param AVCEN 0 = Disable AVC; 1 = Enable AVC (default).
+ * @param center center frequency. For example, FM => 10390 = 103.9 MHz; AM => 810 = 810 kHz.
+ * @param span frequency of the last bin minus frequency of the first bin (same unit)
+ * @param bins bins kept between sweeps
+ * @param count number of bins (2 to 255)
+ * @param binFunc function called with each bin refreshed (bin index, frequency and RSSI in dBuV)
+ * @param threshold RSSI change (dB) that refreshes a bin (default BANDSCOPE_THRESHOLD)
+ * @return true if started; false if another asynchronous operation is running, SSB mode or invalid window.
  */
-void SI4735::setSSBAutomaticVolumeControl(uint8_t AVCEN)
+bool SI4735::beginBandscope(uint16_t center, uint16_t span, si4735_bandscope_bin *bins, uint8_t count, void (*binFunc)(uint8_t bin, uint16_t freq, uint8_t rssi), uint8_t threshold)
 {
-    currentSSBMode.param.AVCEN = AVCEN;
-    sendSSBModeProperty();
+    if (asyncOperation != ASYNC_IDLE || lastMode == SSB_CURRENT_MODE || bins == NULL || count < 2)
+        return false;
+
+    if (span > currentMaximumFrequency - currentMinimumFrequency)
+        span = currentMaximumFrequency - currentMinimumFrequency;
+    if (span < count - 1)
+        return false;
+
+    int32_t first = (int32_t)center - span / 2;
+    if (first < currentMinimumFrequency)
+        first = currentMinimumFrequency;
+    if (first + span > currentMaximumFrequency)
+        first = currentMaximumFrequency - span;
+
+    if (bins != scopeBins || count != scopeCount || first != scopeFirst || span != scopeSpan)
+    {
+        // New window: all bins are measured and delivered (0xFF is out of the RSSI range)
+        for (uint8_t i = 0; i < count; i++)
+        {
+            bins[i].rssi = 0xFF;
+            bins[i].idle = 0;
+        }
+        scopeSweep = 0;
+    }
+    else
+        scopeSweep++;
+
+    scopeBins = bins;
+    scopeCount = count;
+    scopeFirst = first;
+    scopeSpan = span;
+    scopeFunc = binFunc;
+    scopeThreshold = threshold;
+    scopeAway = false;
+    scopeNext = nextBandscopeBin(0);
+    scanReturn = currentWorkFrequency;
+
+    asyncOperation = ASYNC_BANDSCOPE;
+    asyncStep = (scopeNext < scopeCount) ? ASYNC_STEP_TUNE : ASYNC_STEP_DONE;
+    asyncCancel = false;
+    asyncParam = ASYNC_SCAN_CHANNELS;
+    asyncFrequency = getBandscopeFrequency(scopeNext);
+    asyncResult = ASYNC_RESULT_NONE;
+    asyncDelay = 0;
+    return true;
 }
 
 /**
- * @ingroup group17 Patch and SSB support
+ * @ingroup group21 Bandscope
+ * @brief Finds the next bin to be measured in this sweep (idle bins are skipped, except on their refresh sweep)
+ * @param bin first candidate
+ * @return uint8_t bin index; scopeCount if there is no bin left
+ */
+uint8_t SI4735::nextBandscopeBin(uint8_t bin)
+{
+    for (; bin < scopeCount; bin++)
+    {
+        if (scopeBins[bin].idle < BANDSCOPE_IDLE_SWEEPS || ((scopeSweep + bin) % BANDSCOPE_REFRESH_SWEEPS) == 0)
+            break;
+    }
+    return bin;
+}
+
+/**
+ * @ingroup group21 Asynchronous commands
  * 
- * @brief Sets AVC Divider
+ * @brief Checks (without waiting) if the device is ready to receive a new command (CTS)
  * 
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24  
+ * @details Does not use the I2C bus before the expected completion time of the last command (or the GPO2/INT edge in interrupt mode).
  * 
- * @param AVC_DIVIDER  SSB mode, set divider = 0; SYNC mode, set divider = 3; Other values = not allowed.
+ * @return true if the device is ready 
  */
-void SI4735::setSSBAvcDivider(uint8_t AVC_DIVIDER)
+bool SI4735::asyncClearToSend()
 {
-    currentSSBMode.param.AVC_DIVIDER = AVC_DIVIDER;
-    sendSSBModeProperty();
+    uint8_t status;
+
+    if (pendingLatencyClass == LATENCY_NONE)
+        return true;
+
+    uint32_t elapsed = micros() - pendingCommandTime;
+
+    if (ctsPending)
+    {
+        if (!interruptFlag && elapsed < maxDelayWaitInterrupt * 1000UL)
+            return false;
+        interruptFlag = false;
+    }
+    else if (elapsed < commandLatency[pendingLatencyClass])
+        return false;
+
+    busRead(deviceAddress, &status, 1);
+    if (!(status & B10000000))
+    {
+        asyncWait(MIN_DELAY_WAIT_LATENCY_LOOP); // Polls again later
+        return false;
+    }
+
+    ctsPending = false;
+    pendingLatencyClass = LATENCY_NONE;
+    return true;
 }
 
-/**  
- * @ingroup group17 Patch and SSB support
- * 
- * @brief Sets SBB Sideband Cutoff Filter for band pass and low pass filters.
- * 
- * @details 0 = Band pass filter to cutoff both the unwanted side band and high frequency components > 2.0 kHz of the wanted side band. (default)
- * @details 1 = Low pass filter to cutoff the unwanted side band. 
- * Other values = not allowed.
- *
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
- *  
- * @param SBCUTFLT 0 or 1; see above
+/**
+ * @ingroup group21 Asynchronous commands
+ * @brief Tells service() to wait a given time before the next step
+ * @param us time in microseconds
  */
-void SI4735::setSBBSidebandCutoffFilter(uint8_t SBCUTFLT)
+void SI4735::asyncWait(uint32_t us)
 {
-    currentSSBMode.param.SBCUTFLT = SBCUTFLT;
-    sendSSBModeProperty();
+    asyncTime = micros();
+    asyncDelay = us;
 }
 
 /**
- * @ingroup group17 Patch and SSB support
- * 
- * @brief SSB Audio Bandwidth for SSB mode
- * 
- * @details 0 = 1.2 kHz low-pass filter  (default).
- * @details 1 = 2.2 kHz low-pass filter.
- * @details 2 = 3.0 kHz low-pass filter.
- * @details 3 = 4.0 kHz low-pass filter.
- * @details 4 = 500 Hz band-pass filter for receiving CW signal, i.e. [250 Hz, 750 Hz] with center 
- * frequency at 500 Hz when USB is selected or [-250 Hz, -750 1Hz] with center frequency at -500Hz 
- * when LSB is selected* .
- * @details 5 = 1 kHz band-pass filter for receiving CW signal, i.e. [500 Hz, 1500 Hz] with center 
- * frequency at 1 kHz when USB is selected or [-500 Hz, -1500 1 Hz] with center frequency 
- *     at -1kHz when LSB is selected.
- * @details Other values = reserved.
- * 
- * @details If audio bandwidth selected is about 2 kHz or below, it is recommended to set SBCUTFLT[3:0] to 0 
- * to enable the band pass filter for better high- cut performance on the wanted side band. Otherwise, set it to 1.
- * 
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; page 24 
- * 
- * @param AUDIOBW the valid values are 0, 1, 2, 3, 4 or 5; see description above
+ * @ingroup group21 Asynchronous commands
+ * @brief Stops the running seek (CANCEL) and starts waiting for the STC it causes (see ASYNC_STEP_STC)
+ * @details The STC is acknowledged by ASYNC_STEP_STC_DONE. The wait is bounded by maxDelaySetFrequency.
  */
-void SI4735::setSSBAudioBandwidth(uint8_t AUDIOBW)
+void SI4735::asyncStopSeek()
 {
-    // Sets the audio filter property parameter
-    currentSSBMode.param.AUDIOBW = AUDIOBW;
-    sendSSBModeProperty();
+    getStatus(0, 1, FIELD_VALID); // CANCEL
+    asyncSeekStopped = true;
+    asyncStcInterrupt = false;
+    asyncStcTime = micros();
+    asyncWait(MIN_DELAY_WAIT_STC_LOOP);
 }
 
 /**
- * @ingroup group17 Patch and SSB support
- * 
- * @brief Set the radio to AM function. 
+ * @ingroup group21 Asynchronous commands
+ * @brief Finishes the current asynchronous operation and calls the callback function
+ * @param result ASYNC_RESULT_DONE or ASYNC_RESULT_TIMEOUT
+ */
+void SI4735::asyncFinish(uint8_t result)
+{
+    uint8_t operation = asyncOperation;
+
+    asyncOperation = ASYNC_IDLE;
+    asyncResult = result;
+    asyncDelay = 0;
+    asyncCancel = false;
+    asyncTimedOut = false;
+    asyncSeekStopped = false;
+
+    // A newer target is waiting (see queueFrequency). The tune just done is not reported.
+    if (pendingFrequency != 0 && operation == ASYNC_SET_FREQUENCY)
+    {
+        beginSetFrequency(pendingFrequency);
+        pendingFrequency = 0;
+        return;
+    }
+
+    // The tune back to the listened frequency timed out: the bandscope stops away from it
+    if (scopeAway)
+    {
+        scopeAway = false;
+        if (audioMuteMcuPin >= 0)
+            setHardwareAudioMute(false);
+    }
+
+    if (asyncCallback != NULL)
+        asyncCallback(operation, result);
+
+    // A target queued while another operation (seek, scan...) was running
+    if (pendingFrequency != 0 && asyncOperation == ASYNC_IDLE)
+    {
+        beginSetFrequency(pendingFrequency);
+        pendingFrequency = 0;
+    }
+}
+
+/**
+ * @ingroup group21 Asynchronous commands
  * 
- * @todo Adjust the power up parameters
+ * @brief Drives the current asynchronous operation. Call it from loop().
  * 
- * @details Set the radio to SSB (LW/MW/SW) function. 
+ * @details Each call does at most one step of the operation and returns. It does not wait for the device. 
+ * @details Some steps send short commands (property writes, status reads) that take less than a few milliseconds.
  * 
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; pages 13 and 14 
- * @see setAM()
- * @see setFrequencyStep()
- * @see void SI4735::setFrequency(uint16_t freq)
+ * @see beginSetFrequency, beginSeek, beginModeChange, beginLoadPatch, setAsyncCallback
  * 
- * @param usblsb upper or lower side band;  1 = LSB; 2 = USB
+ * @return true if an asynchronous operation is still running.
  */
-void SI4735::setSSB(uint8_t usblsb)
+bool SI4735::service()
 {
-    // Is it needed to load patch when switch to SSB?
-    // powerDown();
-    // It starts with the same AM parameters.
-    // setPowerUp(1, 1, 0, 1, 1, currentAudioMode);
-    setPowerUp(this->currentInterruptEnable, 0, 0, this->currentClockType, 1, currentAudioMode);
-    radioPowerUp();
-    // ssbPowerUp(); // Not used for regular operation
-    setVolume(volume); // Set to previus configured volume
-    currentSsbStatus = usblsb;
-    lastMode = SSB_CURRENT_MODE;
+    si47x_frequency freq;
+    uint32_t elapsed, limit;
+    bool stc;
+
+    if (asyncOperation == ASYNC_IDLE)
+        return false;
+
+    if (asyncDelay != 0)
+    {
+        if ((micros() - asyncTime) < asyncDelay)
+            return true;
+        asyncDelay = 0;
+    }
+
+    if (!asyncClearToSend())
+        return true;
+
+    switch (asyncStep)
+    {
+    case ASYNC_STEP_TUNE:
+        if ((asyncOperation == ASYNC_BAND_SCAN || asyncOperation == ASYNC_BANDSCOPE) && asyncParam == ASYNC_SCAN_CHANNELS)
+        {
+            if (asyncOperation == ASYNC_BANDSCOPE && !scopeAway)
+            {
+                // A bandscope excursion starts
+                scopeAway = true;
+                scopeExcursion = micros();
+                if (audioMuteMcuPin >= 0)
+                    setHardwareAudioMute(true);
+            }
+            // The channels are tuned with the FAST bit. The user setting is kept for the other tunes.
+            uint8_t fast = currentFrequencyParams.arg.FAST;
+            currentFrequencyParams.arg.FAST = 1;
+            startTune(asyncFrequency);
+            currentFrequencyParams.arg.FAST = fast;
+        }
+        else
+            startTune(asyncFrequency);
+        asyncStep = ASYNC_STEP_STC_START;
+        break;
+    case ASYNC_STEP_SEEK:
+        startSeek(asyncParam & 1, asyncParam >> 1);
+        asyncStep = ASYNC_STEP_STC_START;
+        break;
+    case ASYNC_STEP_STC_START:
+        // The current frequency is the listened one: not a scan channel or bandscope bin, and not over a knob target (pendingFrequency)
+        if (asyncOperation != ASYNC_SEEK && pendingFrequency == 0 &&
+            !((asyncOperation == ASYNC_BAND_SCAN || asyncOperation == ASYNC_BANDSCOPE) && asyncParam == ASYNC_SCAN_CHANNELS))
+            currentWorkFrequency = asyncFrequency;
+        asyncStcTime = micros();
+        // With the STC interrupt (and no seek progress to show), the device tells when it is done
+        asyncStcInterrupt = (waitMode == WAIT_MODE_INTERRUPT && ctsInterruptArmed && (asyncOperation != ASYNC_SEEK || seekProgressFunc == NULL));
+        if (!asyncStcInterrupt)
+            asyncWait(commandLatency[(currentTune == FM_TUNE_FREQ) ? LATENCY_FM_STC : LATENCY_AM_STC]);
+        asyncStep = ASYNC_STEP_STC;
+        break;
+    case ASYNC_STEP_STC:
+        if (asyncOperation == ASYNC_SEEK && asyncCancel && !asyncSeekStopped)
+        {
+            // cancelSeek: the device is ready (CTS). The seek is stopped and its STC is waited like after maxSeekTime.
+            asyncStopSeek();
+            break;
+        }
+        elapsed = micros() - asyncStcTime;
+        limit = (asyncOperation == ASYNC_SEEK && !asyncSeekStopped) ? maxSeekTime * 1000UL : maxDelaySetFrequency * 1000UL;
+        if (asyncStcInterrupt)
+        {
+            // No I2C traffic until the GPO2/INT edge
+            if (!interruptFlag && elapsed < limit)
+            {
+                asyncWait(MIN_DELAY_WAIT_INTERRUPT_LOOP);
+                break;
+            }
+            interruptFlag = false;
+        }
+        if (asyncOperation == ASYNC_SEEK)
+        {
+            // Seek progress: STCINT, VALID, BLTF and READFREQ in one short read
+            getStatus(0, 0, FIELD_VALID | FIELD_FREQUENCY);
+            stc = currentStatus.resp.STCINT;
+            freq.raw.FREQH = currentStatus.resp.READFREQH;
+            freq.raw.FREQL = currentStatus.resp.READFREQL;
+            // Once the knob has a target (see queueFrequency), the seek position is not the current frequency anymore
+            if (!stc && pendingFrequency == 0 && freq.value != currentWorkFrequency)
+            {
+                currentWorkFrequency = freq.value;
+                if (seekProgressFunc != NULL)
+                    seekProgressFunc(freq.value);
+            }
+        }
+        else
+            stc = getInterruptStatus().refined.STCINT;
+        if (stc)
+            asyncStep = ASYNC_STEP_STC_DONE;
+        else if (elapsed >= limit && asyncOperation == ASYNC_SEEK && !asyncSeekStopped)
+        {
+            // maxSeekTime elapsed: the device is still seeking. It is stopped (CANCEL) and its STC is waited and acknowledged
+            // (see ASYNC_STEP_STC_DONE). So, the next command does not race the seek and no stale STCINT is left.
+            asyncTimedOut = true;
+            asyncStopSeek();
+        }
+        else if (elapsed >= limit && (asyncOperation == ASYNC_BAND_SCAN || asyncOperation == ASYNC_BANDSCOPE) && asyncParam == ASYNC_SCAN_CHANNELS)
+        {
+            // A channel (or bin) did not complete: the scan stops and the frequency used before it is tuned again.
+            // The operation finishes with ASYNC_RESULT_TIMEOUT after that tune (see ASYNC_STEP_STC_DONE and ASYNC_STEP_BANDSCOPE_BIN).
+            getStatus(1, 0, FIELD_VALID); // Acknowledges a STCINT set after the last poll
+            asyncTimedOut = true;
+            asyncParam = ASYNC_SCAN_RETURN;
+            asyncFrequency = scanReturn;
+            asyncStep = ASYNC_STEP_TUNE;
+        }
+        else if (elapsed >= limit)
+        {
+            getStatus(1, 0, FIELD_VALID); // Acknowledges a STCINT set after the last poll
+            asyncFinish(ASYNC_RESULT_TIMEOUT);
+        }
+        else // The poll interval grows with the elapsed time
+            asyncWait(constrain(elapsed >> 2, MIN_DELAY_WAIT_STC_LOOP, MAX_DELAY_WAIT_STC_LOOP));
+        break;
+    case ASYNC_STEP_STC_DONE:
+        if (asyncOperation == ASYNC_BAND_SCAN && asyncParam == ASYNC_SCAN_CHANNELS)
+        {
+            asyncStep = ASYNC_STEP_SCAN_CHANNEL;
+            break;
+        }
+        if (asyncOperation == ASYNC_BANDSCOPE)
+        {
+            asyncStep = ASYNC_STEP_BANDSCOPE_BIN;
+            break;
+        }
+        getStatus(1, 0); // Clears STCINT
+        if (asyncOperation == ASYNC_SEEK && pendingFrequency == 0)
+        {
+            freq.raw.FREQH = currentStatus.resp.READFREQH;
+            freq.raw.FREQL = currentStatus.resp.READFREQL;
+            currentWorkFrequency = freq.value;
+        }
+        asyncFinish(asyncTimedOut ? ASYNC_RESULT_TIMEOUT : (asyncCancel ? ASYNC_RESULT_CANCELED : ASYNC_RESULT_DONE));
+        break;
+    case ASYNC_STEP_SCAN_CHANNEL:
+    {
+        si4735_scan_channel *channel = &scanTable[scanCount];
+        getStatus(1, 0, FIELD_VALID); // Clears STCINT (2 bytes read)
+        getCurrentReceivedSignalQuality(0, FIELD_VALID | FIELD_RSSI | FIELD_SNR | ((currentTune == FM_TUNE_FREQ) ? FIELD_MULT : 0));
+        channel->rssi = currentRqsStatus.resp.RSSI;
+        channel->valid = currentRqsStatus.resp.VALID;
+        channel->snr = currentRqsStatus.resp.SNR;
+        channel->mult = (currentTune == FM_TUNE_FREQ) ? currentRqsStatus.resp.MULT : 0;
+        scanCount++;
+        if (scanCount >= scanSize || asyncCancel)
+        {
+            asyncParam = ASYNC_SCAN_RETURN;
+            asyncFrequency = scanReturn;
+        }
+        else
+            asyncFrequency += scanStep;
+        asyncStep = ASYNC_STEP_TUNE;
+        break;
+    }
+    case ASYNC_STEP_BANDSCOPE_BIN:
+    {
+        si4735_bandscope_bin *bin = &scopeBins[scopeNext];
+        uint8_t rssi;
+
+        getStatus(1, 0, FIELD_VALID); // Clears STCINT (2 bytes read)
+        if (asyncParam == ASYNC_SCAN_RETURN)
+        {
+            // Back on the listened frequency
+            scopeAway = false;
+            if (audioMuteMcuPin >= 0)
+                setHardwareAudioMute(false);
+            if (scopeNext >= scopeCount || asyncCancel || asyncTimedOut)
+                asyncFinish(asyncTimedOut ? ASYNC_RESULT_TIMEOUT : (asyncCancel ? ASYNC_RESULT_CANCELED : ASYNC_RESULT_DONE));
+            else
+            {
+                asyncWait(scopeListenTime * 1000UL);
+                asyncParam = ASYNC_SCAN_CHANNELS;
+                asyncFrequency = getBandscopeFrequency(scopeNext);
+                asyncStep = ASYNC_STEP_TUNE;
+            }
+            break;
+        }
+        getCurrentReceivedSignalQuality(0, FIELD_RSSI);
+        rssi = currentRqsStatus.resp.RSSI;
+        if (((rssi > bin->rssi) ? rssi - bin->rssi : bin->rssi - rssi) >= scopeThreshold)
+        {
+            bin->rssi = rssi;
+            bin->idle = 0;
+            if (scopeFunc != NULL)
+                scopeFunc(scopeNext, getBandscopeFrequency(scopeNext), rssi);
+        }
+        else if (bin->idle < 0xFF)
+            bin->idle++;
+        scopeNext = nextBandscopeBin(scopeNext + 1);
+        if (scopeNext >= scopeCount || asyncCancel || (scopeMaxOutage != 0 && (micros() - scopeExcursion) >= scopeMaxOutage * 1000UL))
+        {
+            asyncParam = ASYNC_SCAN_RETURN;
+            asyncFrequency = scanReturn;
+        }
+        else
+            asyncFrequency = getBandscopeFrequency(scopeNext);
+        asyncStep = ASYNC_STEP_TUNE;
+        break;
+    }
+    case ASYNC_STEP_POWER_DOWN:
+    case ASYNC_STEP_PATCH_POWER_DOWN:
+        // Turns the external mute circuit on
+        if (audioMuteMcuPin >= 0)
+            setHardwareAudioMute(true);
+        sendCommand(POWER_DOWN, 0, NULL);
+        asyncWait(2500);
+        asyncStep = (asyncStep == ASYNC_STEP_POWER_DOWN) ? ASYNC_STEP_POWER_UP : ASYNC_STEP_LIBRARY_ID;
+        break;
+    case ASYNC_STEP_POWER_UP:
+        setPowerUp(this->currentInterruptEnable, this->currentInterruptEnable, 0, this->currentClockType, asyncParam, currentAudioMode);
+        sendCommand(POWER_UP, 2, powerUp.raw); // ARG1 and ARG2
+        asyncStep = ASYNC_STEP_POWER_UP_WAIT;
+        break;
+    case ASYNC_STEP_POWER_UP_WAIT:
+        asyncWait(maxDelayAfterPouwerUp * 1000UL);
+        asyncStep = ASYNC_STEP_POWER_UP_DONE;
+        break;
+    case ASYNC_STEP_POWER_UP_DONE:
+        completePowerUp();
+        if (asyncParam == AM_CURRENT_MODE)
+            setAvcAmMaxGain(currentAvcAmMaxGain);
+        setVolume(volume); // Set to previus configured volume
+        currentSsbStatus = 0;
+        if (asyncParam == FM_CURRENT_MODE)
+            disableFmDebug();
+        lastMode = asyncParam;
+        asyncStep = (asyncFrequency != 0) ? ASYNC_STEP_TUNE : ASYNC_STEP_DONE;
+        break;
+    case ASYNC_STEP_LIBRARY_ID:
+    {
+        const uint8_t arg[] = {0b00011111, SI473X_ANALOG_AUDIO}; // See queryLibraryId
+        sendCommand(POWER_UP, sizeof arg, arg);
+        asyncStep = ASYNC_STEP_LIBRARY_ID_RESPONSE;
+        break;
+    }
+    case ASYNC_STEP_LIBRARY_ID_RESPONSE:
+    {
+        si47x_firmware_query_library libraryID;
+        getCommandResponse(8, libraryID.raw);
+        if (libraryID.resp.ERR) // If error found, try it again.
+        {
+            statsErrRetry();
+            asyncWait(MIN_DELAY_WAIT_LATENCY_LOOP);
+        }
+        else
+        {
+            asyncWait(2500);
+            asyncStep = ASYNC_STEP_PATCH_POWER_UP;
+        }
+        break;
+    }
+    case ASYNC_STEP_PATCH_POWER_UP:
+    {
+        const uint8_t arg[] = {0b00110001, SI473X_ANALOG_AUDIO}; // See patchPowerUp
+        sendCommand(POWER_UP, sizeof arg, arg);
+        asyncWait(maxDelayAfterPouwerUp * 1000UL + 50000UL);
+        asyncStep = ASYNC_STEP_PATCH_LINE;
+        break;
+    }
+    case ASYNC_STEP_PATCH_LINE:
+    {
+        uint8_t content[8];
+        for (uint8_t n = 0; n < ASYNC_PATCH_LINES && asyncPatchOffset < asyncPatchSize; n++, asyncPatchOffset += 8)
+        {
+            waitToSend();
+            for (uint8_t i = 0; i < 8; i++)
+                content[i] = pgm_read_byte_near(asyncPatch + (i + asyncPatchOffset));
+            busWrite(deviceAddress, content, 8);
+            statsCommand(content[0]);
+            setCommandPending(LATENCY_PATCH);
+        }
+        if (asyncPatchOffset >= asyncPatchSize)
+        {
+            asyncWait(250);
+            asyncStep = ASYNC_STEP_PATCH_CONFIG;
+        }
+        break;
+    }
+    case ASYNC_STEP_PATCH_CONFIG:
+        setSSBConfig(asyncParam, 1, 0, 0, 0, 1); // See loadPatch
+        asyncWait(25000);
+        asyncStep = ASYNC_STEP_DONE;
+        break;
+    default: // ASYNC_STEP_DONE
+        asyncFinish(ASYNC_RESULT_DONE);
+    }
+
+    return asyncOperation != ASYNC_IDLE;
 }
 
+#ifdef SI4735_RADIO_SERVICE
+
+/** @defgroup group22 Radio service (thread-safe access for RTOS targets) */
+
 /**
- * @ingroup group17 Patch and SSB support
- *  
- * @details Tunes the SSB (LSB or USB) receiver to a frequency between 520 and 30 MHz in 1 kHz steps. 
- * 
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; pages 13 and 14
- * @see setAM()
- * @see setFrequencyStep()
- * @see void SI4735::setFrequency(uint16_t freq)
- * 
- * @param fromFreq minimum frequency for the band
- * @param toFreq maximum frequency for the band
- * @param initialFreq initial frequency 
- * @param step step used to go to the next channel  
- * @param usblsb SSB Upper Side Band (USB) and Lower Side Band (LSB) Selection; 
- *               value 2 (banary 10) = USB; 
- *               value 1 (banary 01) = LSB.   
+ * @ingroup group22 Radio service
+ *
+ * @brief Waits for the worker to execute the request
+ *
+ * @details Sleeps 1 ms between checks (delay). On ESP32 (FreeRTOS), delay gives the CPU to the other tasks.
+ * @details On timeout, the request is withdrawn from the queue (see SI4735RadioService::cancel). If the worker is already 
+ * @details executing it, wait waits for the end of the command. So, after wait returns, the worker does not use the request 
+ * @details anymore and it can be destroyed (for example, when it is a local variable).
+ *
+ * @param timeout max time in ms (0 = no limit)
+ * @return true if the request was executed; false if it was rejected or withdrawn on timeout
+ */
+bool SI4735RadioRequest::wait(uint32_t timeout)
+{
+    uint32_t start = millis();
+
+    while (state.load(std::memory_order_acquire) == RADIO_REQUEST_QUEUED)
+    {
+        if (timeout != 0 && (millis() - start) >= timeout)
+        {
+            if (service != NULL)
+                service->cancel(this);
+            return isDone();
+        }
+        delay(1);
+    }
+    return isDone();
+}
+
+/**
+ * @ingroup group22 Radio service
+ *
+ * @brief Construct a new SI4735RadioService
+ *
+ * @param rx the SI4735 instance owned by the worker. Only the worker (the task that calls run) may use it after this point.
+ */
+SI4735RadioService::SI4735RadioService(SI4735 *rx)
+{
+    this->rx = rx;
+    for (uint32_t i = 0; i < RADIO_QUEUE_SIZE; i++)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+        slots[i].request.store(NULL, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @ingroup group22 Radio service
+ *
+ * @brief Queues a request. It can be called from any task.
+ *
+ * @details The queue is a bounded lock-free queue (multiple producers, one consumer). It never blocks. 
+ * @details If the queue is full, the request state is set to RADIO_REQUEST_REJECTED and false is returned.
+ * @details The request must not be changed or destroyed until it is done.
+ *
+ * @param req request with the command and arguments already set
+ * @return true if queued
  */
-void SI4735::setSSB(uint16_t fromFreq, uint16_t toFreq, uint16_t initialFreq, uint16_t step, uint8_t usblsb)
+bool SI4735RadioService::submit(SI4735RadioRequest *req)
 {
-    currentMinimumFrequency = fromFreq;
-    currentMaximumFrequency = toFreq;
-    currentStep = step;
+    uint32_t pos = head.load(std::memory_order_relaxed);
+    Slot *slot;
 
-    if (initialFreq < fromFreq || initialFreq > toFreq)
-        initialFreq = fromFreq;
-
-    setSSB(usblsb);
+    req->service = this;
+    req->state.store(RADIO_REQUEST_QUEUED, std::memory_order_relaxed);
+    for (;;)
+    {
+        slot = &slots[pos & (RADIO_QUEUE_SIZE - 1)];
+        int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) - pos);
+        if (diff == 0)
+        {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // The worker did not free this slot yet. The queue is full.
+            req->state.store(RADIO_REQUEST_REJECTED, std::memory_order_release);
+            return false;
+        }
+        else
+            pos = head.load(std::memory_order_relaxed);
+    }
 
-    currentWorkFrequency = initialFreq;
-    setFrequency(currentWorkFrequency);
-    // delayMicroseconds(550);
+    slot->request.store(req, std::memory_order_relaxed);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
 }
 
-/**  
- * @ingroup group17 Patch and SSB support
- * 
- * @brief Just send the property SSB_MOD to the device.  Internal use (privete method). 
+/**
+ * @ingroup group22 Radio service
+ *
+ * @brief Withdraws a queued request. It can be called from any task (not from the worker callbacks).
+ *
+ * @details The worker takes a request from its slot with an atomic exchange, and cancel removes it with a compare and swap 
+ * @details on the same slot. Only one of them gets the request. If cancel gets it, the state is set to RADIO_REQUEST_CANCELED and 
+ * @details the worker never touches it. If the worker got it first, cancel waits until the command is done.
+ * @details Either way, when cancel returns, the worker does not use the request anymore and it can be destroyed.
+ *
+ * @param req request submitted to this service
+ * @return true if the request was withdrawn before execution; false if it was executed (or was not queued)
  */
-void SI4735::sendSSBModeProperty()
+bool SI4735RadioService::cancel(SI4735RadioRequest *req)
 {
-    si47x_property property;
-    property.value = SSB_MODE;
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(SET_PROPERTY);
-    Wire.write(0x00);                  // Always 0x00
-    Wire.write(property.raw.byteHigh); // High byte first
-    Wire.write(property.raw.byteLow);  // Low byte after
-    Wire.write(currentSSBMode.raw[1]); // SSB MODE params; freq. high byte first
-    Wire.write(currentSSBMode.raw[0]); // SSB MODE params; freq. low byte after
+    for (uint32_t i = 0; i < RADIO_QUEUE_SIZE; i++)
+    {
+        SI4735RadioRequest *expected = req;
+        if (slots[i].request.compare_exchange_strong(expected, NULL, std::memory_order_acq_rel))
+        {
+            req->state.store(RADIO_REQUEST_CANCELED, std::memory_order_release);
+            return true;
+        }
+    }
 
-    Wire.endTransmission();
-    delayMicroseconds(550);
+    // Not in the queue: the worker is executing it (or it is already done)
+    while (req->state.load(std::memory_order_acquire) == RADIO_REQUEST_QUEUED)
+        delay(1);
+    return false;
 }
 
 /**
- * @ingroup group17 AGC 
- * 
- * @brief Queries SSB Automatic Gain Control STATUS
- * @details After call this method, you can call isAgcEnabled to know the AGC status and getAgcGainIndex to know the gain index value.
- * 
- * @see AN332 REV 0.8 Universal Programming Guide Amendment for SI4735-D60 SSB and NBFM patches; page 18. 
- * 
+ * @ingroup group22 Radio service
+ *
+ * @brief Sets the command of a request and queues it
+ *
+ * @see submit
+ *
+ * @param req request (owned by the caller)
+ * @param command RADIO_CMD_SET_FREQUENCY, RADIO_CMD_SEEK, RADIO_CMD_GET_RSQ, ...
+ * @param arg command argument (frequency, volume or seek direction)
+ * @param callback function called by the worker after the command (NULL = none)
+ * @return true if queued
  */
-void SI4735::getSsbAgcStatus()
+bool SI4735RadioService::submit(SI4735RadioRequest *req, uint8_t command, uint16_t arg, void (*callback)(SI4735RadioRequest *req))
 {
-    waitToSend();
-
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(SSB_AGC_STATUS);
-    Wire.endTransmission();
-    do
-    {
-        waitToSend();
-        Wire.requestFrom(deviceAddress, 3);
-        currentAgcStatus.raw[0] = Wire.read(); // STATUS response
-        currentAgcStatus.raw[1] = Wire.read(); // RESP 1
-        currentAgcStatus.raw[2] = Wire.read(); // RESP 2
-    } while (currentAgcStatus.refined.ERR);    // If error, try get AGC status again.
+    req->command = command;
+    req->arg = arg;
+    req->callback = callback;
+    return submit(req);
 }
 
-/** 
- * @ingroup group17  
- * 
- * @brief Automatic Gain Control setup 
- * @details Overrides the SSB AGC setting by disabling the AGC and forcing the gain index that ranges between 0 (minimum attenuation) and 37+ATTN_BACKUP (maximum attenuation). 
- * 
- * @param uint8_t SSBAGCDIS This param selects whether the AGC is enabled or disabled (0 = AGC enabled; 1 = AGC disabled);
- * @param uint8_t SSBAGCNDX If 1, this byte forces the AGC gain index. if 0,  Minimum attenuation (max gain)
- *                
+/**
+ * @ingroup group22 Radio service
+ *
+ * @brief Executes a request. Only the worker calls it.
+ *
+ * @param req request
  */
-void SI4735::setSsbAgcOverrite(uint8_t SSBAGCDIS, uint8_t SSBAGCNDX)
+void SI4735RadioService::execute(SI4735RadioRequest *req)
 {
-    si47x_agc_overrride agc;
+    switch (req->command)
+    {
+    case RADIO_CMD_SET_FREQUENCY:
+        rx->setFrequency(req->arg);
+        break;
+    case RADIO_CMD_FREQUENCY_UP:
+        rx->frequencyUp();
+        break;
+    case RADIO_CMD_FREQUENCY_DOWN:
+        rx->frequencyDown();
+        break;
+    case RADIO_CMD_SEEK:
+        rx->seekStationProgress(NULL, (uint8_t)req->arg);
+        break;
+    case RADIO_CMD_SET_VOLUME:
+        rx->setVolume((uint8_t)req->arg);
+        break;
+    case RADIO_CMD_SET_FM:
+        rx->setFM();
+        break;
+    case RADIO_CMD_SET_AM:
+        rx->setAM();
+        break;
+    case RADIO_CMD_GET_FREQUENCY:
+        rx->getFrequency();
+        break;
+    case RADIO_CMD_GET_RSQ:
+        rx->getCurrentReceivedSignalQuality();
+        req->rssi = rx->getCurrentRSSI();
+        req->snr = rx->getCurrentSNR();
+        break;
+    case RADIO_CMD_CALL:
+        if (req->function != NULL)
+            req->function(rx, req);
+        break;
+    }
 
-    agc.arg.AGCDIS = SSBAGCDIS;
-    agc.arg.AGCIDX = SSBAGCNDX;
+    req->frequency = rx->getCurrentFrequency();
+    req->currentVolume = rx->getVolume();
 
-    waitToSend();
+    // The callback runs before the request is marked as done. After that, the owner can reuse or destroy it.
+    if (req->callback != NULL)
+        req->callback(req);
+    req->state.store(RADIO_REQUEST_DONE, std::memory_order_release);
+}
+
+/**
+ * @ingroup group22 Radio service
+ *
+ * @brief Worker step. Executes the queued requests and drives the asynchronous commands.
+ *
+ * @details Call it in the loop of the task that owns the SI4735 instance. 
+ * @details At most RADIO_QUEUE_SIZE requests are executed per call, so requests queued while running do not starve the asynchronous commands.
+ *
+ * @see SI4735::service
+ * @return true if something was done or an asynchronous operation is still running (call it again soon)
+ */
+bool SI4735RadioService::run()
+{
+    bool busy = false;
 
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(SSB_AGC_OVERRIDE);
-    Wire.write(agc.raw[0]);
-    Wire.write(agc.raw[1]);
-    Wire.endTransmission();
+    for (uint8_t n = 0; n < RADIO_QUEUE_SIZE; n++)
+    {
+        Slot *slot = &slots[tail & (RADIO_QUEUE_SIZE - 1)];
+        if ((int32_t)(slot->sequence.load(std::memory_order_acquire) - (tail + 1)) < 0)
+            break; // Empty
+        // The exchange takes the request. NULL means it was withdrawn by cancel (its owner may have destroyed it).
+        SI4735RadioRequest *req = slot->request.exchange(NULL, std::memory_order_acq_rel);
+        slot->sequence.store(tail + RADIO_QUEUE_SIZE, std::memory_order_release);
+        tail++;
+        if (req != NULL)
+            execute(req);
+        busy = true;
+    }
 
-    waitToSend();
+    return rx->service() || busy;
 }
 
+#endif
 
+/** @defgroup group23 Station database */
 
-/***************************************************************************************
- * SI47XX PATCH RESOURCES
- **************************************************************************************/
+/**
+ * @ingroup group23 Station database
+ * @brief Sort key of a station: the mode and then the frequency
+ */
+static inline uint32_t stationKey(uint8_t mode, uint16_t frequency)
+{
+    return ((uint32_t)mode << 16) | frequency;
+}
 
-/** 
- * @ingroup group17 Patch and SSB support
- * 
- * @brief Query the library information of the Si47XX device 
- * 
- * @details Used to confirm if the patch is compatible with the internal device library revision.
- * 
- * @details You have to call this function if you are applying a patch on SI47XX (SI4735-D60/SI4732-A10).
- * @details The first command that is sent to the device is the POWER_UP command to confirm 
- * that the patch is compatible with the internal device library revision. 
- * @details The device moves into the powerup mode, returns the reply, and moves into the 
- * powerdown mode. 
- * @details The POWER_UP command is sent to the device again to configure 
- * the mode of the device and additionally is used to start the patching process.
- * @details When applying the patch, the PATCH bit in ARG1 of the POWER_UP command must be 
- * set to 1 to begin the patching process. [AN332 (REV 1.0) page 219].
- * 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 64 and 215-220.
- * @see struct si47x_firmware_query_library
+/**
+ * @ingroup group23 Station database
  *
- * @return a struct si47x_firmware_query_library (see it in SI4735.h)
-*/
-si47x_firmware_query_library SI4735::queryLibraryId()
+ * @brief Construct a new SI4735StationDb
+ *
+ * @param buffer array that keeps the stations (20 bytes each). It must exist while the database is used.
+ * @param capacity number of elements of buffer
+ */
+SI4735StationDb::SI4735StationDb(si4735_station *buffer, uint16_t capacity)
 {
-    si47x_firmware_query_library libraryID;
+    this->stations = buffer;
+    this->capacity = capacity;
+}
 
-    powerDown(); // Is it necessary
+/**
+ * @ingroup group23 Station database
+ * @brief Binary search
+ * @return uint16_t position of the first station with a key equal to or greater than mode and frequency (count if none)
+ */
+uint16_t SI4735StationDb::search(uint8_t mode, uint16_t frequency)
+{
+    uint32_t key = stationKey(mode, frequency);
+    uint16_t low = 0, high = count;
 
-    // delay(500);
+    while (low < high)
+    {
+        uint16_t middle = low + (high - low) / 2;
+        if (stationKey(stations[middle].mode, stations[middle].frequency) < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
 
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(POWER_UP);
-    Wire.write(0b00011111);          // Set to Read Library ID, disable interrupt; disable GPO2OEN; boot normaly; enable External Crystal Oscillator  .
-    Wire.write(SI473X_ANALOG_AUDIO); // Set to Analog Line Input.
-    Wire.endTransmission();
+/**
+ * @ingroup group23 Station database
+ * @brief Removes the station at a given position
+ */
+void SI4735StationDb::removeAt(uint16_t index)
+{
+    count--;
+    memmove(&stations[index], &stations[index + 1], (count - index) * sizeof(si4735_station));
+    changed = true;
+}
 
-    do
+/**
+ * @ingroup group23 Station database
+ * @brief Fletcher-16 checksum (detects a partial or corrupted image in the EEPROM)
+ */
+uint16_t SI4735StationDb::checksum(const uint8_t *data, uint16_t size)
+{
+    uint16_t sum1 = 0, sum2 = 0;
+
+    for (uint16_t i = 0; i < size; i++)
     {
-        waitToSend();
-        Wire.requestFrom(deviceAddress, 8);
-        for (int i = 0; i < 8; i++)
-            libraryID.raw[i] = Wire.read();
-    } while (libraryID.resp.ERR); // If error found, try it again.
+        sum1 = (sum1 + data[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return (sum2 << 8) | sum1;
+}
 
-    delayMicroseconds(2500);
+/**
+ * @ingroup group23 Station database
+ *
+ * @brief Finds a station
+ *
+ * @param mode FM_CURRENT_MODE, AM_CURRENT_MODE or SSB_CURRENT_MODE
+ * @param frequency station frequency
+ * @return si4735_station* the station or NULL if it is not in the database
+ */
+si4735_station *SI4735StationDb::find(uint8_t mode, uint16_t frequency)
+{
+    uint16_t i = search(mode, frequency);
 
-    return libraryID;
+    if (i < count && stations[i].mode == mode && stations[i].frequency == frequency)
+        return &stations[i];
+    return NULL;
 }
 
-/**  
- * @ingroup group17 Patch and SSB support
- *  
- * @brief This method can be used to prepare the device to apply SSBRX patch
- *  
- * @details Call queryLibraryId before call this method. Powerup the device by issuing the POWER_UP 
- * command with FUNC = 1 (AM/SW/LW Receive).
- * 
- * @see setMaxDelaySetFrequency()
- * @see MAX_DELAY_AFTER_POWERUP 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 64 and 215-220 and
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE AMENDMENT FOR SI4735-D60 SSB AND NBFM PATCHES; page 7.
+/**
+ * @ingroup group23 Station database
+ *
+ * @brief Finds the station closest to a frequency
+ * @details On a tie, the lower frequency is returned.
+ *
+ * @param mode FM_CURRENT_MODE, AM_CURRENT_MODE or SSB_CURRENT_MODE
+ * @param frequency any frequency
+ * @return si4735_station* the closest station of the mode or NULL if there is no station of the mode
  */
-void SI4735::patchPowerUp()
+si4735_station *SI4735StationDb::nearest(uint8_t mode, uint16_t frequency)
 {
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(POWER_UP);
-    Wire.write(0b00110001);          // This is a condition for loading the patch: Set to AM, Enable External Crystal Oscillator; Set patch enable; GPO2 output disabled; CTS interrupt disabled. You can change this calling setSSB.
-    Wire.write(SI473X_ANALOG_AUDIO); // This is a condition for loading the patch: Set to Analog Output. You can change this calling setSSB.
-    Wire.endTransmission();
-    delay(maxDelayAfterPouwerUp);
+    uint16_t i = search(mode, frequency);
+    si4735_station *above = (i < count && stations[i].mode == mode) ? &stations[i] : NULL;
+    si4735_station *below = (i > 0 && stations[i - 1].mode == mode) ? &stations[i - 1] : NULL;
+
+    if (above == NULL)
+        return below;
+    if (below == NULL)
+        return above;
+    return (above->frequency - frequency < frequency - below->frequency) ? above : below;
 }
 
 /**
- * @ingroup group17 Patch and SSB support
- * 
- * @brief This function can be useful for debug and test. 
+ * @ingroup group23 Station database
+ *
+ * @brief Finds the next station above or below a frequency (a seek without tuning the receiver)
+ * @details Wraps around at the ends of the mode.
+ *
+ * @param mode FM_CURRENT_MODE, AM_CURRENT_MODE or SSB_CURRENT_MODE
+ * @param frequency current frequency
+ * @param up_down SEEK_UP or SEEK_DOWN
+ * @return si4735_station* the next station or NULL if there is no station of the mode
  */
-void SI4735::ssbPowerUp()
+si4735_station *SI4735StationDb::next(uint8_t mode, uint16_t frequency, uint8_t up_down)
 {
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(POWER_UP);
-    Wire.write(0b00010001); // This is a condition for loading the patch: Set to AM, Enable External Crystal Oscillator; Set patch enable; GPO2 output disabled; CTS interrupt disabled. You can change this calling setSSB.
-    Wire.write(0b00000101); // This is a condition for loading the patch: Set to Analog Output. You can change this calling setSSB.
-    Wire.endTransmission();
-    delayMicroseconds(2500);
+    uint16_t i = search(mode, frequency);
 
-    powerUp.arg.CTSIEN = this->currentInterruptEnable; // 1 -> Interrupt anabled;
-    powerUp.arg.GPO2OEN = 0;                           // 1 -> GPO2 Output Enable;
-    powerUp.arg.PATCH = 0;                             // 0 -> Boot normally;
-    powerUp.arg.XOSCEN = this->currentClockType;       // 1 -> Use external crystal oscillator;
-    powerUp.arg.FUNC = 1;                              // 0 = FM Receive; 1 = AM/SSB (LW/MW/SW) Receiver.
-    powerUp.arg.OPMODE = 0b00000101;                   // 0x5 = 00000101 = Analog audio outputs (LOUT/ROUT).
+    if (up_down == SEEK_UP)
+    {
+        if (i < count && stations[i].mode == mode && stations[i].frequency == frequency)
+            i++;
+        if (i < count && stations[i].mode == mode)
+            return &stations[i];
+        i = search(mode, 0); // The first station of the mode
+    }
+    else
+    {
+        if (i > 0 && stations[i - 1].mode == mode)
+            return &stations[i - 1];
+        i = search(mode + 1, 0); // After the last station of the mode
+        if (i == 0)
+            return NULL;
+        i--;
+    }
+    return (i < count && stations[i].mode == mode) ? &stations[i] : NULL;
 }
 
 /**
- * @ingroup group17 Patch and SSB support
- *  
- * @brief Transfers the content of a patch stored in a array of bytes to the SI4735 device. 
- *  
- * @details You must mount an array as shown below and know the size of that array as well.
- * 
- *  @details It is importante to say  that patches to the SI4735 are distributed in binary form and 
- *  have to be transferred to the internal RAM of the device by the host MCU (in this case Arduino).
- *  Since the RAM is volatile memory, the patch stored into the device gets lost when you turn off 
- *  the system. Consequently, the content of the patch has to be transferred again to the device 
- *  each time after turn on the system or reset the device.
- * 
- *  @details The disadvantage of this approach is the amount of memory used by the patch content. 
- *  This may limit the use of other radio functions you want implemented in Arduino.
- * 
- *  @details Example of content:
- *  @code
- *  const PROGMEM uint8_t ssb_patch_content_full[] =
- *   { // SSB patch for whole SSBRX full download
- *       0x15, 0x00, 0x0F, 0xE0, 0xF2, 0x73, 0x76, 0x2F,
- *       0x16, 0x6F, 0x26, 0x1E, 0x00, 0x4B, 0x2C, 0x58,
- *       0x16, 0xA3, 0x74, 0x0F, 0xE0, 0x4C, 0x36, 0xE4,
- *          .
- *          .
- *          .
- *       0x16, 0x3B, 0x1D, 0x4A, 0xEC, 0x36, 0x28, 0xB7,
- *       0x16, 0x00, 0x3A, 0x47, 0x37, 0x00, 0x00, 0x00,
- *       0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9D, 0x29};   
- * 
- *  const int size_content_full = sizeof ssb_patch_content_full;
- *  @endcode
- * 
- * @see Si47XX PROGRAMMING GUIDE; ;AN332 (REV 1.0) pages 64 and 215-220.  
- * 
- *  @param ssb_patch_content point to array of bytes content patch.
- *  @param ssb_patch_content_size array size (number of bytes). The maximum size allowed for a patch is 15856 bytes
- * 
- *  @return false if an error is found.
+ * @ingroup group23 Station database
+ *
+ * @brief Adds a station or updates its signal quality and time
+ * @details The RDS information of a known station is kept. If the database is full, the station with the oldest time is replaced.
+ *
+ * @param mode FM_CURRENT_MODE, AM_CURRENT_MODE or SSB_CURRENT_MODE
+ * @param frequency station frequency
+ * @param rssi RSSI (dBuV)
+ * @param snr SNR (dB)
+ * @param time when the station was heard (any unit)
+ * @return si4735_station* the station (NULL if the capacity is 0)
  */
-bool SI4735::downloadPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size)
+si4735_station *SI4735StationDb::update(uint8_t mode, uint16_t frequency, uint8_t rssi, uint8_t snr, uint32_t time)
 {
-    uint8_t content;
-    register int i, offset;
-    // Send patch to the SI4735 device
-    for (offset = 0; offset < (int)ssb_patch_content_size; offset += 8)
+    uint16_t i = search(mode, frequency);
+    si4735_station *station = &stations[i];
+
+    if (i >= count || station->mode != mode || station->frequency != frequency)
     {
-        Wire.beginTransmission(deviceAddress);
-        for (i = 0; i < 8; i++)
+        if (capacity == 0)
+            return NULL;
+        if (count == capacity)
         {
-            content = pgm_read_byte_near(ssb_patch_content + (i + offset));
-            Wire.write(content);
+            uint16_t oldest = 0;
+            for (uint16_t k = 1; k < count; k++)
+                if (stations[k].time < stations[oldest].time)
+                    oldest = k;
+            removeAt(oldest);
+            if (oldest < i)
+                i--;
+            station = &stations[i];
         }
-        Wire.endTransmission();
-
-        // Testing download performance
-        // approach 1 - Faster - less secure (it might crash in some architectures)
-        delayMicroseconds(MIN_DELAY_WAIT_SEND_LOOP); // Need check the minimum value
-
-        // approach 2 - More control. A little more secure than approach 1
-        /*
-        do
-        {
-            delayMicroseconds(150); // Minimum delay founded (Need check the minimum value)
-            Wire.requestFrom(deviceAddress, 1);
-        } while (!(Wire.read() & B10000000));
-        */
+        memmove(station + 1, station, (count - i) * sizeof(si4735_station));
+        count++;
+        memset(station, 0, sizeof(si4735_station));
+        station->mode = mode;
+        station->frequency = frequency;
+    }
 
-        // approach 3 - same approach 2
-        // waitToSend();
+    station->rssi = rssi;
+    station->snr = snr;
+    station->time = time;
+    changed = true;
+    return station;
+}
 
-        // approach 4 - safer
-        /*
-        waitToSend();
-        uint8_t cmd_status;
-        // Uncomment the lines below if you want to check erro.
-        Wire.requestFrom(deviceAddress, 1);
-        cmd_status = Wire.read();
-        // The SI4735 issues a status after each 8 byte transfered.
-        // Just the bit 7 (CTS) should be seted. if bit 6 (ERR) is seted, the system halts.
-        if (cmd_status != 0x80)
-           return false;
-        */
+/**
+ * @ingroup group23 Station database
+ *
+ * @brief Stores the RDS identification of a station
+ *
+ * @code
+ *   if (rx.getRdsReceived() && rx.getRdsSync())
+ *       db.setRds(FM_CURRENT_MODE, rx.getCurrentFrequency(), rx.getRdsPI(), rx.getRdsText0A());
+ * @endcode
+ *
+ * @param mode FM_CURRENT_MODE, AM_CURRENT_MODE or SSB_CURRENT_MODE
+ * @param frequency station frequency
+ * @param pi Program Identification (0 = unchanged)
+ * @param ps Program Service (station name; up to 8 characters). NULL = unchanged.
+ * @return false if the station is not in the database (see update and add)
+ */
+bool SI4735StationDb::setRds(uint8_t mode, uint16_t frequency, uint16_t pi, const char *ps)
+{
+    si4735_station *station = find(mode, frequency);
+
+    if (station == NULL)
+        return false;
+
+    if (pi != 0)
+    {
+        station->pi = pi;
+        station->flags |= STATION_RDS_PI;
+    }
+    if (ps != NULL)
+    {
+        uint8_t n = 0;
+        for (; n < sizeof station->ps && ps[n] != '\0'; n++)
+            station->ps[n] = ps[n];
+        for (; n < sizeof station->ps; n++)
+            station->ps[n] = '\0';
+        station->flags |= STATION_RDS_PS;
     }
-    delayMicroseconds(250);
+    changed = true;
     return true;
 }
 
 /**
- * @ingroup group17 Patch and SSB support
- * @brief Loads a given SSB patch content
- * @details Configures the Si4735-D60/SI4732-A10 device to work with SSB. 
- * 
- * @param ssb_patch_content        point to patch content array 
- * @param ssb_patch_content_size   size of patch content 
- * @param ssb_audiobw              SSB Audio bandwidth; 0 = 1.2kHz (default); 1=2.2kHz; 2=3kHz; 3=4kHz; 4=500Hz; 5=1kHz.
+ * @ingroup group23 Station database
+ *
+ * @brief Removes a station
+ *
+ * @param mode FM_CURRENT_MODE, AM_CURRENT_MODE or SSB_CURRENT_MODE
+ * @param frequency station frequency
+ * @return false if the station is not in the database
  */
-void SI4735::loadPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size, uint8_t ssb_audiobw)
+bool SI4735StationDb::remove(uint8_t mode, uint16_t frequency)
 {
-    queryLibraryId(); 
-    patchPowerUp();
-    delay(50);
-    downloadPatch(ssb_patch_content, ssb_patch_content_size);
-    // Parameters
-    // AUDIOBW - SSB Audio bandwidth; 0 = 1.2kHz (default); 1=2.2kHz; 2=3kHz; 3=4kHz; 4=500Hz; 5=1kHz;
-    // SBCUTFLT SSB - side band cutoff filter for band passand low pass filter ( 0 or 1)
-    // AVC_DIVIDER  - set 0 for SSB mode; set 3 for SYNC mode.
-    // AVCEN - SSB Automatic Volume Control (AVC) enable; 0=disable; 1=enable (default).
-    // SMUTESEL - SSB Soft-mute Based on RSSI or SNR (0 or 1).
-    // DSP_AFCDIS - DSP AFC Disable or enable; 0=SYNC MODE, AFC enable; 1=SSB MODE, AFC disable.
-    setSSBConfig(ssb_audiobw, 1, 0, 0, 0, 1);
-    delay(25);
+    uint16_t i = search(mode, frequency);
+
+    if (i >= count || stations[i].mode != mode || stations[i].frequency != frequency)
+        return false;
+    removeAt(i);
+    return true;
 }
 
 /**
- * @ingroup group17 Patch and SSB support
- * @brief Transfers the content of a patch stored in an eeprom to the SI4735 device.
- * @details To used this method, you will need an eeprom with the patch content stored into it. 
- * @details This content have to be generated by the sketch [SI47XX_09_SAVE_SSB_PATCH_EEPROM](https://github.com/pu2clr/SI4735/tree/master/examples/TOOLS/SI47XX_09_SAVE_SSB_PATCH_EEPROM) on folder TOOLS.
- * 
- * @see SI47XX_09_SAVE_SSB_PATCH_EEPROM
- * @see si4735_eeprom_patch_header 
- * @ref https://github.com/pu2clr/SI4735/tree/master/examples/TOOLS/SI47XX_09_SAVE_SSB_PATCH_EEPROM
- * 
- * @param eeprom_i2c_address 
- * @return false if an error is found.
+ * @ingroup group23 Station database
+ *
+ * @brief Adds (or updates) the station tuned by the receiver
+ * @details Uses the current mode and frequency and the RSSI and SNR of the last RSQ status read 
+ * @details (call getCurrentReceivedSignalQuality before). For example, after a seek.
+ *
+ * @param rx the receiver
+ * @param time when the station was heard (any unit)
+ * @return si4735_station* the station (NULL if the capacity is 0)
  */
-si4735_eeprom_patch_header SI4735::downloadPatchFromEeprom(int eeprom_i2c_address)
+si4735_station *SI4735StationDb::add(SI4735 *rx, uint32_t time)
 {
-    si4735_eeprom_patch_header eep;
-    const int header_size = sizeof eep;
-    uint8_t bufferAux[8];
-    int offset, i;
+    return update(rx->lastMode, rx->getCurrentFrequency(), rx->getCurrentRSSI(), rx->getCurrentSNR(), time);
+}
 
-    // Gets the EEPROM patch header information
-    Wire.beginTransmission(eeprom_i2c_address);
-    Wire.write(0x00); // offset Most significant Byte
-    Wire.write(0x00); // offset Less significant Byte
-    Wire.endTransmission();
-    delay(5);
+/**
+ * @ingroup group23 Station database
+ *
+ * @brief Adds (or updates) the valid channels of a band scan
+ * @details Call it when the band scan is done (see SI4735::beginBandScan), before changing the band or the mode.
+ *
+ * @param rx the receiver that has run the band scan
+ * @param table the scan table
+ * @param size number of channels of the table (see SI4735::getBandScanCount)
+ * @param time when the scan was run (any unit)
+ * @return uint16_t number of stations added or updated
+ */
+uint16_t SI4735StationDb::addScan(SI4735 *rx, const si4735_scan_channel *table, uint16_t size, uint32_t time)
+{
+    uint16_t added = 0;
 
-    // The first two bytes of the header will be ignored.
-    for (int k = 0; k < header_size; k += 8)
+    for (uint16_t i = 0; i < size; i++)
     {
-        Wire.requestFrom(eeprom_i2c_address, 8);
-        for (int i = k; i < (k + 8); i++)
-            eep.raw[i] = Wire.read();
+        if (table[i].valid && update(rx->lastMode, rx->getBandScanFrequency(i), table[i].rssi, table[i].snr, time) != NULL)
+            added++;
     }
+    return added;
+}
 
-    // Transferring patch from EEPROM to SI4735 device
-    offset = header_size;
-    for (i = 0; i < (int)eep.refined.patch_size; i += 8)
-    {
-        // Reads patch content from EEPROM
-        Wire.beginTransmission(eeprom_i2c_address);
-        Wire.write((int)offset >> 8);   // header_size >> 8 wil be always 0 in this case
-        Wire.write((int)offset & 0XFF); // offset Less significant Byte
-        Wire.endTransmission();
+/**
+ * @ingroup group23 Station database
+ *
+ * @brief Saves the database to an I2C EEPROM
+ * @details The image is a header (si4735_station_db_header; 8 bytes) followed by the records (20 bytes each).
+ * @details The records are written before the header. An interrupted save leaves an image that load rejects.
+ * @details Choose an offset after the SSB patch if the same EEPROM keeps it (32 + patch size; see downloadPatchFromEeprom).
+ * @details Use isChanged to avoid writing an unchanged database.
+ *
+ * @see SI4735::eepromWrite
+ *
+ * @param rx the receiver (its transport is used to reach the EEPROM)
+ * @param eepromAddress EEPROM I2C address (for example, 0x50)
+ * @param offset first EEPROM address of the image
+ * @return false if the EEPROM write failed
+ */
+bool SI4735StationDb::save(SI4735 *rx, uint8_t eepromAddress, uint16_t offset)
+{
+    si4735_station_db_header header;
+    uint16_t size = count * sizeof(si4735_station);
 
-        Wire.requestFrom(eeprom_i2c_address, 8);
-        for (int j = 0; j < 8; j++)
-        {
-            bufferAux[j] = Wire.read();
-        }
+    header.magic = STATION_DB_MAGIC;
+    header.version = STATION_DB_VERSION;
+    header.recordSize = sizeof(si4735_station);
+    header.count = count;
+    header.checksum = checksum((const uint8_t *)stations, size);
 
-        Wire.beginTransmission(deviceAddress);
-        Wire.write(bufferAux, 8);
-        Wire.endTransmission();
+    if (!rx->eepromWrite(eepromAddress, offset + sizeof header, (const uint8_t *)stations, size) ||
+        !rx->eepromWrite(eepromAddress, offset, (const uint8_t *)&header, sizeof header))
+        return false;
 
-        waitToSend();
-        uint8_t cmd_status;
-        Wire.requestFrom(deviceAddress, 1);
-        cmd_status = Wire.read();
-        // The SI4735 issues a status after each 8 byte transfered.Just the bit 7(CTS)should be seted.if bit 6(ERR)is seted, the system halts.
-        if (cmd_status != 0x80)
-        {
-            strcpy((char *)eep.refined.patch_id, "error!");
-            return eep;
-        }
-        offset += 8; // Start processing the next 8 bytes
+    changed = false;
+    return true;
+}
+
+/**
+ * @ingroup group23 Station database
+ *
+ * @brief Loads the database from an I2C EEPROM (see save)
+ * @details The image is rejected (and the database is empty) if the header is not valid, the records do not fit
+ * @details the capacity, the checksum does not match or the records are not sorted.
+ *
+ * @see SI4735::eepromRead
+ *
+ * @param rx the receiver (its transport is used to reach the EEPROM)
+ * @param eepromAddress EEPROM I2C address (for example, 0x50)
+ * @param offset first EEPROM address of the image
+ * @return true if the database was loaded
+ */
+bool SI4735StationDb::load(SI4735 *rx, uint8_t eepromAddress, uint16_t offset)
+{
+    si4735_station_db_header header;
+    uint16_t size;
+
+    count = 0;
+    changed = false;
+
+    if (!rx->eepromRead(eepromAddress, offset, (uint8_t *)&header, sizeof header))
+        return false;
+    if (header.magic != STATION_DB_MAGIC || header.version != STATION_DB_VERSION ||
+        header.recordSize != sizeof(si4735_station) || header.count > capacity)
+        return false;
+
+    size = header.count * sizeof(si4735_station);
+    if (!rx->eepromRead(eepromAddress, offset + sizeof header, (uint8_t *)stations, size) ||
+        checksum((const uint8_t *)stations, size) != header.checksum)
+        return false;
+
+    for (uint16_t i = 1; i < header.count; i++)
+    {
+        if (stationKey(stations[i - 1].mode, stations[i - 1].frequency) >= stationKey(stations[i].mode, stations[i].frequency))
+            return false;
     }
 
-    delay(50);
-    return eep;
+    count = header.count;
+    return true;
 }
 
+/** @defgroup group24 EEPROM store */
+
 /**
- * @defgroup group20 SI4735-D60 / SI4732-A10  NBFM 
- * 
- * @brief Narrow Band FM (Frequency Modulation) implementation.<br>  
- * First of all, it is important to say that the NBFM patch content **is not part of this library**. 
- * It is important to note that the author of this library does not encourage anyone to use the NBFM patches content for commercial purposes.
- * In other words, this library only supports NBFM patches, the patches themselves are not part of this library.  
- * 
- * @details This implementation was tested only on Si4735-D60  and SI4732-A10 devices. 
- * @details This implementation is applicable to Si47035-D60 and SI4732-A10 when powering up the part in FM mode with the NBFM patch
- * 
- * @details What does NBFM patch means?
- * In this context, a patch is a piece of software used to change the behavior of the SI4735-D60/SI4732-A10 device.
- * There is little information available about patching the SI4735-D60/SI4732-A10.
- *  
- * The following information is the understanding of the author of this project and 
- * it is not necessarily correct. 
- * 
- * A patch is executed internally (run by internal MCU) of the device. Usually, 
- * patches are used to fixes bugs or add improvements and new features of the firmware
- * installed in the internal ROM of the device. Patches to the SI4735 or SI4732 are distributed
- * in binary form and have to be transferred to the internal RAM of the device by the 
- * host MCU (in this case Arduino boards). 
- * Since the RAM is volatile memory, the patch stored into the device gets lost when 
- * you turn off the system. Consequently, the content of the patch has to be transferred
- * again to the device each time after turn on the system or reset the device.
- * 
- * I would like to thank Mr Vadim Afonkin for making available the SSBRX patches for 
- * SI4735-D60/SI4732-A10 on his Dropbox repository. On this repository you have two files, 
- * amrx_6_0_1_ssbrx_patch_full_0x9D29.csg and amrx_6_0_1_ssbrx_patch_init_0xA902.csg. 
- * It is important to know that the patch content of the original files is constant 
- * hexadecimal representation used by the language C/C++. Actally, the original files 
- * are in ASCII format (not in binary format). 
- * If you are not using C/C++ or if you want to load the files directly to the SI4735, 
- * you must convert the values to numeric value of the hexadecimal constants. 
- * For example: 0x15 = 21 (00010101); 0x16 = 22 (00010110); 0x01 = 1 (00000001); 
- * 0xFF = 255 (11111111);
- * 
- * @details ATTENTION: The author of this project does not guarantee that procedures shown 
- * here will work in your development environment. Given this, it is at your own risk 
- * to continue with the procedures suggested here. This library works with the I²C 
- * communication protocol and it is designed to apply a SSB extension PATCH to  
- * SI4735-D60 and SI4732-A10 devices. Once again, the author disclaims any liability for any damage this 
- * procedure may cause to your SI4735-D60 or SI4732-A10 or other devices that you are using.
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; pages 3 and 5 
+ * @ingroup group24 EEPROM store
+ *
+ * @brief Construct a new SI4735EepromStore
+ *
+ * @param values array with the values (key = index). Fill it with the defaults before begin. It must exist while the store is used.
+ * @param keys number of values (up to STORE_MAX_KEYS)
  */
+SI4735EepromStore::SI4735EepromStore(uint16_t *values, uint8_t keys)
+{
+    this->values = values;
+    this->keys = (keys > STORE_MAX_KEYS) ? STORE_MAX_KEYS : keys;
+}
 
-/**  
- * @ingroup group20 Patch and NBFM support
- *  
- * @brief This method can be used to prepare the device to apply NBFM patch
- *  
- * @details Call queryLibraryId before call this method. Powerup the device by issuing the POWER_UP 
- * command with FUNC = 0 (FM Receiver).
- * 
- * @see setMaxDelaySetFrequency()
- * @see MAX_DELAY_AFTER_POWERUP 
- * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 64 and 215-220 and
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE AMENDMENT FOR SI4735-D60 SSB AND NBFM PATCHES; page 32.
+/**
+ * @ingroup group24 EEPROM store
+ * @brief CRC-16/CCITT (polynomial 0x1021)
  */
-void SI4735::patchPowerUpNBFM()
+uint16_t SI4735EepromStore::crc16(uint16_t crc, const uint8_t *data, uint16_t size)
 {
-    waitToSend();
-    Wire.beginTransmission(deviceAddress);
-    Wire.write(POWER_UP);
-    Wire.write(0b00110000);          // This is a condition for loading the patch: Set to AM, Enable External Crystal Oscillator; Set patch enable; GPO2 output disabled; CTS interrupt disabled.
-    Wire.write(SI473X_ANALOG_AUDIO); // This is a condition for loading the patch: Set to Analog Output. You can change this calling setNBFM.
-    Wire.endTransmission();
-    delay(maxDelayAfterPouwerUp);
+    for (uint16_t i = 0; i < size; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
 }
 
 /**
- * @ingroup group20 Patch and NBFM support
- * @brief Loads a given NBFM patch content
- * @details Configures the Si4735-D60/SI4732-A10 device to work with NBFM. 
- * 
- * @param patch_content        point to patch content array 
- * @param patch_content_size   size of patch content 
+ * @ingroup group24 EEPROM store
+ * @brief Reads only the sequence number of a record (used by the binary search)
  */
-void SI4735::loadPatchNBFM(const uint8_t *patch_content, const uint16_t patch_content_size)
+bool SI4735EepromStore::readSequence(uint16_t slot, uint16_t *value)
 {
-    queryLibraryId();
-    patchPowerUpNBFM();
-    delay(50);
-    downloadPatch(patch_content, patch_content_size);
-    // TODO 
-    delay(25);
+    return rx->eepromRead(eepromAddress, start + slot * getRecordSize(), (uint8_t *)value, 2);
 }
 
 /**
- * @ingroup group20 Patch and NBFM support
- * 
- * @brief Set the radio to FM function. 
- * 
- * @todo Adjust the power up parameters
- * 
- * @details Set the radio to NBFM function. 
- * 
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; pages 32 and 14 
- * @see setAM(), setSSB(), setFM()
- * @see setFrequencyStep()
- * @see void SI4735::setFrequency(uint16_t freq)
+ * @ingroup group24 EEPROM store
+ * @brief Reads a record and, if its CRC is valid, copies its values to the values array
+ * @return false if the record is corrupted (or was never written)
  */
-void SI4735::setNBFM()
+bool SI4735EepromStore::readRecord(uint16_t slot)
 {
-    // Is it needed to load patch when switch to SSB?
-    // powerDown();
-    // It starts with the same AM parameters.
-    // setPowerUp(1, 1, 0, 1, 1, currentAudioMode);
-    setPowerUp(this->currentInterruptEnable, 0, 0, this->currentClockType, 0, currentAudioMode);
-    radioPowerUp();
-    currentTune = NBFM_TUNE_FREQ; // Force current tune to NBFM commands
-    // ssbPowerUp(); // Not used for regular operation
-    setVolume(volume); // Set to previus configured volume
-    currentSsbStatus = 0;
-    lastMode = NBFM_CURRENT_MODE;
+    uint8_t record[STORE_MAX_KEYS * 2 + 4];
+    uint16_t size = getRecordSize();
+    uint16_t crc;
+
+    if (!rx->eepromRead(eepromAddress, start + slot * size, record, size))
+        return false;
+
+    // The number of keys is part of the CRC. A record written with another set of values is rejected.
+    crc = crc16(0xFFFF, &keys, 1);
+    crc = crc16(crc, record, size - 2);
+    if (record[size - 2] != (crc & 0xFF) || record[size - 1] != (crc >> 8))
+        return false;
+
+    memcpy(values, &record[2], keys * 2);
+    return true;
 }
 
 /**
- * @ingroup group20 Patch and NBFM support
- *  
- * @details Tunes the SSB (LSB or USB) receiver to a frequency between 64 and 108 MHz. 
- * 
- * @see AN332 REV 0.8 UNIVERSAL PROGRAMMING GUIDE; 
- * @see setAM(), setFM(), setSSB()
- * @see setFrequencyStep()
- * @see void SI4735::setFrequency(uint16_t freq)
- * 
- * @param fromFreq minimum frequency for the band
- * @param toFreq maximum frequency for the band
- * @param initialFreq initial frequency 
- * @param step step used to go to the next channel  
- 
+ * @ingroup group24 EEPROM store
+ *
+ * @brief Sets the EEPROM region and recovers the newest valid record
+ * @details Reads O(log n) sequence numbers (n = number of records of the region) plus one or two records.
+ * @details If no valid record is found, the values array keeps the defaults.
+ *
+ * @param rx the receiver (its transport is used to reach the EEPROM)
+ * @param eepromAddress EEPROM I2C address (for example, 0x50)
+ * @param start first EEPROM address of the region (see SI4735::getEepromPatchEnd)
+ * @param size region size in bytes. Each record takes keys * 2 + 4 bytes.
+ * @return true if a record was recovered
  */
-void SI4735::setNBFM(uint16_t fromFreq, uint16_t toFreq, uint16_t initialFreq, uint16_t step)
+bool SI4735EepromStore::begin(SI4735 *rx, uint8_t eepromAddress, uint16_t start, uint16_t size)
 {
-    currentMinimumFrequency = fromFreq;
-    currentMaximumFrequency = toFreq;
-    currentStep = step;
+    uint16_t first, value, low, high;
+
+    this->rx = rx;
+    this->eepromAddress = eepromAddress;
+    this->start = start;
+    slots = size / getRecordSize();
+    head = 0;
+    sequence = 0xFFFF;
+    dirty = false;
+
+    if (slots == 0 || !readSequence(0, &first))
+        return false;
+
+    // The records are written in slot order and the sequence grows by one on each write. So, the slots of the current lap
+    // have the sequence of slot 0 plus their index. The newest record is the last slot of the current lap.
+    low = 0;
+    high = slots - 1;
+    while (low < high)
+    {
+        uint16_t middle = low + (high - low + 1) / 2;
+        if (!readSequence(middle, &value))
+            return false;
+        if (value == (uint16_t)(first + middle))
+            low = middle;
+        else
+            high = middle - 1;
+    }
 
-    if (initialFreq < fromFreq || initialFreq > toFreq)
-        initialFreq = fromFreq;
+    // The next record goes after this slot, even if it is corrupted. The lap invariant is kept.
+    head = low;
+    sequence = first + low;
 
-    setNBFM();
+    for (uint16_t n = 0; n < STORE_RECOVERY_SLOTS && n < slots; n++)
+    {
+        if (readRecord((head + slots - n) % slots))
+            return true;
+    }
+    return false;
+}
 
-    currentWorkFrequency = initialFreq;
-    setFrequency(currentWorkFrequency);
+/**
+ * @ingroup group24 EEPROM store
+ *
+ * @brief Changes a value
+ * @details Only the RAM copy is changed. The EEPROM is written by service (after the flush delay) or flush.
+ *
+ * @param key 0 to keys - 1
+ * @param value new value
+ */
+void SI4735EepromStore::set(uint8_t key, uint16_t value)
+{
+    if (key >= keys || values[key] == value)
+        return;
+    values[key] = value;
+    dirty = true;
+    changeTime = millis();
+}
+
+/**
+ * @ingroup group24 EEPROM store
+ *
+ * @brief Writes the values as a new record in the next slot (if there are changes)
+ * @details Call it before a power down or a reset to save the pending changes at once.
+ *
+ * @see SI4735::eepromWrite
+ *
+ * @return false if the EEPROM write failed (the changes stay pending)
+ */
+bool SI4735EepromStore::flush()
+{
+    uint8_t record[STORE_MAX_KEYS * 2 + 4];
+    uint16_t size = getRecordSize();
+    uint16_t slot, next, crc;
+
+    if (!dirty)
+        return true;
+    if (rx == NULL || slots == 0)
+        return false;
+
+    slot = (head + 1) % slots;
+    next = sequence + 1;
+
+    memcpy(record, &next, 2);
+    memcpy(&record[2], values, keys * 2);
+    crc = crc16(0xFFFF, &keys, 1);
+    crc = crc16(crc, record, size - 2);
+    record[size - 2] = crc & 0xFF;
+    record[size - 1] = crc >> 8;
+
+    if (!rx->eepromWrite(eepromAddress, start + slot * size, record, size))
+        return false;
+
+    head = slot;
+    sequence = next;
+    dirty = false;
+    return true;
+}
+
+/**
+ * @ingroup group24 EEPROM store
+ *
+ * @brief Writes the pending changes when no value has changed for the flush delay (see setFlushDelay)
+ * @details Call it in the loop. It does not access the bus while there is nothing to write.
+ *
+ * @return true if there are changes still pending
+ */
+bool SI4735EepromStore::service()
+{
+    if (dirty && (millis() - changeTime) >= flushDelay)
+        flush();
+    return dirty;
 }
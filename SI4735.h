@@ -17,6 +17,9 @@
  * @date  2019-2020
  */
 
+#ifndef _SI4735_H
+#define _SI4735_H
+
 #include <Arduino.h>
 #include <Wire.h>
 
@@ -190,11 +193,64 @@
 #define MAX_DELAY_AFTER_SET_FREQUENCY 30 // In ms - This value helps to improve the precision during of getting frequency value
 #define MAX_DELAY_AFTER_POWERUP 10       // In ms - Max delay you have to setup after a power up command.
 #define MIN_DELAY_WAIT_SEND_LOOP 300     // In uS (Microsecond) - each loop of waitToSend sould wait this value in microsecond
+#define MIN_DELAY_WAIT_INTERRUPT_LOOP 20 // In uS (Microsecond) - each loop of waitToSend waiting for the GPO2/INT edge checks the interrupt flag after this value
+#define MAX_DELAY_WAIT_INTERRUPT 100     // In ms - Max time waiting for the GPO2/INT edge before falling back to polling
 #define MAX_SEEK_TIME 8000               // defines the maximum seeking time 8s is default.
 
+// Field masks used by getStatus and getCurrentReceivedSignalQuality to read just the bytes needed
+#define FIELD_VALID 0x01     // VALID, AFCRL, SMUTE (RSQ) or BLTF (tune status)
+#define FIELD_PILOT 0x02     // PILOT and STBLEND (RSQ only)
+#define FIELD_FREQUENCY 0x04 // READFREQH and READFREQL (tune status only)
+#define FIELD_RSSI 0x08      // RSSI
+#define FIELD_SNR 0x10       // SNR
+#define FIELD_MULT 0x20      // MULT (multipath)
+#define FIELD_FREQOFF 0x40   // FREQOFF (RSQ only)
+#define FIELD_ANTCAP 0x80    // READANTCAP (tune status only)
+#define FIELD_ALL 0xFF       // All fields
+
 #define XOSCEN_CRYSTAL 1 // Use crystal oscillator
 #define XOSCEN_RCLK 0    // Use external RCLK (crystal oscillator disabled).
 
+#define WAIT_MODE_POLLING 0   // waitToSend polls the status byte (CTS) through the I2C bus
+#define WAIT_MODE_INTERRUPT 1 // waitToSend, tune and seek wait for the GPO2/INT edge (CTS and STC interrupts). Fall back to polling on timeout.
+
+// Command latency model (see setCommandLatency). Expected completion time classes.
+#define LATENCY_PROPERTY 0  // SET_PROPERTY and GET_PROPERTY (CTS)
+#define LATENCY_FM_TUNE 1   // FM_TUNE_FREQ, FM_SEEK_START and NBFM_TUNE_FREQ (CTS)
+#define LATENCY_AM_TUNE 2   // AM_TUNE_FREQ, AM_SEEK_START and SSB_TUNE_FREQ (CTS)
+#define LATENCY_FM_RSQ 3    // FM_RSQ_STATUS and NBFM_RSQ_STATUS (CTS)
+#define LATENCY_AM_RSQ 4    // AM_RSQ_STATUS and SSB_RSQ_STATUS (CTS)
+#define LATENCY_FM_RDS 5    // FM_RDS_STATUS (CTS)
+#define LATENCY_POWER 6     // POWER_UP and POWER_DOWN (CTS)
+#define LATENCY_PATCH 7     // Each 8 bytes patch line (CTS)
+#define LATENCY_OTHER 8     // Any other command (CTS)
+#define LATENCY_FM_STC 9    // FM (and NBFM) tune: from CTS to Seek/Tune Complete (STC)
+#define LATENCY_AM_STC 10   // AM and SSB tune: from CTS to Seek/Tune Complete (STC)
+#define LATENCY_CLASSES 11  // Number of latency classes
+#define LATENCY_NONE 0xFF   // No command is pending (CTS already confirmed)
+
+// Asynchronous (non-blocking) commands. See service().
+#define ASYNC_IDLE 0          // No asynchronous operation running
+#define ASYNC_SET_FREQUENCY 1 // beginSetFrequency
+#define ASYNC_SEEK 2          // beginSeek
+#define ASYNC_MODE_CHANGE 3   // beginModeChange
+#define ASYNC_LOAD_PATCH 4    // beginLoadPatch
+#define ASYNC_BAND_SCAN 5     // beginBandScan
+#define ASYNC_BANDSCOPE 6     // beginBandscope
+
+#define ASYNC_RESULT_NONE 0    // The operation is still running (or nothing was done yet)
+#define ASYNC_RESULT_DONE 1    // The operation is done
+#define ASYNC_RESULT_TIMEOUT 2 // STC was not found within the time limit (maxDelaySetFrequency or maxSeekTime)
+#define ASYNC_RESULT_CANCELED 3 // The seek, the band scan or the bandscope sweep was canceled (see cancelSeek and cancelBandScan)
+
+#define MIN_DELAY_WAIT_LATENCY_LOOP 100 // In uS - poll interval after the expected completion time of a command has elapsed
+#define MIN_DELAY_WAIT_STC_LOOP 1000    // In uS - first poll interval waiting for STC (doubled on each poll)
+#define SETTLE_POLL_INTERVAL 2000       // In uS - RSQ poll interval of the signal settle detection (see setSettleDetection)
+#define MAX_DELAY_WAIT_STC_LOOP 16000   // In uS - max poll interval waiting for STC
+
+#define MIN_YIELD_TIME 200  // In uS - waits shorter than this value do not call the yield hook (see setYieldHook)
+#define YIELD_GUARD_TIME 50 // In uS - part of each wait kept out of the yield hook budget (time to return and finish the wait)
+
 /** @defgroup group01 Union, Struct and Defined Data Types 
  * @section group01 Data Types 
  *  
@@ -1017,20 +1073,519 @@ typedef struct
     uint16_t DOSR;                   // Digital Output Sample Rate(32–48 ksps .0 to disable digital audio output).
 } si4735_digital_output_sample_rate; // Maybe not necessary
 
-volatile static bool data_from_si4735; /** @ingroup group04 store the interrupt status */
+#define MAX_INTERRUPT_RECEIVERS 4 // Max number of SI4735 instances using the interrupt pin (setup) at the same time
+
+/**********************************************************************
+ * Bus transport
+ **********************************************************************/
 
 /**
- * @brief Interrupt Function
- * 
- * @details this function just set the volatile static bool data_from_si4735 to true;
- * 
- * If you are using interrupt feature, this function will be called by the system, not by you. 
- * If you are not using interrupt feature, please, ignore the compile message:
- * "warning: 'void interrupt_hundler()' defined but not used [-Wunused-function]"
+ * @ingroup group05
+ *
+ * @brief Bus transport used by the SI4735 class to talk to the Si47XX device
+ *
+ * @details Every byte exchanged with the Si47XX device (commands, arguments, responses and CTS polling) goes through
+ * an instance of this class. By default, the SI4735 class uses SI4735WireTransport (the Arduino Wire library).
+ * @details If you want to use another I2C driver (DMA, register-level driver, a second I2C bus or a host-side mock),
+ * extend this class and pass your instance to SI4735::setTransport.
+ *
+ * @code
+ * class MyTransport : public SI4735Transport {
+ *   public:
+ *     uint8_t write(uint8_t address, const uint8_t *data, uint8_t size) { ... return 0; }
+ *     uint8_t read(uint8_t address, uint8_t *data, uint8_t size) { ... return size; }
+ * };
+ *
+ * MyTransport myTransport;
+ * SI4735 rx;
+ *
+ * void setup() {
+ *   rx.setTransport(&myTransport);
+ *   rx.setup(RESET_PIN, FM_FUNCTION);
+ * }
+ * @endcode
+ *
+ * @see SI4735::setTransport, SI4735WireTransport
+ */
+class SI4735Transport
+{
+public:
+    virtual ~SI4735Transport() {}
+
+    /**
+     * @brief Starts the bus (the default implementation does nothing).
+     */
+    virtual void begin(){};
+
+    /**
+     * @brief Writes a full transaction (START, address, data and STOP) to a given I2C address.
+     *
+     * @param address I2C bus address
+     * @param data    bytes to be sent (command and arguments)
+     * @param size    number of bytes to be sent. Zero just checks if the address answers.
+     * @return uint8_t 0 if success (same convention of Wire.endTransmission)
+     */
+    virtual uint8_t write(uint8_t address, const uint8_t *data, uint8_t size) = 0;
+
+    /**
+     * @brief Reads size bytes from a given I2C address.
+     * @details Bytes not delivered by the device must be filled with 0xFF (same value returned by Wire.read on empty buffer).
+     *
+     * @param address I2C bus address
+     * @param data    buffer where the bytes will be stored
+     * @param size    number of bytes to read
+     * @return uint8_t number of bytes really received
+     */
+    virtual uint8_t read(uint8_t address, uint8_t *data, uint8_t size) = 0;
+
+    virtual uint8_t writeRead(uint8_t address, const uint8_t *data, uint8_t size, uint8_t *response, uint8_t responseSize);
+
+    /**
+     * @brief Tells if writeRead uses a repeated start (a single combined transaction). 
+     * @details If false (default), the library does not call writeRead. It writes the command and reads the response later.
+     */
+    virtual bool hasRepeatedStart() { return false; };
+
+    /**
+     * @brief Sets the bus clock in Hz (the default implementation does nothing).
+     */
+    virtual void setClock(uint32_t) {}
+
+    virtual void waitMicroseconds(uint32_t us);
+};
+
+/**
+ * @ingroup group05
+ *
+ * @brief Default transport. Arduino TwoWire (Wire library) adapter.
+ *
+ * @details You can use it to drive the Si47XX device through another TwoWire instance (for example, Wire1).
+ *
+ * @see SI4735Transport
  */
-static void interrupt_hundler()
+class SI4735WireTransport : public SI4735Transport
 {
-    data_from_si4735 = true;
+protected:
+    TwoWire *wire;              //!< TwoWire instance used by this transport
+    bool repeatedStart = false; //!< If true, writeRead uses a repeated start
+
+public:
+    SI4735WireTransport(TwoWire *wire = &Wire) { this->wire = wire; };
+
+    /**
+     * @brief Sets the TwoWire instance used by this transport (for example, Wire1)
+     * @param wire TwoWire instance
+     */
+    inline void setWire(TwoWire *wire) { this->wire = wire; };
+
+    void begin();
+    uint8_t write(uint8_t address, const uint8_t *data, uint8_t size);
+    uint8_t read(uint8_t address, uint8_t *data, uint8_t size);
+    uint8_t writeRead(uint8_t address, const uint8_t *data, uint8_t size, uint8_t *response, uint8_t responseSize);
+    void setClock(uint32_t frequency);
+
+    /**
+     * @brief Enables or disables the repeated start on writeRead (endTransmission(false) followed by requestFrom)
+     * @details Disabled by default. Check if your board Wire library supports it. 
+     * @param value true or false
+     */
+    inline void setRepeatedStart(bool value) { repeatedStart = value; };
+    inline bool hasRepeatedStart() { return repeatedStart; };
+};
+
+/**********************************************************************
+ * Bus statistics
+ **********************************************************************/
+
+// Uncomment the line below (or add -DSI4735_STATS to the compiler flags) to collect bus statistics (see SI4735::getStats).
+// If SI4735_STATS is not defined, the statistics do not use any byte of program or data memory.
+// #define SI4735_STATS
+
+#ifdef SI4735_STATS
+
+#define STATS_COMMANDS 16 // Number of different commands (opcodes) counted by the statistics
+
+// Settle statistics bands (see si4735_stats.settle)
+#define SETTLE_BAND_FM 0  // FM (and NBFM)
+#define SETTLE_BAND_MW 1  // AM below 1800 kHz (LW and MW)
+#define SETTLE_BAND_SW 2  // AM from 1800 kHz (SW)
+#define SETTLE_BAND_SSB 3 // SSB
+#define SETTLE_BANDS 4    // Number of settle statistics bands
+
+/**
+ * @ingroup group01
+ *
+ * @brief Settle statistics of a band
+ *
+ * @details Time from the tune command to the end of setFrequency: STC and, if enabled, the signal settle detection (see SI4735::setSettleDetection).
+ */
+typedef struct
+{
+    uint16_t tunes;      //!< Number of tunes (setFrequency)
+    uint16_t timeouts;   //!< Tunes that reached maxDelaySetFrequency (no STC or signal still changing)
+    uint32_t totalTime;  //!< Sum of the settle times (us)
+    uint32_t minTime;    //!< Shortest settle time (us)
+    uint32_t maxTime;    //!< Longest settle time (us)
+    uint16_t rsqPolls;   //!< RSQ status reads done by the settle detection
+} si4735_settle_stats;
+
+/**
+ * @ingroup group01
+ *
+ * @brief Bus statistics
+ *
+ * @details Collected only if SI4735_STATS is defined. See SI4735::getStats.
+ * @details The commands are counted per opcode. Each slot stores an opcode and the number of times it was sent.
+ * @details The slots are allocated in the order the commands are first seen. If all STATS_COMMANDS slots are in use, the command is counted in otherCommands.
+ * @details Patch lines (PATCH_ARGS and PATCH_DATA) are counted as commands too.
+ */
+typedef struct
+{
+    uint8_t opcode[STATS_COMMANDS];    //!< Command number of each slot (0 = free slot)
+    uint16_t commands[STATS_COMMANDS]; //!< Number of commands sent per slot
+    uint16_t otherCommands;            //!< Commands not counted per opcode (no free slot)
+    uint32_t bytesWritten;             //!< Bytes written on the bus (commands, arguments and EEPROM addresses)
+    uint32_t bytesRead;                //!< Bytes read from the bus (status, responses and EEPROM content)
+    uint32_t waits;                    //!< Number of CTS waits (waitToSend and command responses)
+    uint32_t waitTime;                 //!< Total time (us) spent waiting for CTS
+    uint32_t maxWaitTime;              //!< Longest CTS wait (us)
+    uint32_t ctsPolls;                 //!< Number of status reads done while waiting for CTS
+    uint16_t errRetries;               //!< Responses read again because the ERR bit was set
+    si4735_settle_stats settle[SETTLE_BANDS]; //!< Settle statistics per band (SETTLE_BAND_FM, SETTLE_BAND_MW, SETTLE_BAND_SW and SETTLE_BAND_SSB)
+} si4735_stats;
+
+#endif
+
+/**********************************************************************
+ * Property batch
+ **********************************************************************/
+
+#define LEGACY_DELAY_AFTER_SET_PROPERTY 550 // In uS - fixed delay used after each SET_PROPERTY before the latency model (used to report the saved time)
+
+/**
+ * @ingroup group01
+ *
+ * @brief Property batch report
+ *
+ * @details Filled by SI4735PropertyBatch::commit. The saved values compare the batch with the former path: 
+ * @details a fixed LEGACY_DELAY_AFTER_SET_PROPERTY us delay after each property plus one status poll preceded by MIN_DELAY_WAIT_SEND_LOOP us.
+ *
+ * @see SI4735::beginProperties
+ */
+typedef struct
+{
+    uint32_t bytes;      //!< Bytes transferred on the bus (commands and status reads)
+    uint32_t waitTime;   //!< Time (us) spent waiting for CTS
+    uint32_t elapsed;    //!< Wall time (us) from beginProperties to commit
+    int32_t savedBytes;  //!< Bus bytes saved
+    int32_t savedTime;   //!< Wall time (us) saved
+    uint16_t count;      //!< Number of properties written
+    uint16_t polls;      //!< Number of status (CTS) reads
+} si4735_property_batch_report;
+
+/**********************************************************************
+ * Band scan
+ **********************************************************************/
+
+/**
+ * @ingroup group01
+ *
+ * @brief Signal quality of one channel of a band scan (3 bytes)
+ *
+ * @details Filled by the band scan engine (see SI4735::beginBandScan) with the RSQ status read after the tune.
+ * @details The RSSI range is 0-127 dBuV. So, the VALID bit fits in the same byte.
+ */
+typedef struct
+{
+    uint8_t rssi : 7;  //!< RSSI (dBuV)
+    uint8_t valid : 1; //!< 1 = valid channel (RSSI and SNR above the seek tune thresholds)
+    uint8_t snr;       //!< SNR (dB)
+    uint8_t mult;      //!< Multipath (0-100). FM only; 0 on AM.
+} si4735_scan_channel;
+
+#define BANDSCOPE_THRESHOLD 2        // In dB - default RSSI change that refreshes a bandscope bin
+#define BANDSCOPE_MAX_OUTAGE 100     // In ms - default max time away from the listened frequency during a bandscope sweep (0 = no limit)
+#define BANDSCOPE_LISTEN_TIME 400    // In ms - default time on the listened frequency between two bandscope excursions
+#define BANDSCOPE_IDLE_SWEEPS 2      // A bin unchanged for this number of sweeps is idle
+#define BANDSCOPE_REFRESH_SWEEPS 4   // An idle bin is measured once every this number of sweeps
+
+/**
+ * @ingroup group01
+ *
+ * @brief One bin of a bandscope (2 bytes)
+ *
+ * @details Kept by the caller between sweeps (see SI4735::beginBandscope). 
+ */
+typedef struct
+{
+    uint8_t rssi; //!< Last RSSI (dBuV) delivered to the bin function
+    uint8_t idle; //!< Number of sweeps without a change beyond the threshold
+} si4735_bandscope_bin;
+
+/**********************************************************************
+ * Station database
+ **********************************************************************/
+
+#define EEPROM_PAGE_SIZE 16        // Bytes per EEPROM write transaction (24C32 and larger parts have pages of 32 bytes or more)
+#define EEPROM_WRITE_TIME 10000    // In us - max EEPROM write cycle (ACK polling limit)
+#define EEPROM_POLL_INTERVAL 500   // In us - delay between two EEPROM ACK polls
+#define EEPROM_MAX_SIZE 32768      // In bytes - largest EEPROM expected to keep the SSB patch (24C256). A longer patch size is not valid.
+
+#define STATION_DB_MAGIC 0x4453    // "SD" - station database image in the EEPROM
+#define STATION_DB_VERSION 1       // Version of the station database image
+#define STATION_RDS_PI 0x01        // si4735_station flag: the PI is known
+#define STATION_RDS_PS 0x02        // si4735_station flag: the PS (station name) is known
+
+/**
+ * @ingroup group01
+ *
+ * @brief One station of the station database (20 bytes)
+ *
+ * @details The fields are in size order. So, there is no padding on 8, 16 and 32 bits MCUs and the record has the
+ * @details same layout in RAM and in the EEPROM. The key is the mode plus the frequency (see SI4735StationDb).
+ */
+typedef struct
+{
+    uint32_t time;      //!< When the station was last heard (any unit; for example, seconds from millis() or an RTC)
+    uint16_t frequency; //!< Frequency. For example, FM => 10390 = 103.9 MHz; AM => 810 = 810 kHz.
+    uint16_t pi;        //!< RDS Program Identification (valid if flags has STATION_RDS_PI)
+    uint8_t mode;       //!< FM_CURRENT_MODE, AM_CURRENT_MODE or SSB_CURRENT_MODE
+    uint8_t rssi;       //!< Last RSSI (dBuV)
+    uint8_t snr;        //!< Last SNR (dB)
+    uint8_t flags;      //!< STATION_RDS_PI and STATION_RDS_PS
+    char ps[8];         //!< RDS Program Service (station name). Not terminated by '\0' when it has 8 characters.
+} si4735_station;
+
+/**
+ * @ingroup group01
+ *
+ * @brief Header of a station database image stored in an EEPROM (8 bytes)
+ *
+ * @details The records (si4735_station) follow the header. See SI4735StationDb::save.
+ */
+typedef struct
+{
+    uint16_t magic;     //!< STATION_DB_MAGIC
+    uint8_t version;    //!< STATION_DB_VERSION
+    uint8_t recordSize; //!< sizeof(si4735_station). An image saved by a build with a different layout is rejected.
+    uint16_t count;     //!< Number of records
+    uint16_t checksum;  //!< Fletcher-16 of the records
+} si4735_station_db_header;
+
+/**********************************************************************
+ * EEPROM store
+ **********************************************************************/
+
+#define STORE_MAX_KEYS 32          // Max number of values of an EEPROM store (the record is built on the stack)
+#define STORE_FLUSH_DELAY 2000     // In ms - default time without changes before an EEPROM store writes a new record
+#define STORE_RECOVERY_SLOTS 2     // Records checked back from the newest one when it is corrupted (an interrupted write)
+
+class SI4735;
+
+/**
+ * @ingroup group10
+ *
+ * @brief Property batch builder
+ *
+ * @details Writes a sequence of properties (SET_PROPERTY commands) with the minimum CTS gating. 
+ * @details Each property is sent as soon as the device is ready (CTS) for it. There is no fixed delay between them. 
+ * @details The device requires CTS before each command, so there is one CTS check per property (none if CTS is already known).  
+ * @details commit() waits the last property and fills the report.
+ *
+ * @code
+ *   si4735_property_batch_report report;
+ *   rx.beginProperties()
+ *       .add(FM_BLEND_RSSI_STEREO_THRESHOLD, 49)
+ *       .add(FM_BLEND_RSSI_MONO_THRESHOLD, 30)
+ *       .add(FM_SEEK_BAND_BOTTOM, 8750)
+ *       .add(FM_SEEK_BAND_TOP, 10790)
+ *       .commit(&report);
+ *   Serial.println(report.savedTime);
+ * @endcode
+ *
+ * @see SI4735::beginProperties
+ */
+class SI4735PropertyBatch
+{
+protected:
+    SI4735 *rx;
+    si4735_property_batch_report report;
+    uint32_t startTime;
+
+    void waitToSend();
+
+public:
+    SI4735PropertyBatch(SI4735 *rx);
+    SI4735PropertyBatch &add(uint16_t propertyNumber, uint16_t parameter);
+    void commit(si4735_property_batch_report *result = NULL);
+};
+
+/**
+ * @ingroup group23
+ *
+ * @brief Station database
+ *
+ * @details Keeps the stations found by scans, seeks and RDS in a caller supplied array, sorted by mode and frequency.
+ * @details Lookups (find, nearest and next) are binary searches. An insert moves the records after it (memmove).
+ * @details When the array is full, the station heard least recently is replaced.
+ * @details save and load copy the database to and from an I2C EEPROM (the same bus and addressing used by
+ * @details SI4735::downloadPatchFromEeprom). So, the sketch does not need to rescan the bands on each boot.
+ *
+ * @code
+ *   si4735_station stations[64];           // 20 bytes per station
+ *   SI4735StationDb db(stations, 64);
+ *
+ *   db.load(&rx, 0x50, 8192);              // EEPROM 0x50; after the SSB patch
+ *   ...
+ *   rx.beginBandScan(table, 205);          // When the scan is done:
+ *   db.addScan(&rx, table, rx.getBandScanCount(), millis() / 1000);
+ *   db.save(&rx, 0x50, 8192);
+ *   ...
+ *   si4735_station *s = db.nearest(FM_CURRENT_MODE, 10390);
+ * @endcode
+ *
+ * @see si4735_station, SI4735::eepromWrite, SI4735::eepromRead
+ */
+class SI4735StationDb
+{
+protected:
+    si4735_station *stations;
+    uint16_t capacity;
+    uint16_t count = 0;
+    bool changed = false;
+
+    uint16_t search(uint8_t mode, uint16_t frequency);
+    void removeAt(uint16_t index);
+    static uint16_t checksum(const uint8_t *data, uint16_t size);
+
+public:
+    SI4735StationDb(si4735_station *buffer, uint16_t capacity);
+
+    si4735_station *find(uint8_t mode, uint16_t frequency);
+    si4735_station *nearest(uint8_t mode, uint16_t frequency);
+    si4735_station *next(uint8_t mode, uint16_t frequency, uint8_t up_down);
+    si4735_station *update(uint8_t mode, uint16_t frequency, uint8_t rssi, uint8_t snr, uint32_t time);
+    bool setRds(uint8_t mode, uint16_t frequency, uint16_t pi, const char *ps = NULL);
+    bool remove(uint8_t mode, uint16_t frequency);
+
+    si4735_station *add(SI4735 *rx, uint32_t time);
+    uint16_t addScan(SI4735 *rx, const si4735_scan_channel *table, uint16_t size, uint32_t time);
+
+    bool save(SI4735 *rx, uint8_t eepromAddress, uint16_t offset);
+    bool load(SI4735 *rx, uint8_t eepromAddress, uint16_t offset);
+
+    /**
+     * @brief Removes all stations
+     */
+    inline void clear() { changed = changed || count != 0; count = 0; };
+
+    /**
+     * @brief Gets the number of stations
+     */
+    inline uint16_t getCount() { return count; };
+
+    /**
+     * @brief Gets a station by position (sorted by mode and frequency)
+     * @param index 0 to getCount() - 1
+     * @return si4735_station* the station or NULL if index is out of range
+     */
+    inline si4735_station *at(uint16_t index) { return (index < count) ? &stations[index] : NULL; };
+
+    /**
+     * @brief Checks if the database has changed since the last save or load
+     */
+    inline bool isChanged() { return changed; };
+};
+
+/**
+ * @ingroup group24
+ *
+ * @brief Wear-leveled key/value store in an I2C EEPROM
+ *
+ * @details Keeps a small set of 16 bits values (band, frequency, volume, memory channels, ...) indexed by key (0 to keys - 1).
+ * @details The values live in a caller supplied array. set changes only the RAM copy and marks the store dirty. service writes
+ * @details a new record after STORE_FLUSH_DELAY ms without changes (write-behind), so turning the encoder does not write the EEPROM.
+ * @details Each record is the whole set of values plus a sequence number and a CRC-16. Records are appended to a ring of slots
+ * @details (log-structured). So, each EEPROM cell is written once per lap instead of on every change.
+ * @details At boot, begin finds the newest record with a binary search on the sequence numbers (slot k of the current lap has the
+ * @details sequence of slot 0 plus k) and checks its CRC. If it is corrupted (power lost during the write), the previous one is used.
+ * @details Place the region after the SSB patch if the same EEPROM keeps it (see SI4735::getEepromPatchEnd). Do not start it at 0: 
+ * @details SI47XX_09_SAVE_SSB_PATCH_EEPROM writes the patch header there. getEepromPatchEnd never returns 0, but if the patch is 
+ * @details stored after the store, the patch overwrites it (the values go back to the defaults). So, store the patch first.
+ *
+ * @code
+ *   #define KEY_BAND 0
+ *   #define KEY_FREQUENCY 1
+ *   #define KEY_VOLUME 2
+ *
+ *   uint16_t state[3] = {0, 10390, 45};   // Defaults (used if the EEPROM has no valid record)
+ *   SI4735EepromStore store(state, 3);
+ *
+ *   void setup() {
+ *     ...
+ *     uint16_t start = rx.getEepromPatchEnd(0x50);
+ *     store.begin(&rx, 0x50, start, 1000); // 100 records of 10 bytes (3 values)
+ *   }
+ *
+ *   void loop() {
+ *     ...
+ *     store.set(KEY_FREQUENCY, rx.getCurrentFrequency());
+ *     store.service();
+ *   }
+ * @endcode
+ *
+ * @see SI4735::eepromWrite, SI4735::eepromRead
+ */
+class SI4735EepromStore
+{
+protected:
+    SI4735 *rx = NULL;
+    uint16_t *values;
+    uint8_t keys;
+    uint8_t eepromAddress = 0;
+    uint16_t start = 0;
+    uint16_t slots = 0;               //!< Number of records of the region
+    uint16_t head = 0;                //!< Slot of the newest record
+    uint16_t sequence = 0xFFFF;       //!< Sequence number of the newest record
+    bool dirty = false;
+    uint32_t changeTime = 0;          //!< millis() of the last change
+    uint16_t flushDelay = STORE_FLUSH_DELAY;
+
+    inline uint16_t getRecordSize() { return keys * 2 + 4; };
+    bool readSequence(uint16_t slot, uint16_t *value);
+    bool readRecord(uint16_t slot);
+    static uint16_t crc16(uint16_t crc, const uint8_t *data, uint16_t size);
+
+public:
+    SI4735EepromStore(uint16_t *values, uint8_t keys);
+
+    bool begin(SI4735 *rx, uint8_t eepromAddress, uint16_t start, uint16_t size);
+    void set(uint8_t key, uint16_t value);
+    bool flush();
+    bool service();
+
+    /**
+     * @brief Gets a value (the RAM copy; no bus access)
+     * @param key 0 to keys - 1
+     * @return uint16_t the value (0 if key is out of range)
+     */
+    inline uint16_t get(uint8_t key) { return (key < keys) ? values[key] : 0; };
+
+    /**
+     * @brief Checks if there are changes not written to the EEPROM yet
+     */
+    inline bool isDirty() { return dirty; };
+
+    /**
+     * @brief Sets the time without changes before service writes a new record
+     * @param ms time in ms (0 = writes on the next service call). Default STORE_FLUSH_DELAY.
+     */
+    inline void setFlushDelay(uint16_t ms) { flushDelay = ms; };
+
+    /**
+     * @brief Gets the number of records the region can hold (the number of writes between two writes of the same cells)
+     */
+    inline uint16_t getSlots() { return slots; };
 };
 
 /********************************************************************** 
@@ -1050,6 +1605,9 @@ static void interrupt_hundler()
  */
 class SI4735
 {
+    friend class SI4735PropertyBatch;
+    friend class SI4735StationDb;
+
 protected:
     char rds_buffer2A[65]; //!<  RDS Radio Text buffer - Program Information
     char rds_buffer2B[33]; //!<  RDS Radio Text buffer - Station Informaation
@@ -1062,6 +1620,13 @@ protected:
 
     int16_t deviceAddress = SI473X_ADDR_SEN_LOW; //!<  Stores the current I2C bus address.
 
+    SI4735WireTransport wireTransport; //!< Default transport (Arduino Wire library)
+    SI4735Transport *transport;        //!< Transport used to exchange data with the device. See setTransport.
+
+#ifdef SI4735_STATS
+    si4735_stats stats; //!< Bus statistics. See getStats.
+#endif
+
     // Delays
     uint16_t maxDelaySetFrequency = MAX_DELAY_AFTER_SET_FREQUENCY; //!< Stores the maximum delay after set frequency command (in ms).
     uint16_t maxDelayAfterPouwerUp = MAX_DELAY_AFTER_POWERUP;      //!< Stores the maximum delay you have to setup after a power up command (in ms).
@@ -1085,6 +1650,75 @@ protected:
     uint8_t currentClockType = XOSCEN_CRYSTAL; //!< Stores the current clock type used (Crystal or REF CLOCK)
     uint8_t currentInterruptEnable = 0;        //!< If you are using interrupt, this variable stores 1.
 
+    uint8_t waitMode = WAIT_MODE_POLLING;                      //!< Current waitToSend strategy (WAIT_MODE_POLLING or WAIT_MODE_INTERRUPT).
+    uint16_t maxDelayWaitInterrupt = MAX_DELAY_WAIT_INTERRUPT; //!< Max time (ms) waiting for the GPO2/INT edge before polling.
+    bool ctsInterruptArmed = false;                            //!< true if the device was set up to pulse GPO2/INT when CTS is set.
+    bool ctsPending = false;                                   //!< true if a command was sent and its CTS interrupt was not consumed yet.
+
+    volatile bool interruptFlag = false; //!< Set by the interrupt handler of this instance when the GPO2/INT edge arrives.
+    int8_t interruptSlot = -1;           //!< Position of this instance in interruptReceiver (-1 = interrupt handler not attached).
+
+    static SI4735 *interruptReceiver[MAX_INTERRUPT_RECEIVERS]; //!< Instances that own each interrupt handler (see setup).
+    static void interruptHandler0();
+    static void interruptHandler1();
+    static void interruptHandler2();
+    static void interruptHandler3();
+    void attachInterruptHandler();
+    void detachInterruptHandler();
+
+    uint16_t rdsLastFrequency = 0; //!< Frequency of the RDS buffers content. The buffers are cleared when it changes.
+
+    uint16_t commandLatency[LATENCY_CLASSES] = {550, 300, 300, 300, 300, 300, 10000, 300, 300, 10000, 20000}; //!< Expected completion time (us) of each latency class.
+    bool commandLatencyLearning = true;                        //!< If true, the commandLatency table is refined from the measured CTS and STC times.
+    uint8_t pendingLatencyClass = LATENCY_OTHER;               //!< Latency class of the last command sent (LATENCY_NONE if CTS was already confirmed).
+    uint32_t pendingCommandTime = 0;                           //!< micros() when the last command was sent.
+
+    uint8_t asyncOperation = ASYNC_IDLE;                       //!< Current asynchronous operation (ASYNC_IDLE if none).
+    uint8_t asyncStep;                                         //!< Current step of the asynchronous operation.
+    uint8_t asyncResult = ASYNC_RESULT_NONE;                   //!< Result of the last asynchronous operation.
+    uint16_t asyncParam;                                       //!< Parameter of the asynchronous operation (seek direction, mode, SSB audio bandwidth or band scan phase).
+    uint16_t asyncFrequency;                                   //!< Frequency to be tuned (beginSetFrequency or after a mode change; 0 = none).
+    uint32_t asyncTime;                                        //!< micros() when the current wait started.
+    uint32_t asyncDelay = 0;                                   //!< Time (us) to wait before the next step.
+    uint32_t asyncStcTime;                                     //!< micros() when the device started tuning or seeking.
+    const uint8_t *asyncPatch;                                 //!< Patch content being downloaded by beginLoadPatch.
+    uint16_t asyncPatchSize;                                   //!< Patch size.
+    uint16_t asyncPatchOffset;                                 //!< Next patch line.
+    void (*asyncCallback)(uint8_t operation, uint8_t result) = NULL; //!< Called when an asynchronous operation is done.
+    void (*seekProgressFunc)(uint16_t freq) = NULL;             //!< Called by service() with the frequency being scanned by a seek.
+    bool asyncCancel = false;                                  //!< The running seek was canceled (see cancelSeek).
+    bool asyncTimedOut = false;                                //!< The STC wait timed out. The device is being stopped; the result will be ASYNC_RESULT_TIMEOUT.
+    bool asyncSeekStopped = false;                             //!< CANCEL was sent to the running seek (cancelSeek or maxSeekTime). Its STC is being waited.
+    bool asyncStcInterrupt = false;                            //!< service() waits for the STC interrupt instead of polling.
+    si4735_scan_channel *scanTable = NULL;                     //!< Band scan result (see beginBandScan).
+    uint16_t scanSize = 0;                                     //!< Number of channels the scan table can store.
+    uint16_t scanCount = 0;                                    //!< Number of channels already scanned.
+    uint16_t scanFirst = 0;                                    //!< Frequency of the first channel of the scan.
+    uint16_t scanStep = 1;                                     //!< Step between two channels of the scan.
+    uint16_t pendingFrequency = 0;                             //!< Tune target queued while another operation runs (0 = none; see queueFrequency).
+    bool tuneCoalescing = false;                               //!< frequencyUp and frequencyDown queue the tune (see setTuneCoalescing).
+    uint8_t settleTolerance = 0;                               //!< RSSI and SNR change (dB) accepted as settled (0 = STC only; see setSettleDetection).
+    uint16_t scanReturn = 0;                                   //!< Frequency tuned again at the end of the scan.
+    si4735_bandscope_bin *scopeBins = NULL;                    //!< Bandscope bins (see beginBandscope).
+    void (*scopeFunc)(uint8_t bin, uint16_t freq, uint8_t rssi) = NULL; //!< Receives each bin refreshed by the bandscope.
+    uint16_t scopeFirst = 0;                                   //!< Frequency of the first bin.
+    uint16_t scopeSpan = 0;                                    //!< Frequency of the last bin minus scopeFirst.
+    uint8_t scopeCount = 0;                                    //!< Number of bins.
+    uint8_t scopeNext = 0;                                     //!< Next bin to be measured.
+    uint8_t scopeThreshold = BANDSCOPE_THRESHOLD;              //!< RSSI change (dB) that refreshes a bin.
+    uint8_t scopeSweep = 0;                                    //!< Sweep counter (idle bins refresh).
+    bool scopeAway = false;                                    //!< The device is tuned away from scanReturn.
+    uint32_t scopeExcursion = 0;                               //!< micros() when the current excursion started.
+    uint16_t scopeMaxOutage = BANDSCOPE_MAX_OUTAGE;            //!< Max time (ms) away from the listened frequency.
+    uint16_t scopeListenTime = BANDSCOPE_LISTEN_TIME;          //!< Time (ms) on the listened frequency between excursions.
+
+    uint8_t nextBandscopeBin(uint8_t bin);
+
+    void (*yieldFunc)(uint32_t budget) = NULL; //!< Called during the library waits (see setYieldHook).
+    uint16_t minYieldTime = MIN_YIELD_TIME;    //!< Waits shorter than this value (us) do not call yieldFunc.
+    bool yielding = false;                     //!< true while yieldFunc is running (the waits inside it do not call it again).
+    uint16_t yieldOverruns = 0;                //!< Number of times yieldFunc returned after the end of the wait.
+
     uint16_t refClock = 31768;     //!< Frequency of Reference Clock in Hz.
     uint16_t refClockPrescale = 1; //!< Prescaler for Reference Clock (divider).
     uint8_t refClockSourcePin = 0; //!< 0 = RCLK pin is clock source; 1 = DCLK pin is clock source.
@@ -1124,11 +1758,211 @@ protected:
     void getSsbAgcStatus();
     void setSsbAgcOverrite(uint8_t SSBAGCDIS, uint8_t SSBAGCNDX);
 
+    void waitMicroseconds(uint32_t us);
+    bool waitInterrupt(uint32_t timeout);
+
+    uint8_t getLatencyClass(uint8_t cmd);
+    void updateCommandLatency(uint8_t latencyClass, uint32_t measured, bool early);
+    bool waitStc(uint8_t latencyClass, uint16_t maxDelay, bool learn = true);
+    uint8_t waitCts();
+    uint8_t pollCts(uint8_t size, uint8_t *response, bool readResponse);
+    bool waitSignalSettle(uint32_t start, uint16_t maxDelay, uint8_t *polls);
+#ifdef SI4735_STATS
+    uint8_t waitCts(uint8_t size, uint8_t *response, bool readResponse);
+    void statsCommand(uint8_t cmd);
+    void statsSettle(uint32_t time, bool settled, uint8_t polls);
+#else
+    inline uint8_t waitCts(uint8_t size, uint8_t *response, bool readResponse) { return pollCts(size, response, readResponse); };
+    inline void statsCommand(uint8_t) {}
+    inline void statsSettle(uint32_t, bool, uint8_t) {}
+#endif
+
+    /**
+     * @brief Counts a response read again because of the ERR bit (see SI4735_STATS)
+     */
+    inline void statsErrRetry()
+    {
+#ifdef SI4735_STATS
+        stats.errRetries++;
+#endif
+    };
+
+    /**
+     * @brief Writes to the bus through the transport (counts the bytes if SI4735_STATS is defined)
+     */
+    inline uint8_t busWrite(uint8_t address, const uint8_t *data, uint8_t size)
+    {
+#ifdef SI4735_STATS
+        stats.bytesWritten += size;
+#endif
+        return transport->write(address, data, size);
+    };
+
+    /**
+     * @brief Reads from the bus through the transport (counts the bytes if SI4735_STATS is defined)
+     */
+    inline uint8_t busRead(uint8_t address, uint8_t *data, uint8_t size)
+    {
+#ifdef SI4735_STATS
+        stats.bytesRead += size;
+#endif
+        return transport->read(address, data, size);
+    };
+
+    /**
+     * @brief Writes and reads in a single transaction through the transport (counts the bytes if SI4735_STATS is defined)
+     */
+    inline uint8_t busWriteRead(uint8_t address, const uint8_t *data, uint8_t size, uint8_t *response, uint8_t responseSize)
+    {
+#ifdef SI4735_STATS
+        stats.bytesWritten += size;
+        stats.bytesRead += responseSize;
+#endif
+        return transport->writeRead(address, data, size, response, responseSize);
+    };
+    uint8_t prepareCommand(uint8_t *buffer, uint8_t cmd, int parameter_size, const uint8_t *parameter);
+
+    void completePowerUp(void);
+    void startTune(uint16_t freq);
+    uint8_t startSeek(uint8_t SEEKUP, uint8_t WRAP);
+
+    bool asyncClearToSend();
+    void asyncWait(uint32_t us);
+    void asyncFinish(uint8_t result);
+    void asyncStopSeek();
+
+    /**
+     * @brief Tells the latency model that a command (or a patch line) was just sent
+     * @param latencyClass LATENCY_PROPERTY, LATENCY_FM_TUNE, ... 
+     */
+    inline void setCommandPending(uint8_t latencyClass)
+    {
+        pendingLatencyClass = latencyClass;
+        pendingCommandTime = micros();
+    };
+
 public:
     SI4735();
+    ~SI4735();
     void reset(void);
     void waitToSend(void);
 
+    void setTransport(SI4735Transport *transport);
+
+    void setWaitMode(uint8_t mode, uint16_t timeout = MAX_DELAY_WAIT_INTERRUPT);
+
+    /**
+     * @ingroup group05 Interrupt
+     * @brief Gets the current waitToSend strategy
+     * @see setWaitMode
+     * @return uint8_t WAIT_MODE_POLLING or WAIT_MODE_INTERRUPT
+     */
+    inline uint8_t getWaitMode() { return waitMode; };
+
+    /**
+     * @ingroup group06 Command latency
+     * @brief Sets the expected completion time of a class of commands
+     * @details waitToSend sleeps about this time after sending a command before polling the CTS bit.
+     * @details The LATENCY_FM_STC and LATENCY_AM_STC values are the expected time from CTS to STC after a tune command.
+     * @details If the learning is enabled (default), the value is refined from the measured times.
+     * @see setCommandLatencyLearning, waitToSend
+     * @param latencyClass LATENCY_PROPERTY, LATENCY_FM_TUNE, LATENCY_AM_TUNE, LATENCY_FM_RSQ, LATENCY_AM_RSQ, LATENCY_FM_RDS, LATENCY_POWER, LATENCY_PATCH, LATENCY_OTHER, LATENCY_FM_STC or LATENCY_AM_STC
+     * @param us expected time in microseconds
+     */
+    inline void setCommandLatency(uint8_t latencyClass, uint16_t us)
+    {
+        if (latencyClass < LATENCY_CLASSES)
+            commandLatency[latencyClass] = us;
+    };
+
+    /**
+     * @ingroup group06 Command latency
+     * @brief Gets the current expected completion time (us) of a class of commands
+     * @see setCommandLatency
+     * @param latencyClass see setCommandLatency
+     * @return uint16_t time in microseconds (0 if latencyClass is invalid)
+     */
+    inline uint16_t getCommandLatency(uint8_t latencyClass) { return (latencyClass < LATENCY_CLASSES) ? commandLatency[latencyClass] : 0; };
+
+    /**
+     * @ingroup group06 Command latency
+     * @brief Enables or disables the runtime refinement of the command latency table
+     * @see setCommandLatency
+     * @param value true = enabled (default); false = disabled.
+     */
+    inline void setCommandLatencyLearning(bool value) { commandLatencyLearning = value; };
+
+    /**
+     * @ingroup group05 Bus transport
+     * @brief Gets the transport currently used to talk to the device
+     * @see setTransport
+     * @return SI4735Transport*
+     */
+    inline SI4735Transport *getTransport() { return transport; };
+
+    /**
+     * @ingroup group05 Bus transport
+     * @brief Uses the default transport (Arduino Wire library) on another TwoWire instance
+     * @details Call it before setup. Useful if you have more than one Si47XX device on different I2C buses.
+     * @code
+     *   rx1.setI2CBus(&Wire);
+     *   rx2.setI2CBus(&Wire1);
+     * @endcode
+     * @see setTransport
+     * @param wire TwoWire instance (Wire, Wire1, ...)
+     */
+    inline void setI2CBus(TwoWire *wire)
+    {
+        wireTransport.setWire(wire);
+        transport = &wireTransport;
+    };
+
+    /**
+     * @ingroup group05 Interrupt
+     * @brief Tells this instance that the GPO2/INT edge has arrived
+     * @details setup attaches an interrupt handler of its own for up to MAX_INTERRUPT_RECEIVERS instances. 
+     * @details If you prefer to dispatch the GPO2/INT edge from your own interrupt service routine (attached after setup), call this method from it.
+     */
+    inline void handleInterrupt() { interruptFlag = true; };
+
+    /**
+     * @ingroup group05 Interrupt
+     * @brief Checks if the GPO2/INT edge has arrived and was not handled yet
+     * @details Use it in the yield hook (see setYieldHook) to return at once when the library is waiting for the edge.
+     */
+    inline bool isInterruptPending() { return interruptFlag; };
+
+#ifdef SI4735_STATS
+    /**
+     * @ingroup group06 Bus statistics
+     * @brief Gets the bus statistics collected since the last resetStats (or the constructor)
+     * @details Available only if SI4735_STATS is defined (see SI4735.h).
+     * @code
+     *   const si4735_stats *st = rx.getStats();
+     *   Serial.print(st->waitTime / st->waits); // average CTS wait
+     * @endcode
+     * @see si4735_stats, resetStats, getStatsCommands
+     * @return const si4735_stats* 
+     */
+    inline const si4735_stats *getStats() { return &stats; };
+    void resetStats();
+    uint16_t getStatsCommands(uint8_t cmd);
+
+    /**
+     * @ingroup group06 Bus statistics
+     * @brief Gets the settle statistics of a band
+     * @details Available only if SI4735_STATS is defined (see SI4735.h).
+     * @code
+     *   const si4735_settle_stats *sw = rx.getSettleStats(SETTLE_BAND_SW);
+     *   Serial.print(sw->totalTime / sw->tunes); // average SW settle time (us)
+     * @endcode
+     * @see si4735_settle_stats, setSettleDetection
+     * @param band SETTLE_BAND_FM, SETTLE_BAND_MW, SETTLE_BAND_SW or SETTLE_BAND_SSB
+     * @return const si4735_settle_stats* 
+     */
+    inline const si4735_settle_stats *getSettleStats(uint8_t band) { return &stats.settle[(band < SETTLE_BANDS) ? band : SETTLE_BAND_FM]; };
+#endif
+
     void setup(uint8_t resetPin, uint8_t defaultFunction);
     void setup(uint8_t resetPin, int interruptPin, uint8_t defaultFunction, uint8_t audioMode = SI473X_ANALOG_AUDIO, uint8_t clockType = XOSCEN_CRYSTAL);
 
@@ -1156,7 +1990,20 @@ public:
         sendProperty(propertyNumber, param);
     };
 
+    /**
+     * @ingroup group10 Generic set and get property
+     * 
+     * @brief Starts a property batch
+     * 
+     * @details Use it to write several properties in sequence without the fixed delays of setProperty.
+     * 
+     * @see SI4735PropertyBatch
+     * @return SI4735PropertyBatch 
+     */
+    inline SI4735PropertyBatch beginProperties() { return SI4735PropertyBatch(this); };
+
     void sendCommand(uint8_t cmd, int parameter_size, const uint8_t *parameter);
+    void sendCommandResponse(uint8_t cmd, int parameter_size, const uint8_t *parameter, int response_size, uint8_t *response);
     void getCommandResponse(int num_of_bytes, uint8_t *response);
     si47x_status getStatusResponse();
 
@@ -1168,6 +2015,7 @@ public:
     void setFrequency(uint16_t);
 
     void getStatus(uint8_t, uint8_t);
+    void getStatus(uint8_t INTACK, uint8_t CANCEL, uint8_t fields);
 
     uint16_t getFrequency(void);
 
@@ -1407,6 +2255,7 @@ public:
     void setAutomaticGainControl(uint8_t AGCDIS, uint8_t AGCIDX);
 
     void getCurrentReceivedSignalQuality(uint8_t INTACK);
+    void getCurrentReceivedSignalQuality(uint8_t INTACK, uint8_t fields);
     void getCurrentReceivedSignalQuality(void);
 
     // AM and FM
@@ -2009,6 +2858,29 @@ public:
 
     void frequencyUp();
     void frequencyDown();
+    void queueFrequency(uint16_t freq);
+
+    /**
+     * @ingroup group08 Tune Frequency 
+     * @brief Enables or disables tune coalescing on frequencyUp and frequencyDown
+     * @details When enabled, frequencyUp and frequencyDown update the current frequency and return at once. The tune is sent by 
+     * @details queueFrequency: while a tune runs, new steps only move the target and just the last target is tuned after STC. 
+     * @details The radio follows a fast encoder spin without lagging behind it. Call service() from your loop().
+     * @see queueFrequency, service
+     * @param enable true = coalesce the tunes; false = frequencyUp and frequencyDown wait for each tune (default)
+     */
+    inline void setTuneCoalescing(bool enable) { tuneCoalescing = enable; };
+
+    /**
+     * @ingroup group08 Tune Frequency 
+     * @brief Enables the signal settle detection of setFrequency
+     * @details After STC, setFrequency reads the RSSI and SNR (RSQ status) every SETTLE_POLL_INTERVAL us until two readings 
+     * @details differ by tolerance dB or less. maxDelaySetFrequency (see setMaxDelaySetFrequency) is the upper bound of the whole tune. 
+     * @details Use it when the first readings after a tune (signal meter, AGC, scanning by RSSI) have to be stable.
+     * @see setFrequency, setMaxDelaySetFrequency, getSettleStats
+     * @param tolerance max RSSI and SNR change (dB) between two readings. 0 = disabled; setFrequency returns on STC (default).
+     */
+    inline void setSettleDetection(uint8_t tolerance) { settleTolerance = tolerance; };
 
     /**
      * @ingroup group08 Tune Frequency 
@@ -2232,6 +3104,9 @@ public:
     bool downloadPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size);
     void loadPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size, uint8_t ssb_audiobw = 1);
     si4735_eeprom_patch_header downloadPatchFromEeprom(int eeprom_i2c_address);
+    bool eepromWrite(uint8_t eeprom_i2c_address, uint16_t offset, const uint8_t *data, uint16_t size);
+    bool eepromRead(uint8_t eeprom_i2c_address, uint16_t offset, uint8_t *data, uint16_t size);
+    uint16_t getEepromPatchEnd(uint8_t eeprom_i2c_address);
     void ssbPowerUp();
 
     /**
@@ -2339,7 +3214,7 @@ public:
      */
     inline void setI2CLowSpeedMode(void)
     {
-        Wire.setClock(10000);
+        transport->setClock(10000);
     };
 
     /**
@@ -2347,7 +3222,7 @@ public:
      * 
      * @brief Sets I2C bus to 100kHz
      */
-    inline void setI2CStandardMode(void) { Wire.setClock(100000); };
+    inline void setI2CStandardMode(void) { transport->setClock(100000); };
 
     /**
      * @ingroup group18 MCU I2C Speed 
@@ -2356,7 +3231,7 @@ public:
      */
     inline void setI2CFastMode(void)
     {
-        Wire.setClock(400000);
+        transport->setClock(400000);
     };
 
     /**
@@ -2367,7 +3242,20 @@ public:
      * 
      * @param value in Hz. For example: The values 500000 sets the bus to 500kHz.
      */
-    inline void setI2CFastModeCustom(long value = 500000) { Wire.setClock(value); };
+    inline void setI2CFastModeCustom(long value = 500000) { transport->setClock(value); };
+
+    /**
+     * @ingroup group18 MCU I2C Speed 
+     * 
+     * @brief Enables or disables the I2C repeated start on the default transport (Arduino Wire library)
+     * 
+     * @details When enabled, status, RSQ, RDS, AGC and property reads send the command and read the response 
+     * @details in a single combined transaction (no STOP between them). Disabled by default. Check if your board Wire library supports it.  
+     * 
+     * @see sendCommandResponse
+     * @param value true or false
+     */
+    inline void setI2CRepeatedStart(bool value) { wireTransport.setRepeatedStart(value); };
 
     /**
      * @ingroup group18 MCU External Audio Mute  
@@ -2401,6 +3289,252 @@ public:
     inline void setHardwareAudioMute(bool on)
     {
         digitalWrite(audioMuteMcuPin, on);
-        delayMicroseconds(300);
+        waitMicroseconds(300);
     }
+
+    bool beginSetFrequency(uint16_t freq);
+    bool beginSeek(uint8_t up_down, uint8_t wrap = 1);
+    bool beginModeChange(uint8_t mode, uint16_t initialFreq = 0);
+    bool beginLoadPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size, uint8_t ssb_audiobw = 1);
+    bool beginBandScan(si4735_scan_channel *table, uint16_t size);
+    bool beginBandscope(uint16_t center, uint16_t span, si4735_bandscope_bin *bins, uint8_t count, void (*binFunc)(uint8_t bin, uint16_t freq, uint8_t rssi), uint8_t threshold = BANDSCOPE_THRESHOLD);
+    bool service();
+
+    /**
+     * @ingroup group21 Asynchronous commands
+     * @brief Checks if an asynchronous operation is running
+     * @see service
+     * @return true if an asynchronous operation is running
+     */
+    inline bool isAsyncBusy() { return asyncOperation != ASYNC_IDLE; };
+
+    /**
+     * @ingroup group21 Asynchronous commands
+     * @brief Gets the current asynchronous operation
+     * @return uint8_t ASYNC_IDLE, ASYNC_SET_FREQUENCY, ASYNC_SEEK, ASYNC_MODE_CHANGE, ASYNC_LOAD_PATCH, ASYNC_BAND_SCAN or ASYNC_BANDSCOPE
+     */
+    inline uint8_t getAsyncOperation() { return asyncOperation; };
+
+    /**
+     * @ingroup group21 Asynchronous commands
+     * @brief Gets the result of the last asynchronous operation
+     * @return uint8_t ASYNC_RESULT_NONE (still running), ASYNC_RESULT_DONE, ASYNC_RESULT_TIMEOUT or ASYNC_RESULT_CANCELED
+     */
+    inline uint8_t getAsyncResult() { return asyncResult; };
+
+    /**
+     * @ingroup group21 Asynchronous commands
+     * @brief Sets the function called when an asynchronous operation is done
+     * @details The function is called from service(). 
+     * @code
+     *   void radioDone(uint8_t operation, uint8_t result) {
+     *      if (operation == ASYNC_SET_FREQUENCY) showFrequency();
+     *   }
+     *   ...
+     *   rx.setAsyncCallback(radioDone);
+     * @endcode
+     * @param callback function with the operation (ASYNC_SET_FREQUENCY, ASYNC_SEEK, ...) and the result (ASYNC_RESULT_DONE or ASYNC_RESULT_TIMEOUT) parameters. NULL disables it.
+     */
+    inline void setAsyncCallback(void (*callback)(uint8_t operation, uint8_t result)) { asyncCallback = callback; };
+
+    bool cancelSeek();
+
+    /**
+     * @ingroup group21 Asynchronous commands
+     * @brief Sets the function called with the frequency being scanned during a seek (see beginSeek)
+     * @details service() reads the tune status (READFREQ, VALID and BLTF) while the seek runs and calls the function each time the frequency changes.
+     * @details The current frequency (getCurrentFrequency) follows the seek too.
+     * @param progress function with the frequency parameter. NULL disables it.
+     */
+    inline void setSeekProgressCallback(void (*progress)(uint16_t freq)) { seekProgressFunc = progress; };
+
+    bool cancelBandScan();
+
+    /**
+     * @ingroup group21 Band scan
+     * @brief Gets the number of channels already stored in the scan table (see beginBandScan)
+     * @details It grows while the scan runs. You can use it to show the scan progress.
+     * @return uint16_t number of channels
+     */
+    inline uint16_t getBandScanCount() { return scanCount; };
+
+    /**
+     * @ingroup group21 Band scan
+     * @brief Gets the frequency of a channel of the scan table
+     * @param index channel index (0 = first channel; the band minimum frequency)
+     * @return uint16_t frequency. For example, FM => 10390 = 103.9 MHz; AM => 810 = 810 kHz.
+     */
+    inline uint16_t getBandScanFrequency(uint16_t index) { return scanFirst + index * scanStep; };
+
+    /**
+     * @ingroup group21 Bandscope
+     * @brief Gets the frequency of a bandscope bin (see beginBandscope)
+     * @param bin bin index (0 to count - 1)
+     * @return uint16_t frequency. For example, FM => 10390 = 103.9 MHz; AM => 810 = 810 kHz.
+     */
+    inline uint16_t getBandscopeFrequency(uint8_t bin) { return (scopeCount > 1) ? scopeFirst + (uint16_t)((uint32_t)bin * scopeSpan / (scopeCount - 1)) : scopeFirst; };
+
+    /**
+     * @ingroup group21 Bandscope
+     * @brief Sets how long a bandscope sweep can keep the receiver away from the listened frequency
+     * @details The sweep is split into excursions. After maxOutage ms away, the listened frequency is tuned again 
+     * @details for listenTime ms before the next excursion. If the external mute circuit is used (see setAudioMuteMcuPin), 
+     * @details the audio is muted during the excursions.
+     * @param maxOutage max time (ms) away from the listened frequency (0 = sweeps all bins at once). Default BANDSCOPE_MAX_OUTAGE.
+     * @param listenTime time (ms) on the listened frequency between excursions. Default BANDSCOPE_LISTEN_TIME.
+     */
+    inline void setBandscopeOutage(uint16_t maxOutage, uint16_t listenTime)
+    {
+        scopeMaxOutage = maxOutage;
+        scopeListenTime = listenTime;
+    };
+
+    void setYieldHook(void (*yieldFunc)(uint32_t budget), uint16_t minTime = MIN_YIELD_TIME);
+
+    /**
+     * @ingroup group06 Yield hook
+     * @brief Gets the number of times the yield hook returned after the end of a wait
+     * @details Each overrun delays the library by the time the hook took beyond its budget.
+     * @see setYieldHook
+     * @return uint16_t number of overruns (up to 65535)
+     */
+    inline uint16_t getYieldOverruns() { return yieldOverruns; };
 };
+
+/**********************************************************************
+ * Radio service (RTOS targets)
+ **********************************************************************/
+
+// The radio service needs <atomic> (ESP32, STM32, ARM cores and host builds). It is not available on AVR.
+#if defined(__has_include)
+#if __has_include(<atomic>)
+#define SI4735_RADIO_SERVICE
+#endif
+#endif
+
+#ifdef SI4735_RADIO_SERVICE
+
+#include <atomic>
+
+#define RADIO_QUEUE_SIZE 16 // Number of requests the radio service queue can hold (power of two)
+
+#define RADIO_CMD_SET_FREQUENCY 1  // setFrequency(arg)
+#define RADIO_CMD_FREQUENCY_UP 2   // frequencyUp()
+#define RADIO_CMD_FREQUENCY_DOWN 3 // frequencyDown()
+#define RADIO_CMD_SEEK 4           // seekStationProgress(NULL, arg) - arg = SEEK_UP or SEEK_DOWN
+#define RADIO_CMD_SET_VOLUME 5     // setVolume(arg)
+#define RADIO_CMD_SET_FM 6         // setFM()
+#define RADIO_CMD_SET_AM 7         // setAM()
+#define RADIO_CMD_GET_FREQUENCY 8  // getFrequency() - reads the frequency from the device
+#define RADIO_CMD_GET_RSQ 9        // getCurrentReceivedSignalQuality() - fills rssi and snr
+#define RADIO_CMD_CALL 10          // Calls the request function with the SI4735 instance (any other method)
+
+#define RADIO_REQUEST_FREE 0     // The request was never submitted (or was reused)
+#define RADIO_REQUEST_QUEUED 1   // The request is in the queue
+#define RADIO_REQUEST_DONE 2     // The worker has executed the request
+#define RADIO_REQUEST_REJECTED 3 // The queue was full. The request was not queued.
+#define RADIO_REQUEST_CANCELED 4 // The request was withdrawn from the queue before the worker took it (see SI4735RadioService::cancel)
+
+class SI4735RadioService;
+
+/**
+ * @ingroup group22
+ *
+ * @brief Radio service request (a simple future)
+ *
+ * @details The task that submits the request owns it and must keep it alive until the worker no longer uses it: 
+ * @details until isDone() is true, or until wait() or SI4735RadioService::cancel returns. A request declared on the stack
+ * @details is safe with wait(): on timeout, wait withdraws it from the queue before returning.
+ * @details The worker fills the result fields (frequency, rssi, snr and currentVolume) after executing the command.
+ *
+ * @see SI4735RadioService
+ */
+class SI4735RadioRequest
+{
+public:
+    uint8_t command = 0;                                          //!< RADIO_CMD_SET_FREQUENCY, RADIO_CMD_GET_RSQ, ...
+    uint16_t arg = 0;                                             //!< Command argument (frequency, volume or seek direction)
+    void (*function)(SI4735 *rx, SI4735RadioRequest *req) = NULL; //!< Function called by RADIO_CMD_CALL
+    void (*callback)(SI4735RadioRequest *req) = NULL;             //!< Called by the worker after the command (optional)
+    void *user = NULL;                                            //!< User data (not used by the library)
+
+    uint16_t frequency = 0;    //!< Current frequency after the command
+    uint8_t rssi = 0;          //!< Current RSSI (RADIO_CMD_GET_RSQ)
+    uint8_t snr = 0;           //!< Current SNR (RADIO_CMD_GET_RSQ)
+    uint8_t currentVolume = 0; //!< Current volume after the command
+
+    std::atomic<uint8_t> state{RADIO_REQUEST_FREE}; //!< RADIO_REQUEST_FREE, RADIO_REQUEST_QUEUED, RADIO_REQUEST_DONE, RADIO_REQUEST_REJECTED or RADIO_REQUEST_CANCELED
+    SI4735RadioService *service = NULL;             //!< Service of the last submit (used by wait to withdraw the request)
+
+    /**
+     * @brief Checks if the worker has executed the request
+     * @return true if done. The result fields can be read.
+     */
+    inline bool isDone() { return state.load(std::memory_order_acquire) == RADIO_REQUEST_DONE; };
+
+    bool wait(uint32_t timeout = 0);
+};
+
+/**
+ * @ingroup group22
+ *
+ * @brief Thread-safe radio service
+ *
+ * @details The SI4735 class has no locking. If two tasks use the same instance at the same time, their I2C transactions corrupt each other.
+ * @details The radio service gives the SI4735 instance to a single worker task. Any other task (or interrupt) submits requests to a 
+ * @details bounded lock-free queue (multiple producers, one consumer) and gets the result through the request itself (isDone/wait) or a callback.
+ * @details The worker calls run() in its loop. run() executes the queued requests in order and also drives the non-blocking 
+ * @details command engine (SI4735::service).
+ *
+ * @code
+ *   SI4735 rx;
+ *   SI4735RadioService radio(&rx);
+ *
+ *   void radioTask(void *p) {           // The only task that uses rx
+ *      rx.setup(RESET_PIN, FM_FUNCTION);
+ *      for (;;) {
+ *         if (!radio.run()) vTaskDelay(1);
+ *      }
+ *   }
+ *
+ *   void touchTask(void *p) {
+ *      SI4735RadioRequest req;          // On the stack: wait() does not return while the worker can still use it
+ *      req.command = RADIO_CMD_GET_RSQ;
+ *      if (radio.submit(&req) && req.wait(100)) 
+ *          showRSSI(req.rssi);
+ *      ...
+ *   }
+ * @endcode
+ *
+ * @details A request submitted without wait (for example, with a callback) must outlive its execution (static or global storage), 
+ * @details or be withdrawn with cancel before it is destroyed.
+ *
+ * @see SI4735RadioRequest
+ */
+class SI4735RadioService
+{
+protected:
+    SI4735 *rx;
+
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence;
+        std::atomic<SI4735RadioRequest *> request; //!< NULL once the worker has taken the request or cancel has withdrawn it
+    } slots[RADIO_QUEUE_SIZE];
+
+    std::atomic<uint32_t> head{0}; //!< Next slot to be written by a producer
+    uint32_t tail = 0;             //!< Next slot to be read by the worker
+
+    void execute(SI4735RadioRequest *req);
+
+public:
+    SI4735RadioService(SI4735 *rx);
+    bool submit(SI4735RadioRequest *req);
+    bool submit(SI4735RadioRequest *req, uint8_t command, uint16_t arg = 0, void (*callback)(SI4735RadioRequest *req) = NULL);
+    bool cancel(SI4735RadioRequest *req);
+    bool run();
+};
+
+#endif
+
+#endif // _SI4735_H
@@ -0,0 +1,156 @@
+/**
+ * @brief Arduino core shim for host builds - virtual clock implementation
+ *
+ * @see Arduino.h (extras/HOST)
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <atomic>
+#include <thread>
+
+#define HOST_MAX_INTERRUPTS 64
+
+HostSerial Serial;
+TwoWire Wire;
+TwoWire Wire1;
+
+// The clock is atomic: threaded host tests (see radio_test.cpp) read it from several threads.
+static std::atomic<uint64_t> hostClock{0};              // Virtual time in uS
+static uint32_t callCost = HOST_DEFAULT_CALL_COST;      // Time spent by micros() and millis()
+static std::atomic<uint32_t> delayCalls{0};             // Calls to delay and delayMicroseconds
+static void (*pinHandler)(uint8_t pin, uint8_t value) = NULL;
+static void (*interruptHandler[HOST_MAX_INTERRUPTS])(void);
+static bool interruptsEnabled = true;
+
+/**
+ * @brief Sets the virtual clock to zero
+ */
+void hostResetClock()
+{
+    hostClock = 0;
+    delayCalls = 0;
+}
+
+/**
+ * @brief Advances the virtual clock (time spent by code that is not a delay)
+ * @param us microseconds
+ */
+void hostAdvanceClock(uint32_t us)
+{
+    hostClock += us;
+}
+
+/**
+ * @brief Gets the virtual clock (64 bits; micros() wraps like on the MCU)
+ * @return uint64_t microseconds since the start (or since hostResetClock)
+ */
+uint64_t hostGetClock()
+{
+    return hostClock;
+}
+
+/**
+ * @brief Sets the time spent by each call to micros() and millis()
+ * @details Zero makes reading the clock free. Then, a loop that only polls the clock never ends.
+ * @param us microseconds (default HOST_DEFAULT_CALL_COST)
+ */
+void hostSetCallCost(uint32_t us)
+{
+    callCost = us;
+}
+
+/**
+ * @brief Gets the number of calls to delay and delayMicroseconds since hostResetClock
+ */
+uint32_t hostGetDelayCalls()
+{
+    return delayCalls;
+}
+
+/**
+ * @brief Sets a function called on each digitalWrite (for example, to reset a simulated device)
+ */
+void hostSetPinHandler(void (*handler)(uint8_t pin, uint8_t value))
+{
+    pinHandler = handler;
+}
+
+/**
+ * @brief Calls the handler attached to an interrupt (simulates an edge on the pin)
+ * @param interrupt value returned by digitalPinToInterrupt
+ */
+void hostRaiseInterrupt(int interrupt)
+{
+    if (interruptsEnabled && interrupt >= 0 && interrupt < HOST_MAX_INTERRUPTS && interruptHandler[interrupt] != NULL)
+        interruptHandler[interrupt]();
+}
+
+unsigned long micros()
+{
+    return (uint32_t)(hostClock += callCost);
+}
+
+unsigned long millis()
+{
+    return (uint32_t)((hostClock += callCost) / 1000);
+}
+
+void delay(unsigned long ms)
+{
+    delayCalls++;
+    hostClock += (uint64_t)ms * 1000;
+    std::this_thread::yield(); // Gives the CPU to the other threads (like vTaskDelay on FreeRTOS)
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    delayCalls++;
+    hostClock += us;
+}
+
+void yield()
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pinHandler != NULL)
+        pinHandler(pin, value);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return LOW;
+}
+
+int digitalPinToInterrupt(int pin)
+{
+    return (pin >= 0 && pin < HOST_MAX_INTERRUPTS) ? pin : -1;
+}
+
+void attachInterrupt(int interrupt, void (*handler)(void), int mode)
+{
+    if (interrupt >= 0 && interrupt < HOST_MAX_INTERRUPTS)
+        interruptHandler[interrupt] = handler;
+}
+
+void detachInterrupt(int interrupt)
+{
+    if (interrupt >= 0 && interrupt < HOST_MAX_INTERRUPTS)
+        interruptHandler[interrupt] = NULL;
+}
+
+void interrupts()
+{
+    interruptsEnabled = true;
+}
+
+void noInterrupts()
+{
+    interruptsEnabled = false;
+}
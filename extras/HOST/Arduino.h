@@ -0,0 +1,103 @@
+/**
+ * @brief Arduino core shim for host builds (Linux, macOS) with a virtual clock
+ *
+ * @details This file replaces Arduino.h when the SI4735 library is built on a developer machine (see Makefile).
+ * @details delay, delayMicroseconds, millis and micros do not use the real clock. The delays advance a virtual clock and
+ * @details return at once. So, a full band scan or a full patch download runs in milliseconds and the virtual time
+ * @details reported by micros() is the time the MCU would spend (bus and device times come from the transport, see extras/SIMULATOR).
+ * @details Each call to micros() or millis() also advances the virtual clock by a small cost (see hostSetCallCost).
+ * @details This way, loops that just poll the clock always end.
+ *
+ * @see extras/HOST/README.md
+ */
+
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_ARDUINO 1
+#define HOST_DEFAULT_CALL_COST 1 // In uS - time spent by each call to micros() or millis()
+
+// The library uses the register keyword (removed in C++17)
+#define register
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define B00000000 0x00
+#define B00000001 0x01
+#define B00000101 0x05
+#define B00001011 0x0B
+#define B01000000 0x40
+#define B10000000 0x80
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_byte_near(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define F(str) (str)
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+unsigned long micros();
+unsigned long millis();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int interrupt, void (*handler)(void), int mode);
+void detachInterrupt(int interrupt);
+void interrupts();
+void noInterrupts();
+
+/**
+ * @brief Minimal Serial (writes to stdout)
+ */
+class HostSerial
+{
+public:
+    void begin(unsigned long baud) {};
+    void flush() { fflush(stdout); };
+    size_t print(const char *s) { return printf("%s", s); };
+    size_t print(char c) { return printf("%c", c); };
+    size_t print(int n) { return printf("%d", n); };
+    size_t print(unsigned n) { return printf("%u", n); };
+    size_t print(long n) { return printf("%ld", n); };
+    size_t print(unsigned long n) { return printf("%lu", n); };
+    size_t print(double n, int digits = 2) { return printf("%.*f", digits, n); };
+    template <typename T>
+    size_t println(T v) { return print(v) + printf("\n"); };
+    size_t println() { return printf("\n"); };
+    operator bool() { return true; };
+};
+
+extern HostSerial Serial;
+
+// Host only functions (virtual clock and pins)
+void hostResetClock();
+void hostAdvanceClock(uint32_t us);
+uint64_t hostGetClock();
+void hostSetCallCost(uint32_t us);
+uint32_t hostGetDelayCalls();
+void hostSetPinHandler(void (*handler)(uint8_t pin, uint8_t value));
+void hostRaiseInterrupt(int interrupt);
+
+#endif
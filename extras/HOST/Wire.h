@@ -0,0 +1,29 @@
+/**
+ * @brief Wire (TwoWire) shim for host builds
+ *
+ * @details There is no device on this bus: every address is NACKed and reads return 0xFF.
+ * @details Use a SI4735Transport (for example, SI4735Simulator) to reach a simulated device.
+ */
+
+#ifndef _HOST_WIRE_H
+#define _HOST_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire
+{
+public:
+    void begin() {};
+    void setClock(uint32_t frequency) {};
+    void beginTransmission(uint8_t address) {};
+    size_t write(uint8_t data) { return 1; };
+    uint8_t endTransmission(bool stop = true) { return 2; }; // NACK on address
+    uint8_t requestFrom(uint8_t address, uint8_t size) { return 0; };
+    int available() { return 0; };
+    int read() { return -1; };
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
@@ -0,0 +1,255 @@
+/**
+ * @brief SI4735 library benchmark (host build, virtual clock)
+ *
+ * @details Drives the public API against the simulated device and reports, for each operation, the virtual time (the time
+ * @details the MCU would spend), the bus transactions and bytes, the commands sent and the CTS polls.
+ * @details The result is deterministic. Keep the report of each release and compare them to see if a change makes the
+ * @details radio faster or slower.
+ * @details Build and run: make bench (JSON report on stdout). Use "./benchmark -c" for a CSV report.
+ * @details The library is built with SI4735_STATS (see Makefile); the CTS polls come from SI4735::getStats.
+ */
+
+#include <SI4735.h>
+#include "SI4735Simulator.h"
+#include "patch_init.h"
+
+#define EEPROM_I2C_ADDR 0x50
+#define EEPROM_SIZE 32768
+#define MAX_RESULTS 16
+
+// RDS: PS "PU2CLR  " (group 0A) and radio text "SI4735 SIMULATOR\r" (group 2A). PI = 0x1234; PTY = 10.
+const uint16_t rdsGroups[] = {
+    0x1234, 0x0540, 0xE0CD, 0x5055,
+    0x1234, 0x0541, 0xE0CD, 0x3243,
+    0x1234, 0x0542, 0xE0CD, 0x4C52,
+    0x1234, 0x0543, 0xE0CD, 0x2020,
+    0x1234, 0x2540, 0x5349, 0x3437,
+    0x1234, 0x2541, 0x3335, 0x2053,
+    0x1234, 0x2542, 0x494D, 0x554C,
+    0x1234, 0x2543, 0x4154, 0x4F52,
+    0x1234, 0x2544, 0x0D20, 0x2020};
+
+const si4735_sim_station band[] = {
+    {8990, SIM_FM, 40, 22, 5, NULL, 0},
+    {9390, SIM_FM, 45, 25, 5, rdsGroups, 9},
+    {10170, SIM_FM, 30, 12, 20, NULL, 0},
+    {10390, SIM_FM, 38, 20, 10, NULL, 0},
+    {810, SIM_AM, 40, 22, 0, NULL, 0},
+    {7100, SIM_AM, 35, 15, 0, NULL, 0}};
+
+/**
+ * @brief Measure of one operation
+ */
+typedef struct
+{
+    const char *name;
+    uint32_t iterations;
+    uint64_t time;         // Virtual time (us)
+    uint32_t transactions; // Device write and read transactions
+    uint32_t bytesWritten; // Device bytes written
+    uint32_t bytesRead;    // Device bytes read
+    uint32_t eepromBytes;  // EEPROM bytes (addresses included)
+    uint32_t commands;     // Commands executed by the device (patch lines not included)
+    uint32_t patchLines;   // Patch lines received by the device
+    uint32_t ctsPolls;     // Status reads done while waiting for CTS
+} bench_result;
+
+SI4735Simulator chip;
+SI4735 rx;
+uint8_t eeprom[EEPROM_SIZE];
+
+bench_result results[MAX_RESULTS];
+uint8_t resultCount = 0;
+
+bench_result *current;
+uint64_t startTime;
+si4735_sim_counters startCounters;
+uint32_t startPolls;
+
+/**
+ * @brief Starts measuring an operation (or continues measuring it after an unmeasured part)
+ */
+void measureStart()
+{
+    startCounters = *chip.getCounters();
+    startPolls = rx.getStats()->ctsPolls;
+    startTime = hostGetClock();
+}
+
+/**
+ * @brief Stops measuring and adds the measure to the current operation
+ */
+void measureStop()
+{
+    uint64_t time = hostGetClock() - startTime;
+    const si4735_sim_counters *c = chip.getCounters();
+
+    current->time += time;
+    current->transactions += (c->writes - startCounters.writes) + (c->reads - startCounters.reads);
+    current->bytesWritten += c->bytesWritten - startCounters.bytesWritten;
+    current->bytesRead += c->bytesRead - startCounters.bytesRead;
+    current->eepromBytes += c->eepromBytes - startCounters.eepromBytes;
+    current->commands += c->commands - startCounters.commands;
+    current->patchLines += c->patchLines - startCounters.patchLines;
+    current->ctsPolls += rx.getStats()->ctsPolls - startPolls;
+}
+
+void begin(const char *name, uint32_t iterations)
+{
+    current = &results[resultCount++];
+    memset(current, 0, sizeof *current);
+    current->name = name;
+    current->iterations = iterations;
+}
+
+/**
+ * @brief Powers up the device in FM mode (not measured)
+ */
+void startFM(uint16_t freq)
+{
+    rx.setFM(8750, 10790, freq, 10);
+    delay(100);
+}
+
+void benchModeChange()
+{
+    startFM(10390);
+    begin("setAM", 1);
+    measureStart();
+    rx.setAM(520, 1710, 810, 10);
+    measureStop();
+
+    begin("setFM", 1);
+    measureStart();
+    rx.setFM(8750, 10790, 10390, 10);
+    measureStop();
+
+    begin("loadPatch", 1);
+    measureStart();
+    rx.loadPatch(ssb_patch_content, sizeof ssb_patch_content);
+    measureStop();
+
+    begin("setSSB", 1);
+    measureStart();
+    rx.setSSB(7000, 7200, 7100, 1, LSB_MODE);
+    measureStop();
+}
+
+void benchTune()
+{
+    startFM(8750);
+    begin("setFrequency", 100);
+    measureStart();
+    for (uint16_t i = 0; i < 100; i++)
+        rx.setFrequency(8750 + i * 20);
+    measureStop();
+
+    startFM(8750);
+    begin("frequencyUp", 100);
+    measureStart();
+    for (uint16_t i = 0; i < 100; i++)
+        rx.frequencyUp();
+    measureStop();
+
+    startFM(8750);
+    begin("seekStationProgress", 1);
+    measureStart();
+    rx.seekStationProgress(NULL, SEEK_UP);
+    measureStop();
+
+    startFM(10390);
+    begin("getCurrentReceivedSignalQuality", 100);
+    measureStart();
+    for (uint16_t i = 0; i < 100; i++)
+        rx.getCurrentReceivedSignalQuality();
+    measureStop();
+}
+
+/**
+ * @brief RDS polling: one getRdsStatus and the text decode every 40ms (the wait is not measured)
+ */
+void benchRds()
+{
+    startFM(9390);
+    rx.setRdsConfig(1, 2, 2, 2, 2);
+    begin("getRdsStatus+text", 100);
+    for (uint16_t i = 0; i < 100; i++)
+    {
+        delay(40);
+        measureStart();
+        rx.getRdsStatus();
+        if (rx.getRdsReceived() && rx.getRdsSync())
+        {
+            rx.getRdsText0A();
+            rx.getRdsText2A();
+        }
+        measureStop();
+    }
+}
+
+void benchEeprom()
+{
+    si4735_eeprom_patch_header header;
+
+    memset(&header, 0, sizeof header);
+    strcpy((char *)header.refined.patch_id, "SSB_PATCH_INIT");
+    header.refined.patch_size = sizeof ssb_patch_content;
+    memcpy(eeprom, header.raw, sizeof header);
+    memcpy(eeprom + sizeof header, ssb_patch_content, sizeof ssb_patch_content);
+    chip.attachEeprom(EEPROM_I2C_ADDR, eeprom, EEPROM_SIZE);
+
+    startFM(10390);
+    begin("downloadPatchFromEeprom", 1);
+    measureStart();
+    rx.queryLibraryId();
+    rx.patchPowerUp();
+    delay(50);
+    rx.downloadPatchFromEeprom(EEPROM_I2C_ADDR);
+    measureStop();
+}
+
+void printJson()
+{
+    printf("{\n  \"unit\": \"us\",\n  \"results\": [\n");
+    for (uint8_t i = 0; i < resultCount; i++)
+    {
+        bench_result *r = &results[i];
+        printf("    {\"operation\": \"%s\", \"iterations\": %u, \"time\": %llu, \"time_per_iteration\": %llu, "
+               "\"transactions\": %u, \"bytes_written\": %u, \"bytes_read\": %u, \"eeprom_bytes\": %u, "
+               "\"commands\": %u, \"patch_lines\": %u, \"cts_polls\": %u}%s\n",
+               r->name, r->iterations, (unsigned long long)r->time, (unsigned long long)(r->time / r->iterations),
+               r->transactions, r->bytesWritten, r->bytesRead, r->eepromBytes, r->commands, r->patchLines, r->ctsPolls,
+               (i < resultCount - 1) ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+void printCsv()
+{
+    printf("operation,iterations,time,time_per_iteration,transactions,bytes_written,bytes_read,eeprom_bytes,commands,patch_lines,cts_polls\n");
+    for (uint8_t i = 0; i < resultCount; i++)
+    {
+        bench_result *r = &results[i];
+        printf("%s,%u,%llu,%llu,%u,%u,%u,%u,%u,%u,%u\n", r->name, r->iterations, (unsigned long long)r->time,
+               (unsigned long long)(r->time / r->iterations), r->transactions, r->bytesWritten, r->bytesRead,
+               r->eepromBytes, r->commands, r->patchLines, r->ctsPolls);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    chip.setStations(band, sizeof band / sizeof band[0]);
+    rx.setTransport(&chip);
+    rx.setup(12, POWER_UP_FM);
+
+    benchModeChange();
+    benchTune();
+    benchRds();
+    benchEeprom();
+
+    if (argc > 1 && strcmp(argv[1], "-c") == 0)
+        printCsv();
+    else
+        printJson();
+    return 0;
+}
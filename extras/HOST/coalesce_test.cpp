@@ -0,0 +1,197 @@
+/**
+ * @brief Tune coalescing test (frequencyUp and queueFrequency while a tune, band scan, bandscope or seek is running)
+ *
+ * @details The knob target must be getCurrentFrequency at once and must be the frequency tuned when the running operation is
+ * @details done. The running operation must not be disturbed by the target: the band scan table and the bandscope bins keep
+ * @details their own frequencies (the bandscope callback gets the frequency of each bin), and only the last target is sent.
+ *
+ * @details Build and run: make coalesce-check
+ */
+
+#define TEST_NAME "coalesce"
+
+#include "host_test.h"
+
+#define SCOPE_BINS 15
+
+/**
+ * @brief Counts the tune commands sent to the simulator
+ */
+class TuneCounter : public SI4735Transport
+{
+public:
+    unsigned tunes = 0;
+    uint16_t lastTune = 0;
+
+    uint8_t write(uint8_t address, const uint8_t *data, uint8_t size)
+    {
+        if (data[0] == FM_TUNE_FREQ && size >= 4)
+        {
+            tunes++;
+            lastTune = ((uint16_t)data[2] << 8) | data[3];
+        }
+        return chip.write(address, data, size);
+    }
+    uint8_t read(uint8_t address, uint8_t *data, uint8_t size) { return chip.read(address, data, size); }
+    void waitMicroseconds(uint32_t us) { chip.waitMicroseconds(us); }
+};
+
+const si4735_sim_station band[] = {
+    {9390, SIM_FM, 45, 25, 5, NULL, 0},
+    {10370, SIM_FM, 30, 15, 10, NULL, 0},
+    {10390, SIM_FM, 38, 20, 10, NULL, 0}};
+
+TuneCounter counter;
+si4735_scan_channel table[210];
+si4735_bandscope_bin bins[SCOPE_BINS];
+uint16_t binFrequency[SCOPE_BINS];
+unsigned binCalls = 0;
+uint8_t lastOperation, lastResult;
+
+void onBin(uint8_t bin, uint16_t freq, uint8_t rssi)
+{
+    (void)rssi;
+    if (bin < SCOPE_BINS)
+        binFrequency[bin] = freq;
+    binCalls++;
+}
+
+void onDone(uint8_t operation, uint8_t result)
+{
+    lastOperation = operation;
+    lastResult = result;
+}
+
+/**
+ * @brief Runs service() until the library is idle (virtual time goes by 100 us per call)
+ */
+void runUntilIdle()
+{
+    for (int i = 0; i < 200000 && rx.service(); i++)
+        delayMicroseconds(100);
+}
+
+/**
+ * @brief Runs service() n times (virtual time goes by 100 us per call)
+ */
+void run(int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        rx.service();
+        delayMicroseconds(100);
+    }
+}
+
+void testTunes()
+{
+    rx.setFrequency(10390);
+    counter.tunes = 0;
+
+    // Ten steps while the first tune runs: the first one is sent at once, the last one when it is done
+    for (int i = 0; i < 10; i++)
+        rx.frequencyUp();
+    CHECK(rx.getCurrentFrequency() == 10490);
+    runUntilIdle();
+    CHECK(counter.tunes == 2);
+    CHECK(counter.lastTune == 10490);
+    CHECK(chip.getFrequency() == 10490);
+    CHECK(rx.getCurrentFrequency() == 10490);
+}
+
+void testBandScan()
+{
+    rx.setFrequency(10390);
+    CHECK(rx.beginBandScan(table, 210));
+    run(50);
+    rx.queueFrequency(9390); // The knob moves during the scan
+    CHECK(rx.getCurrentFrequency() == 9390);
+    run(50);
+    CHECK(rx.getCurrentFrequency() == 9390);
+    runUntilIdle();
+
+    CHECK(rx.getBandScanCount() == 205); // 87.5 to 107.9 MHz
+    CHECK(rx.getBandScanFrequency(0) == 8750);
+    CHECK(table[(9390 - 8750) / 10].valid && table[(10390 - 8750) / 10].valid);
+    CHECK(!table[(9400 - 8750) / 10].valid);
+    CHECK(chip.getFrequency() == 9390);
+    CHECK(rx.getCurrentFrequency() == 9390);
+}
+
+void testBandscope()
+{
+    rx.setFrequency(10390);
+    rx.setBandscopeOutage(0, 0); // One excursion
+    memset(binFrequency, 0, sizeof binFrequency);
+    binCalls = 0;
+
+    CHECK(rx.beginBandscope(10390, 70, bins, SCOPE_BINS, onBin));
+    run(3);
+    rx.frequencyUp(); // The knob moves during the sweep
+    CHECK(rx.getCurrentFrequency() == 10400);
+    runUntilIdle();
+
+    CHECK(binCalls == SCOPE_BINS); // The first sweep delivers every bin
+    for (uint8_t i = 0; i < SCOPE_BINS; i++)
+    {
+        if (binFrequency[i] != rx.getBandscopeFrequency(i))
+        {
+            printf("coalesce: bin %u delivered as %u (expected %u)\n", i, binFrequency[i], rx.getBandscopeFrequency(i));
+            failures++;
+        }
+    }
+    CHECK(rx.getBandscopeFrequency(0) == 10355 && rx.getBandscopeFrequency(SCOPE_BINS - 1) == 10425);
+    CHECK(chip.getFrequency() == 10400);
+    CHECK(rx.getCurrentFrequency() == 10400);
+
+    // Excursions with the listened frequency tuned between them
+    rx.setBandscopeOutage(2, 1);
+    memset(binFrequency, 0, sizeof binFrequency);
+    CHECK(rx.beginBandscope(10390, 70, bins, SCOPE_BINS, onBin, 0));
+    run(5);
+    rx.frequencyDown();
+    runUntilIdle();
+    for (uint8_t i = 0; i < SCOPE_BINS; i++)
+        CHECK(binFrequency[i] == rx.getBandscopeFrequency(i));
+    CHECK(chip.getFrequency() == 10390);
+    CHECK(rx.getCurrentFrequency() == 10390);
+}
+
+void testSeek()
+{
+    rx.setFrequency(8800);
+    CHECK(rx.beginSeek(SEEK_UP, 1));
+    run(20);
+    rx.queueFrequency(10000); // The knob moves during the seek
+    CHECK(rx.getCurrentFrequency() == 10000);
+    run(20);
+    CHECK(rx.getCurrentFrequency() == 10000); // The seek progress does not replace the target
+    runUntilIdle();
+
+    CHECK(lastOperation == ASYNC_SET_FREQUENCY && lastResult == ASYNC_RESULT_DONE);
+    CHECK(chip.getFrequency() == 10000);
+    CHECK(rx.getCurrentFrequency() == 10000);
+
+    // Without a target, the seek result is the current frequency
+    CHECK(rx.beginSeek(SEEK_UP, 1));
+    runUntilIdle();
+    CHECK(lastOperation == ASYNC_SEEK && lastResult == ASYNC_RESULT_DONE);
+    CHECK(chip.getFrequency() == 10370 && rx.getCurrentFrequency() == 10370);
+}
+
+int main()
+{
+    hostTestSetup();
+    chip.setStations(band, sizeof band / sizeof band[0]);
+    rx.setTransport(&counter);
+    rx.setFM(8750, 10790, 10390, 10);
+    rx.setTuneCoalescing(true);
+    rx.setAsyncCallback(onDone);
+
+    testTunes();
+    testBandScan();
+    testBandscope();
+    testSeek();
+
+    return hostTestResult();
+}
@@ -0,0 +1,205 @@
+/**
+ * @brief SI4735 library fuzz harness (response parsing and RDS decoding)
+ *
+ * @details Feeds arbitrary device responses (si47x_response_status, si47x_rds_status, AGC, firmware and RSQ payloads)
+ * @details through the library. The input is split into operations: the first byte chooses the call, the next bytes are
+ * @details the bytes the device "answers" on the bus. The CTS bit is always set (a device that never sets CTS would
+ * @details just hang the library, which is not what this harness looks for).
+ *
+ * @details libFuzzer: make fuzz-libfuzzer (needs clang) and then ./fuzz_libfuzzer corpus_dir
+ * @details AFL:       CXX=afl-g++ make fuzz and then afl-fuzz -i seeds -o out ./fuzz
+ * @details Offline:   make fuzz-check (ASan and UBSan; runs the files given as arguments or N pseudo-random inputs)
+ */
+
+#include <SI4735.h>
+#include "SI4735Simulator.h"
+
+/**
+ * @brief Transport that answers every read with the fuzz input
+ */
+class FuzzTransport : public SI4735Transport
+{
+public:
+    const uint8_t *data = NULL;
+    size_t size = 0;
+
+    uint8_t write(uint8_t address, const uint8_t *data, uint8_t size) { return 0; };
+    uint8_t read(uint8_t address, uint8_t *buffer, uint8_t count)
+    {
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (size > 0)
+            {
+                buffer[i] = *data++;
+                size--;
+            }
+            else
+                buffer[i] = 0;
+        }
+        if (count > 0)
+            buffer[0] |= 0x80; // CTS
+        return count;
+    };
+};
+
+/**
+ * @brief Exposes the protected parts used by the harness
+ */
+class FuzzSI4735 : public SI4735
+{
+public:
+    using SI4735::clearRdsBuffer0A;
+    using SI4735::clearRdsBuffer2A;
+    using SI4735::clearRdsBuffer2B;
+    using SI4735::getInterruptStatus;
+};
+
+static SI4735Simulator chip;
+static FuzzTransport fuzz;
+static FuzzSI4735 rx;
+
+/**
+ * @brief Uses the returned strings (ASan checks the whole string, up to the terminator)
+ */
+static void use(const char *s)
+{
+    if (s != NULL)
+    {
+        volatile size_t n = strlen(s);
+        (void)n;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static bool started = false;
+
+    if (!started)
+    {
+        rx.setTransport(&chip);
+        rx.setup(12, POWER_UP_FM);
+        rx.setFM(8750, 10790, 10390, 10);
+        started = true;
+    }
+
+    rx.setTransport(&fuzz);
+    rx.clearRdsBuffer0A();
+    rx.clearRdsBuffer2A();
+    rx.clearRdsBuffer2B();
+
+    fuzz.data = data;
+    fuzz.size = size;
+    while (fuzz.size > 0)
+    {
+        uint8_t op = *fuzz.data++;
+        fuzz.size--;
+        switch (op % 10)
+        {
+        case 0:
+        case 1:
+        case 2:
+            rx.getRdsStatus();
+            rx.getRdsPI();
+            rx.getRdsGroupType();
+            rx.getRdsVersionCode();
+            rx.getRdsProgramType();
+            use(rx.getRdsText0A());
+            use(rx.getRdsText2A());
+            use(rx.getRdsText2B());
+            use(rx.getRdsTime());
+            break;
+        case 3:
+            rx.getRdsStatus((op >> 4) & 1, (op >> 5) & 1, (op >> 6) & 1);
+            use(rx.getRdsText());
+            break;
+        case 4:
+            rx.getStatus(op & 1, (op >> 1) & 1);
+            rx.getFrequency();
+            rx.getTuneCompleteTriggered();
+            rx.getReceivedSignalStrengthIndicator();
+            rx.getStatusSNR();
+            rx.getAntennaTuningCapacitor();
+            break;
+        case 5:
+            rx.getCurrentReceivedSignalQuality();
+            rx.getCurrentRSSI();
+            rx.getCurrentSNR();
+            rx.getCurrentPilot();
+            rx.getCurrentStereoBlend();
+            rx.getCurrentMultipath();
+            rx.getCurrentSignedFrequencyOffset();
+            break;
+        case 6:
+            rx.getAutomaticGainControl();
+            rx.isAgcEnabled();
+            rx.getAgcGainIndex();
+            break;
+        case 7:
+            rx.getFirmware();
+            rx.getFirmwarePN();
+            rx.getFirmwareCHIPREV();
+            break;
+        case 8:
+            rx.getCurrentReceivedSignalQuality(op & 1);
+            break;
+        case 9:
+            rx.getInterruptStatus();
+            break;
+        }
+    }
+    return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+
+#include <stdio.h>
+
+/**
+ * @brief Standalone driver: runs each file given as argument, N pseudo-random inputs ("-n N") or stdin (AFL)
+ */
+int main(int argc, char **argv)
+{
+    static uint8_t buffer[65536];
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0)
+    {
+        uint32_t seed = 1;
+        long count = atol(argv[2]);
+        for (long i = 0; i < count; i++)
+        {
+            size_t size = 0;
+            seed = seed * 1103515245 + 12345;
+            size = (seed >> 16) % 512;
+            for (size_t k = 0; k < size; k++)
+            {
+                seed = seed * 1103515245 + 12345;
+                buffer[k] = seed >> 16;
+            }
+            LLVMFuzzerTestOneInput(buffer, size);
+        }
+        printf("fuzz: %ld inputs\n", count);
+        return 0;
+    }
+
+    if (argc == 1)
+    {
+        size_t size = fread(buffer, 1, sizeof buffer, stdin);
+        return LLVMFuzzerTestOneInput(buffer, size);
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        FILE *f = fopen(argv[i], "rb");
+        if (f == NULL)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+        size_t size = fread(buffer, 1, sizeof buffer, f);
+        fclose(f);
+        LLVMFuzzerTestOneInput(buffer, size);
+    }
+    return 0;
+}
+
+#endif
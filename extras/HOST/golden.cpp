@@ -0,0 +1,107 @@
+/**
+ * @brief SI4735 library golden bus transactions (host build, virtual clock)
+ *
+ * @details Runs a set of scenarios against the simulated device and prints every I2C transaction (time, type, address
+ * @details and bytes; see extras/TRACE) of each public method. The output is compared with golden.trace by "make golden".
+ * @details Any change that adds, removes or changes bus traffic or waits shows up as a diff. If the change is intended,
+ * @details run "make golden-update" and commit the new golden.trace together with the change.
+ * @details Times are relative to the start of each method, so a new wait in one method does not change the others.
+ */
+
+#include <SI4735.h>
+#include "SI4735Simulator.h"
+#include "SI4735Trace.h"
+#include "patch_init.h"
+
+const si4735_sim_station band[] = {
+    {9390, SIM_FM, 45, 25, 5, NULL, 0},
+    {10390, SIM_FM, 38, 20, 10, NULL, 0},
+    {810, SIM_AM, 40, 22, 0, NULL, 0},
+    {7100, SIM_AM, 35, 15, 0, NULL, 0}};
+
+void printLine(const char *line)
+{
+    printf("%s\n", line);
+}
+
+SI4735Simulator chip;
+SI4735TraceRecorder recorder(&chip, printLine);
+SI4735 rx;
+
+/**
+ * @brief Starts a new scenario step. The trace time starts again at 0.
+ */
+void step(const char *name)
+{
+    printf("## %s\n", name);
+    recorder.restart();
+    recorder.setEnabled(true);
+}
+
+/**
+ * @brief Runs code without printing its transactions (setup of the next step)
+ */
+void quiet()
+{
+    recorder.setEnabled(false);
+}
+
+int main()
+{
+    chip.setStations(band, sizeof band / sizeof band[0]);
+    rx.setTransport(&recorder);
+
+    step("setup");
+    rx.setup(12, POWER_UP_FM);
+
+    // FM
+    step("setFM");
+    rx.setFM(8750, 10790, 10390, 10);
+    step("setFrequency FM");
+    rx.setFrequency(9390);
+    step("frequencyUp FM");
+    rx.frequencyUp();
+    step("getCurrentReceivedSignalQuality FM");
+    rx.getCurrentReceivedSignalQuality();
+    step("getFrequency FM");
+    rx.getFrequency();
+    step("seekStationUp FM");
+    rx.seekStationUp();
+    step("setVolume");
+    rx.setVolume(45);
+    step("setRdsConfig");
+    rx.setRdsConfig(1, 2, 2, 2, 2);
+    step("getRdsStatus");
+    rx.getRdsStatus();
+
+    // AM
+    step("setAM");
+    rx.setAM(520, 1710, 810, 10);
+    step("setFrequency AM");
+    rx.setFrequency(1000);
+    step("frequencyDown AM");
+    rx.frequencyDown();
+    step("setBandwidth AM");
+    rx.setBandwidth(2, 1);
+    step("getCurrentReceivedSignalQuality AM");
+    rx.getCurrentReceivedSignalQuality();
+    step("setAutomaticGainControl AM");
+    rx.setAutomaticGainControl(1, 10);
+
+    // SSB (the patch lines are not printed; the patch download is covered by its line count)
+    quiet();
+    rx.loadPatch(ssb_patch_content, sizeof ssb_patch_content);
+    printf("## loadPatch\n%u patch lines\n", chip.getPatchLines());
+    step("setSSB");
+    rx.setSSB(7000, 7200, 7100, 1, LSB_MODE);
+    step("setFrequency SSB");
+    rx.setFrequency(7074);
+    step("setSSBBfo");
+    rx.setSSBBfo(-500);
+    step("setSSBAudioBandwidth");
+    rx.setSSBAudioBandwidth(2);
+
+    step("powerDown");
+    rx.powerDown();
+    return 0;
+}
@@ -0,0 +1,62 @@
+/**
+ * @brief Fixture shared by the host tests (radio_test, stationdb_test, store_test, ...)
+ *
+ * @details Each test is a single translation unit. Define TEST_NAME (the prefix of the messages) before including this file.
+ * @details The fixture is a simulated receiver (chip) driven by rx, plus a simulated 24C128 EEPROM at EEPROM_ADDR.
+ * @details CHECK reports a failed condition and goes on; hostTestResult prints the summary and returns the exit code.
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <SI4735.h>
+#include "SI4735Simulator.h"
+
+#ifndef TEST_NAME
+#error "Define TEST_NAME before including host_test.h"
+#endif
+
+#define EEPROM_ADDR 0x50
+
+#define CHECK(condition)                                                \
+    do                                                                  \
+    {                                                                   \
+        if (!(condition))                                               \
+        {                                                               \
+            printf(TEST_NAME ": line %d: %s\n", __LINE__, #condition); \
+            failures++;                                                 \
+        }                                                               \
+    } while (0)
+
+SI4735Simulator chip;
+SI4735 rx;
+uint8_t eeprom[16384];
+unsigned failures = 0;
+
+/**
+ * @brief Blanks the EEPROM (0xFF), attaches it and powers the receiver up in FM
+ */
+void hostTestSetup()
+{
+    memset(eeprom, 0xFF, sizeof eeprom);
+    chip.attachEeprom(EEPROM_ADDR, eeprom, sizeof eeprom);
+    rx.setTransport(&chip);
+    rx.setup(12, POWER_UP_FM);
+}
+
+/**
+ * @brief Prints the summary of the test
+ * @return int the exit code of the test (0 = ok)
+ */
+int hostTestResult()
+{
+    if (failures != 0)
+    {
+        printf(TEST_NAME ": FAILED (%u)\n", failures);
+        return 1;
+    }
+    printf(TEST_NAME ": ok\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @brief SI4735 radio service test (four producer threads and one worker; run it under ThreadSanitizer)
+ *
+ * @details Each producer submits requests declared on its own stack and waits for them (one in four with a very short
+ * @details timeout), so requests are executed, withdrawn on timeout or rejected (queue full). When wait returns, the
+ * @details producer poisons the request and leaves the scope. The worker callback checks the poison: a request used
+ * @details by the worker after its owner has given up is reported (and ThreadSanitizer reports the race too).
+ *
+ * @details Build and run: make radio-check
+ */
+
+#define TEST_NAME "radio"
+
+#include "host_test.h"
+#include <thread>
+
+#define PRODUCERS 4
+#define REQUESTS 2000 // Per producer
+
+SI4735RadioService radio(&rx);
+
+std::atomic<bool> stop{false};
+std::atomic<uint32_t> executed{0};
+std::atomic<uint32_t> done{0};
+std::atomic<uint32_t> canceled{0};
+std::atomic<uint32_t> rejected{0};
+std::atomic<uint32_t> violations{0};
+
+/**
+ * @brief Worker callback. The owner sets user to the request itself while it still waits for it.
+ */
+void check(SI4735RadioRequest *req)
+{
+    if (req->user != (void *)req)
+        violations++;
+    executed++;
+}
+
+void worker()
+{
+    while (!stop.load())
+        radio.run();
+    while (radio.run())
+        ;
+}
+
+void producer(int id)
+{
+    for (int i = 0; i < REQUESTS; i++)
+    {
+        SI4735RadioRequest req;
+        req.user = &req;
+
+        uint8_t command = (i % 3 == 0) ? RADIO_CMD_GET_RSQ : RADIO_CMD_SET_VOLUME;
+        if (!radio.submit(&req, command, (id * 7 + i) % 64, check))
+        {
+            rejected++;
+            std::this_thread::yield();
+            continue;
+        }
+
+        // One request in four waits for a single delay(1) of virtual time. It is often withdrawn before the worker takes it.
+        if (req.wait((i % 4 == 0) ? 1 : 0))
+            done++;
+        else if (req.state.load() == RADIO_REQUEST_CANCELED)
+            canceled++;
+        else
+            violations++; // wait returned false but the request is neither withdrawn nor done
+
+        req.user = NULL; // From here on, the worker must not use req
+    }
+}
+
+int main()
+{
+    std::thread threads[PRODUCERS];
+
+    hostTestSetup();
+    rx.setFM(8750, 10790, 10390, 10);
+
+    std::thread radioWorker(worker);
+    for (int i = 0; i < PRODUCERS; i++)
+        threads[i] = std::thread(producer, i);
+    for (int i = 0; i < PRODUCERS; i++)
+        threads[i].join();
+    stop.store(true);
+    radioWorker.join();
+
+    printf("radio: %u done, %u canceled, %u rejected, %u executed, %u violations\n",
+           (unsigned)done, (unsigned)canceled, (unsigned)rejected, (unsigned)executed, (unsigned)violations);
+
+    CHECK(violations == 0);
+    CHECK(executed == done);
+    CHECK(done + canceled + rejected == PRODUCERS * REQUESTS);
+    return hostTestResult();
+}
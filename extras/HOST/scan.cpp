@@ -0,0 +1,72 @@
+/**
+ * @brief Host example: full FM band scan and SSB patch download on the simulated device
+ *
+ * @details Prints the virtual time (the time the MCU would spend) of each step.
+ * @details Build and run: make run
+ */
+
+#include <SI4735.h>
+#include "SI4735Simulator.h"
+#include "patch_init.h"
+
+const si4735_sim_station band[] = {
+    {8990, SIM_FM, 40, 22, 5, NULL, 0},
+    {9390, SIM_FM, 45, 25, 5, NULL, 0},
+    {10170, SIM_FM, 30, 12, 20, NULL, 0},
+    {10390, SIM_FM, 38, 20, 10, NULL, 0},
+    {7100, SIM_AM, 35, 15, 0, NULL, 0}};
+
+SI4735Simulator chip;
+SI4735 rx;
+
+void show(const char *step, uint64_t start)
+{
+    printf("%-28s %10lu us\n", step, (unsigned long)(hostGetClock() - start));
+}
+
+int main()
+{
+    uint64_t start;
+
+    chip.setStations(band, sizeof band / sizeof band[0]);
+    rx.setTransport(&chip);
+
+    start = hostGetClock();
+    rx.setup(12, POWER_UP_FM);
+    rx.setFM(8750, 10790, 8750, 10);
+    show("setup and setFM", start);
+
+    start = hostGetClock();
+    uint16_t found = 0;
+    for (uint16_t f = 8750; f <= 10790; f += 10)
+    {
+        rx.setFrequency(f);
+        rx.getCurrentReceivedSignalQuality();
+        if (rx.getCurrentRSSI() >= 20 && rx.getCurrentSNR() >= 3)
+            found++;
+    }
+    show("FM scan (205 channels)", start);
+    printf("%-28s %10u\n", "stations found", found);
+
+    start = hostGetClock();
+    rx.setFrequency(8750);
+    rx.seekStationUp();
+    show("seek up", start);
+
+    start = hostGetClock();
+    rx.queryLibraryId();
+    rx.patchPowerUp();
+    delay(50);
+    rx.downloadPatch(ssb_patch_content, sizeof ssb_patch_content);
+    rx.setSSB(7000, 7200, 7100, 1, LSB_MODE);
+    show("SSB patch download", start);
+    printf("%-28s %10u\n", "patch lines", chip.getPatchLines());
+
+    const si4735_sim_counters *c = chip.getCounters();
+    printf("%-28s %10lu us\n", "total virtual time", (unsigned long)hostGetClock());
+    printf("%-28s %10u\n", "commands", c->commands);
+    printf("%-28s %10u\n", "bytes written", c->bytesWritten);
+    printf("%-28s %10u\n", "bytes read", c->bytesRead);
+    printf("%-28s %10u\n", "commands before CTS", c->ctsViolations);
+    return 0;
+}
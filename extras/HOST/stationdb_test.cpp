@@ -0,0 +1,211 @@
+/**
+ * @brief SI4735StationDb test (simulated 24C128 EEPROM; run it under AddressSanitizer)
+ *
+ * @details Checks the image saved and loaded through the simulator's EEPROM (round trip and corruption), every reason
+ * @details load rejects an image, the eviction of the oldest station when the database is full (the insertion point
+ * @details moves when the evicted station is before it) and the wrap of next() in both directions.
+ *
+ * @details Build and run: make eeprom-check
+ */
+
+#define TEST_NAME "stationdb"
+
+#include "host_test.h"
+
+#define DB_OFFSET 256 // Any offset; not page aligned on purpose
+
+/**
+ * @brief Exposes the checksum, so the test can write a consistent image with unsorted records
+ */
+class TestStationDb : public SI4735StationDb
+{
+public:
+    TestStationDb(si4735_station *buffer, uint16_t capacity) : SI4735StationDb(buffer, capacity) {}
+    using SI4735StationDb::checksum;
+};
+
+/**
+ * @brief true if the stations are sorted by mode and frequency, without duplicates
+ */
+bool isSorted(SI4735StationDb *db)
+{
+    for (uint16_t i = 1; i < db->getCount(); i++)
+    {
+        si4735_station *a = db->at(i - 1), *b = db->at(i);
+        if (a->mode > b->mode || (a->mode == b->mode && a->frequency >= b->frequency))
+            return false;
+    }
+    return true;
+}
+
+void testRoundTrip()
+{
+    si4735_station saved[8], loaded[8];
+    SI4735StationDb db(saved, 8), copy(loaded, 8);
+
+    CHECK(!copy.load(&rx, EEPROM_ADDR, DB_OFFSET)); // Blank EEPROM (0xFF)
+
+    db.update(FM_CURRENT_MODE, 10390, 38, 20, 100);
+    db.update(FM_CURRENT_MODE, 8990, 40, 22, 101);
+    db.update(AM_CURRENT_MODE, 810, 30, 10, 102);
+    db.update(FM_CURRENT_MODE, 9390, 45, 25, 103);
+    CHECK(db.setRds(FM_CURRENT_MODE, 10390, 0xC0DE, "RADIO ONE LONG"));
+    CHECK(db.isChanged());
+    CHECK(db.save(&rx, EEPROM_ADDR, DB_OFFSET));
+    CHECK(!db.isChanged());
+
+    CHECK(copy.load(&rx, EEPROM_ADDR, DB_OFFSET));
+    CHECK(copy.getCount() == 4);
+    CHECK(!copy.isChanged());
+    CHECK(memcmp(saved, loaded, 4 * sizeof(si4735_station)) == 0);
+    si4735_station *s = copy.find(FM_CURRENT_MODE, 10390);
+    CHECK(s != NULL && s->pi == 0xC0DE && (s->flags & STATION_RDS_PS) && memcmp(s->ps, "RADIO ON", 8) == 0);
+
+    // A flipped bit in a record
+    eeprom[DB_OFFSET + sizeof(si4735_station_db_header) + 21] ^= 0x01;
+    CHECK(!copy.load(&rx, EEPROM_ADDR, DB_OFFSET));
+    CHECK(copy.getCount() == 0);
+}
+
+void testLoadRejects()
+{
+    si4735_station stations[8], small[2];
+    TestStationDb db(stations, 8);
+    SI4735StationDb smallDb(small, 2);
+    si4735_station_db_header header;
+    uint8_t *image = &eeprom[DB_OFFSET];
+
+    db.clear();
+    db.update(FM_CURRENT_MODE, 8990, 40, 22, 1);
+    db.update(FM_CURRENT_MODE, 9390, 45, 25, 2);
+    db.update(FM_CURRENT_MODE, 10390, 38, 20, 3);
+    CHECK(db.save(&rx, EEPROM_ADDR, DB_OFFSET));
+    CHECK(db.load(&rx, EEPROM_ADDR, DB_OFFSET) && db.getCount() == 3);
+    memcpy(&header, image, sizeof header);
+
+    si4735_station_db_header bad = header;
+    bad.magic ^= 0x0100;
+    memcpy(image, &bad, sizeof bad);
+    CHECK(!db.load(&rx, EEPROM_ADDR, DB_OFFSET) && db.getCount() == 0);
+
+    bad = header;
+    bad.version = STATION_DB_VERSION + 1;
+    memcpy(image, &bad, sizeof bad);
+    CHECK(!db.load(&rx, EEPROM_ADDR, DB_OFFSET) && db.getCount() == 0);
+
+    bad = header;
+    bad.recordSize = sizeof(si4735_station) + 4;
+    memcpy(image, &bad, sizeof bad);
+    CHECK(!db.load(&rx, EEPROM_ADDR, DB_OFFSET) && db.getCount() == 0);
+
+    bad = header;
+    bad.checksum ^= 0x0001;
+    memcpy(image, &bad, sizeof bad);
+    CHECK(!db.load(&rx, EEPROM_ADDR, DB_OFFSET) && db.getCount() == 0);
+
+    // More records than the capacity
+    memcpy(image, &header, sizeof header);
+    CHECK(!smallDb.load(&rx, EEPROM_ADDR, DB_OFFSET) && smallDb.getCount() == 0);
+
+    // Records swapped with a matching checksum
+    si4735_station records[3];
+    memcpy(records, image + sizeof header, sizeof records);
+    si4735_station first = records[0];
+    records[0] = records[1];
+    records[1] = first;
+    bad = header;
+    bad.checksum = TestStationDb::checksum((const uint8_t *)records, sizeof records);
+    CHECK(rx.eepromWrite(EEPROM_ADDR, DB_OFFSET + sizeof header, (const uint8_t *)records, sizeof records));
+    memcpy(image, &bad, sizeof bad);
+    CHECK(!db.load(&rx, EEPROM_ADDR, DB_OFFSET) && db.getCount() == 0);
+
+    // A duplicated station
+    records[0] = records[1];
+    bad.checksum = TestStationDb::checksum((const uint8_t *)records, sizeof records);
+    CHECK(rx.eepromWrite(EEPROM_ADDR, DB_OFFSET + sizeof header, (const uint8_t *)records, sizeof records));
+    memcpy(image, &bad, sizeof bad);
+    CHECK(!db.load(&rx, EEPROM_ADDR, DB_OFFSET) && db.getCount() == 0);
+}
+
+void testEviction()
+{
+    si4735_station stations[4];
+    SI4735StationDb db(stations, 4);
+
+    // The oldest station is before the insertion point
+    db.update(FM_CURRENT_MODE, 8800, 10, 1, 5); // Oldest
+    db.update(FM_CURRENT_MODE, 9000, 11, 2, 20);
+    db.update(FM_CURRENT_MODE, 9200, 12, 3, 30);
+    db.update(FM_CURRENT_MODE, 9600, 13, 4, 40);
+    si4735_station *s = db.update(FM_CURRENT_MODE, 9400, 14, 5, 50);
+    CHECK(db.getCount() == 4);
+    CHECK(s != NULL && s->frequency == 9400 && s->rssi == 14 && s->time == 50);
+    CHECK(db.find(FM_CURRENT_MODE, 8800) == NULL);
+    CHECK(db.find(FM_CURRENT_MODE, 9400) == s);
+    CHECK(isSorted(&db));
+    CHECK(db.at(1)->frequency == 9200 && db.at(2)->frequency == 9400 && db.at(3)->frequency == 9600);
+
+    // The oldest station is after the insertion point
+    db.update(FM_CURRENT_MODE, 9600, 13, 4, 1); // Now the oldest
+    s = db.update(FM_CURRENT_MODE, 8700, 15, 6, 60);
+    CHECK(db.getCount() == 4);
+    CHECK(s != NULL && s->frequency == 8700 && s == db.at(0));
+    CHECK(db.find(FM_CURRENT_MODE, 9600) == NULL);
+    CHECK(isSorted(&db));
+
+    // The oldest station is the one at the insertion point
+    db.update(FM_CURRENT_MODE, 9200, 12, 3, 0);
+    s = db.update(FM_CURRENT_MODE, 9100, 16, 7, 70);
+    CHECK(s != NULL && s->frequency == 9100 && db.find(FM_CURRENT_MODE, 9200) == NULL);
+    CHECK(db.getCount() == 4 && isSorted(&db));
+
+    // An update of a known station does not evict
+    s = db.update(FM_CURRENT_MODE, 9100, 17, 8, 80);
+    CHECK(db.getCount() == 4 && s->rssi == 17 && db.find(FM_CURRENT_MODE, 8700) != NULL);
+
+    SI4735StationDb empty(stations, 0);
+    CHECK(empty.update(FM_CURRENT_MODE, 9100, 1, 1, 1) == NULL);
+}
+
+void testNextWrap()
+{
+    si4735_station stations[8];
+    SI4735StationDb db(stations, 8);
+
+    db.update(AM_CURRENT_MODE, 810, 30, 10, 1);
+    db.update(AM_CURRENT_MODE, 600, 30, 10, 1);
+    db.update(FM_CURRENT_MODE, 8990, 40, 22, 1);
+    db.update(FM_CURRENT_MODE, 9390, 45, 25, 1);
+    db.update(FM_CURRENT_MODE, 10390, 38, 20, 1);
+
+    CHECK(db.next(FM_CURRENT_MODE, 8990, SEEK_UP)->frequency == 9390);
+    CHECK(db.next(FM_CURRENT_MODE, 9000, SEEK_UP)->frequency == 9390); // Not a station
+    CHECK(db.next(FM_CURRENT_MODE, 10390, SEEK_UP)->frequency == 8990); // Wraps to the first
+    CHECK(db.next(FM_CURRENT_MODE, 10700, SEEK_UP)->frequency == 8990);
+    CHECK(db.next(FM_CURRENT_MODE, 9390, SEEK_DOWN)->frequency == 8990);
+    CHECK(db.next(FM_CURRENT_MODE, 8990, SEEK_DOWN)->frequency == 10390); // Wraps to the last
+    CHECK(db.next(FM_CURRENT_MODE, 8750, SEEK_DOWN)->frequency == 10390);
+
+    // The other mode is never returned
+    CHECK(db.next(AM_CURRENT_MODE, 810, SEEK_UP)->frequency == 600);
+    CHECK(db.next(AM_CURRENT_MODE, 600, SEEK_DOWN)->frequency == 810);
+    CHECK(db.next(SSB_CURRENT_MODE, 7100, SEEK_UP) == NULL);
+    CHECK(db.next(SSB_CURRENT_MODE, 7100, SEEK_DOWN) == NULL);
+
+    // A single station of the mode
+    db.update(SSB_CURRENT_MODE, 7100, 20, 5, 1);
+    CHECK(db.next(SSB_CURRENT_MODE, 7100, SEEK_UP)->frequency == 7100);
+    CHECK(db.next(SSB_CURRENT_MODE, 7100, SEEK_DOWN)->frequency == 7100);
+}
+
+int main()
+{
+    hostTestSetup();
+
+    testRoundTrip();
+    testLoadRejects();
+    testEviction();
+    testNextWrap();
+
+    return hostTestResult();
+}
@@ -0,0 +1,216 @@
+/**
+ * @brief SI4735EepromStore test (simulated 24C128 EEPROM that also keeps an SSB patch header; run it under AddressSanitizer)
+ *
+ * @details Writes 1000 records with a reboot (a new store and begin) before each one, so the ring is crossed ten times and
+ * @details begin must find the newest record at every position of every lap. Then it corrupts the newest record (a write cut
+ * @details by a power loss), checks the recovery of the previous one and that the next records still follow the lap, and checks
+ * @details that a store with a different number of keys rejects the records. The patch header must never be touched.
+ *
+ * @details Build and run: make eeprom-check
+ */
+
+#define TEST_NAME "store"
+
+#include "host_test.h"
+
+#define PATCH_SIZE 1000   // Size written in the simulated patch header
+#define REGION_SIZE 1000  // 100 records of 10 bytes (3 keys)
+#define KEYS 3
+#define RECORD_SIZE (KEYS * 2 + 4)
+#define CYCLES 1000
+
+si4735_eeprom_patch_header patch;
+uint16_t start;
+
+/**
+ * @brief Slot of the newest record (highest sequence number, serial number arithmetic)
+ */
+uint16_t newestSlot()
+{
+    uint16_t newest = 0, best = 0;
+
+    for (uint16_t slot = 0; slot < REGION_SIZE / RECORD_SIZE; slot++)
+    {
+        uint16_t sequence;
+        memcpy(&sequence, &eeprom[start + slot * RECORD_SIZE], 2);
+        if (slot == 0 || (int16_t)(sequence - best) > 0)
+        {
+            best = sequence;
+            newest = slot;
+        }
+    }
+    return newest;
+}
+
+void testPatchEnd()
+{
+    memset(eeprom, 0xFF, sizeof eeprom);
+    CHECK(rx.getEepromPatchEnd(EEPROM_ADDR) == 32); // No patch: the header page is kept
+
+    // A garbage patch size is not a patch (the result would wrap to 0 or run past the EEPROM)
+    memset(patch.raw, 0, sizeof patch);
+    patch.refined.patch_size = 0xFFE0;
+    memcpy(eeprom, patch.raw, sizeof patch);
+    CHECK(rx.getEepromPatchEnd(EEPROM_ADDR) == 32);
+    patch.refined.patch_size = EEPROM_MAX_SIZE;
+    memcpy(eeprom, patch.raw, sizeof patch);
+    CHECK(rx.getEepromPatchEnd(EEPROM_ADDR) == 32);
+    patch.refined.patch_size = EEPROM_MAX_SIZE - 48;
+    memcpy(eeprom, patch.raw, sizeof patch);
+    CHECK(rx.getEepromPatchEnd(EEPROM_ADDR) == EEPROM_MAX_SIZE - EEPROM_PAGE_SIZE);
+
+    memset(patch.raw, 0, sizeof patch);
+    patch.refined.patch_size = PATCH_SIZE;
+    memcpy(eeprom, patch.raw, sizeof patch);
+    start = rx.getEepromPatchEnd(EEPROM_ADDR);
+    CHECK(start == 1040); // 32 + 1000 rounded up to a page
+}
+
+void testWriteBehind()
+{
+    uint16_t values[KEYS] = {1, 10390, 45};
+    SI4735EepromStore store(values, KEYS);
+    uint32_t bytes;
+
+    CHECK(!store.begin(&rx, EEPROM_ADDR, start, REGION_SIZE)); // Blank region
+    CHECK(store.getSlots() == REGION_SIZE / RECORD_SIZE);
+    CHECK(store.get(1) == 10390); // Defaults kept
+
+    store.set(1, 10400);
+    CHECK(store.isDirty());
+    bytes = chip.getCounters()->eepromBytes;
+    hostAdvanceClock(1000000);
+    CHECK(store.service());
+    store.set(1, 10410); // Restarts the flush delay
+    hostAdvanceClock(1500000);
+    CHECK(store.service());
+    CHECK(chip.getCounters()->eepromBytes == bytes); // Nothing written yet
+    hostAdvanceClock(600000);
+    CHECK(!store.service());
+    CHECK(!store.isDirty());
+    CHECK(chip.getCounters()->eepromBytes > bytes);
+    CHECK(store.flush()); // Nothing pending: no write
+}
+
+void testReboots()
+{
+    uint16_t expected[KEYS];
+    uint16_t worst = 0;
+
+    {
+        uint16_t values[KEYS] = {0, 0, 0};
+        SI4735EepromStore store(values, KEYS);
+        CHECK(store.begin(&rx, EEPROM_ADDR, start, REGION_SIZE));
+        memcpy(expected, values, sizeof expected);
+    }
+
+    for (int cycle = 0; cycle < CYCLES; cycle++)
+    {
+        uint16_t values[KEYS] = {0xAAAA, 0xAAAA, 0xAAAA};
+        SI4735EepromStore store(values, KEYS);
+        uint32_t bytes = chip.getCounters()->eepromBytes;
+
+        if (!store.begin(&rx, EEPROM_ADDR, start, REGION_SIZE) || memcmp(values, expected, sizeof values) != 0)
+        {
+            printf("store: cycle %d: %u %u %u (expected %u %u %u)\n", cycle, values[0], values[1], values[2],
+                   expected[0], expected[1], expected[2]);
+            failures++;
+            return;
+        }
+        bytes = chip.getCounters()->eepromBytes - bytes;
+        if (bytes > worst)
+            worst = bytes;
+
+        store.set(cycle % KEYS, cycle);
+        expected[cycle % KEYS] = cycle;
+        CHECK(store.flush());
+    }
+
+    // Binary search: 1 + 7 sequence numbers for 100 slots, then one record (each read also sends the 2 address bytes)
+    CHECK(worst <= 8 * (2 + 2) + 2 + RECORD_SIZE);
+    CHECK(memcmp(eeprom, patch.raw, sizeof patch) == 0);
+    CHECK(eeprom[start - 1] == 0xFF && eeprom[start + REGION_SIZE] == 0xFF);
+}
+
+void testTornRecord()
+{
+    uint16_t values[KEYS], last[KEYS];
+    SI4735EepromStore store(values, KEYS);
+
+    CHECK(store.begin(&rx, EEPROM_ADDR, start, REGION_SIZE));
+    memcpy(last, values, sizeof last);
+    store.set(2, 7777);
+    CHECK(store.flush());
+
+    // The power is lost while the newest record is written: its CRC does not match
+    uint16_t slot = newestSlot();
+    eeprom[start + slot * RECORD_SIZE + RECORD_SIZE - 1] ^= 0x55;
+
+    uint16_t recovered[KEYS] = {9, 9, 9};
+    SI4735EepromStore afterLoss(recovered, KEYS);
+    CHECK(afterLoss.begin(&rx, EEPROM_ADDR, start, REGION_SIZE));
+    CHECK(memcmp(recovered, last, sizeof last) == 0);
+
+    // The next record goes after the corrupted one, so the lap is kept
+    afterLoss.set(0, 5555);
+    CHECK(afterLoss.flush());
+    CHECK(newestSlot() == (slot + 1) % (REGION_SIZE / RECORD_SIZE));
+
+    uint16_t again[KEYS];
+    SI4735EepromStore reboot(again, KEYS);
+    CHECK(reboot.begin(&rx, EEPROM_ADDR, start, REGION_SIZE));
+    CHECK(again[0] == 5555 && again[1] == last[1] && again[2] == last[2]);
+
+    // Both the newest and the previous records are lost: the defaults are kept
+    reboot.set(1, 1234);
+    CHECK(reboot.flush());
+    slot = newestSlot();
+    eeprom[start + slot * RECORD_SIZE + 3] ^= 0x01;
+    eeprom[start + ((slot + REGION_SIZE / RECORD_SIZE - 1) % (REGION_SIZE / RECORD_SIZE)) * RECORD_SIZE + 3] ^= 0x01;
+    uint16_t defaults[KEYS] = {1, 2, 3};
+    SI4735EepromStore lost(defaults, KEYS);
+    CHECK(!lost.begin(&rx, EEPROM_ADDR, start, REGION_SIZE));
+    CHECK(defaults[0] == 1 && defaults[1] == 2 && defaults[2] == 3);
+
+    CHECK(memcmp(eeprom, patch.raw, sizeof patch) == 0);
+}
+
+void testKeyCount()
+{
+    uint16_t values[KEYS];
+    SI4735EepromStore store(values, KEYS);
+
+    store.begin(&rx, EEPROM_ADDR, start, REGION_SIZE); // Records of 3 keys in every slot (the last two are corrupted)
+    store.set(0, 42);
+    CHECK(store.flush());
+
+    // Same region, other number of keys: every record is rejected and the defaults are kept
+    uint16_t four[4] = {7, 7, 7, 7};
+    SI4735EepromStore other(four, 4);
+    CHECK(!other.begin(&rx, EEPROM_ADDR, start, REGION_SIZE));
+    CHECK(four[0] == 7 && four[1] == 7 && four[2] == 7 && four[3] == 7);
+
+    uint16_t two[2] = {8, 8};
+    SI4735EepromStore fewer(two, 2);
+    CHECK(!fewer.begin(&rx, EEPROM_ADDR, start, REGION_SIZE));
+    CHECK(two[0] == 8 && two[1] == 8);
+
+    // More keys than STORE_MAX_KEYS are limited
+    uint16_t many[STORE_MAX_KEYS + 4];
+    SI4735EepromStore limited(many, STORE_MAX_KEYS + 4);
+    limited.begin(&rx, EEPROM_ADDR, start, REGION_SIZE);
+    CHECK(limited.getSlots() == REGION_SIZE / (STORE_MAX_KEYS * 2 + 4));
+}
+
+int main()
+{
+    hostTestSetup();
+
+    testPatchEnd();
+    testWriteBehind();
+    testReboots();
+    testTornRecord();
+    testKeyCount();
+
+    return hostTestResult();
+}
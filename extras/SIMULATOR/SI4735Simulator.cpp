@@ -0,0 +1,652 @@
+/**
+ * @brief SI4735 Simulator - behavioral model of the Si47XX device
+ *
+ * @details See SI4735Simulator.h
+ *
+ * @see Si47XX PROGRAMMING GUIDE AN332 (Rev 1.0): https://www.silabs.com/documents/public/application-notes/AN332.pdf
+ */
+
+#include "SI4735Simulator.h"
+
+/**
+ * @brief Property values after POWER_UP (only the ones the simulator uses)
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 100-104 and 161-162
+ */
+static const uint16_t defaultProperties[][2] = {
+    {FM_SEEK_BAND_BOTTOM, 8750},
+    {FM_SEEK_BAND_TOP, 10790},
+    {FM_SEEK_FREQ_SPACING, 10},
+    {FM_SEEK_TUNE_SNR_THRESHOLD, 3},
+    {FM_SEEK_TUNE_RSSI_THRESHOLD, 20},
+    {AM_SEEK_BAND_BOTTOM, 520},
+    {AM_SEEK_BAND_TOP, 1710},
+    {AM_SEEK_FREQ_SPACING, 10},
+    {AM_SEEK_SNR_THRESHOLD, 5},
+    {AM_SEEK_RSSI_THRESHOLD, 25},
+    {RX_VOLUME, 63},
+    {FM_RDS_INT_FIFO_COUNT, 0},
+    {FM_RDS_CONFIG, 0}};
+
+/**
+ * @brief Construct a new SI4735Simulator
+ * @param address I2C address of the simulated device (SI473X_ADDR_SEN_LOW or SI473X_ADDR_SEN_HIGH)
+ */
+SI4735Simulator::SI4735Simulator(uint8_t address)
+{
+    this->address = address;
+    memset(response, 0, sizeof response);
+    resetCounters();
+}
+
+/**
+ * @brief Nothing to start. The simulated device is always connected.
+ */
+void SI4735Simulator::begin()
+{
+}
+
+/**
+ * @brief Moves the simulated device to the reset state (powered down, default properties)
+ * @details Same of pulsing the RESET pin. The bus counters are not changed.
+ */
+void SI4735Simulator::reset()
+{
+    powered = patchMode = stcPending = error = rdsLost = false;
+    interruptStatus = 0;
+    propertyCount = 0;
+    frequency = 0;
+    seekDirection = 0;
+    ctsTime = micros();
+}
+
+/**
+ * @brief Sets the stations of the simulated band
+ * @details The array is not copied. It must exist while the simulator is used.
+ * @param stations array of stations (FM and AM can be mixed)
+ * @param count number of stations
+ */
+void SI4735Simulator::setStations(const si4735_sim_station *stations, uint8_t count)
+{
+    this->stations = stations;
+    this->stationCount = count;
+}
+
+/**
+ * @brief Attaches an I2C EEPROM (two address bytes, like 24LC256) to the simulated bus
+ * @details Useful for downloadPatchFromEeprom and for any code that stores data in an external EEPROM.
+ * @param address EEPROM I2C address (example 0x50)
+ * @param memory EEPROM content (not copied)
+ * @param size EEPROM size in bytes
+ */
+void SI4735Simulator::attachEeprom(uint8_t address, uint8_t *memory, uint16_t size)
+{
+    eepromAddress = address;
+    eeprom = memory;
+    eepromSize = size;
+    eepromPointer = 0;
+}
+
+/**
+ * @brief Sets the bus clock. Changes the time spent by each byte on the bus.
+ * @param frequency in Hz
+ */
+void SI4735Simulator::setClock(uint32_t frequency)
+{
+    if (frequency != 0)
+        timing.busByte = 9000000UL / frequency;
+}
+
+/**
+ * @brief Waits the time size bytes (plus the address byte) take on the I2C bus
+ */
+void SI4735Simulator::busTime(uint8_t size)
+{
+    if (timing.busByte != 0)
+        waitMicroseconds((uint32_t)(size + 1) * timing.busByte);
+}
+
+/**
+ * @brief Gets a property value (the stored one or the default)
+ * @param number property number
+ * @return uint16_t value
+ */
+uint16_t SI4735Simulator::getProperty(uint16_t number)
+{
+    for (uint8_t i = 0; i < propertyCount; i++)
+        if (propertyNumber[i] == number)
+            return propertyValue[i];
+    for (uint8_t i = 0; i < sizeof defaultProperties / sizeof defaultProperties[0]; i++)
+        if (defaultProperties[i][0] == number)
+            return defaultProperties[i][1];
+    return 0;
+}
+
+/**
+ * @brief Stores a property value
+ * @details If there is no room, the value is not stored (the property keeps returning its default value).
+ * @param number property number
+ * @param value value
+ */
+void SI4735Simulator::setProperty(uint16_t number, uint16_t value)
+{
+    for (uint8_t i = 0; i < propertyCount; i++)
+    {
+        if (propertyNumber[i] == number)
+        {
+            propertyValue[i] = value;
+            return;
+        }
+    }
+    if (propertyCount < SIM_MAX_PROPERTIES)
+    {
+        propertyNumber[propertyCount] = number;
+        propertyValue[propertyCount++] = value;
+    }
+}
+
+/**
+ * @brief Writes a transaction to the simulated device (a command or a patch line) or to the EEPROM
+ * @return uint8_t 0 if success; 2 if nobody answered the address (NACK)
+ */
+uint8_t SI4735Simulator::write(uint8_t address, const uint8_t *data, uint8_t size)
+{
+    busTime(size);
+
+    if (eeprom != NULL && address == eepromAddress)
+    {
+        counters.eepromBytes += size;
+        if (size >= 2)
+        {
+            eepromPointer = (((uint16_t)data[0] << 8) | data[1]) % eepromSize;
+            for (uint8_t i = 2; i < size; i++)
+            {
+                eeprom[eepromPointer] = data[i];
+                eepromPointer = (eepromPointer + 1) % eepromSize;
+            }
+        }
+        return 0;
+    }
+
+    if (address != this->address)
+        return 2;
+
+    counters.writes++;
+    counters.bytesWritten += size;
+    if (size == 0) // Address check (see getDeviceI2CAddress)
+        return 0;
+
+    execute(data, size);
+    return 0;
+}
+
+/**
+ * @brief Reads the status byte and the response of the last command (or the EEPROM content)
+ * @details The status byte (CTS, ERR, RSQINT, RDSINT and STCINT) is computed at the time of the read.
+ * @return uint8_t number of bytes received (0 if nobody answered the address)
+ */
+uint8_t SI4735Simulator::read(uint8_t address, uint8_t *data, uint8_t size)
+{
+    busTime(size);
+
+    if (eeprom != NULL && address == eepromAddress)
+    {
+        counters.eepromBytes += size;
+        for (uint8_t i = 0; i < size; i++)
+        {
+            data[i] = eeprom[eepromPointer];
+            eepromPointer = (eepromPointer + 1) % eepromSize;
+        }
+        return size;
+    }
+
+    if (address != this->address)
+    {
+        memset(data, 0xFF, size);
+        return 0;
+    }
+
+    counters.reads++;
+    counters.bytesRead += size;
+
+    uint32_t now = micros();
+    update(now);
+
+    bool cts = (int32_t)(now - ctsTime) >= 0;
+    for (uint8_t i = 1; i < size; i++)
+        data[i] = (i < sizeof response) ? response[i] : 0;
+    if (size > 0)
+        data[0] = (cts ? 0x80 : 0) | ((cts && error) ? 0x40 : 0) | interruptStatus;
+    return size;
+}
+
+/**
+ * @brief Updates the state that depends on time (STC and RDS interrupt bits)
+ */
+void SI4735Simulator::update(uint32_t now)
+{
+    if (stcPending && (int32_t)(now - stcTime) >= 0)
+    {
+        stcPending = false;
+        interruptStatus |= 0x01; // STCINT
+    }
+
+    if (getRdsFifo(now) > 0 && getRdsFifo(now) >= getProperty(FM_RDS_INT_FIFO_COUNT))
+        interruptStatus |= 0x04; // RDSINT
+}
+
+/**
+ * @brief Executes a command (or stores a patch line) and prepares its response
+ */
+void SI4735Simulator::execute(const uint8_t *data, uint8_t size)
+{
+    uint32_t now = micros();
+    uint32_t latency = timing.command;
+    uint8_t cmd = data[0];
+    uint8_t arg[8];
+
+    if ((int32_t)(now - ctsTime) < 0)
+        counters.ctsViolations++;
+
+    update(now);
+
+    memset(arg, 0, sizeof arg);
+    memcpy(arg, data, (size < sizeof arg) ? size : sizeof arg);
+
+    // After POWER_UP with PATCH = 1, the device receives the patch lines. The first other command ends the download.
+    if (patchMode)
+    {
+        if (cmd == SIM_PATCH_ARGS || cmd == SIM_PATCH_DATA)
+        {
+            counters.patchLines++;
+            patchLines++;
+            ctsTime = now + timing.patchLine;
+            return;
+        }
+        patchMode = false;
+    }
+
+    counters.commands++;
+    memset(response, 0, sizeof response);
+    error = false;
+
+    if (!powered && cmd != POWER_UP)
+    {
+        // Only POWER_UP is accepted in powerdown mode
+        error = true;
+        ctsTime = now + latency;
+        return;
+    }
+
+    switch (cmd)
+    {
+    case POWER_UP:
+        latency = timing.powerUp;
+        if ((arg[1] & 0x0F) == POWER_PATCH)
+        {
+            // Query library ID. The device returns to powerdown mode.
+            response[1] = 0x35;      // PN (Si4735)
+            response[2] = '6';       // FWMAJOR
+            response[3] = '0';       // FWMINOR
+            response[6] = 'D';       // CHIPREV
+            response[7] = 0x0A;      // LIBRARYID
+            powered = false;
+            break;
+        }
+        powered = true;
+        function = ((arg[1] & 0x0F) == POWER_UP_FM) ? SIM_FM : SIM_AM;
+        patchMode = (arg[1] & 0x20) != 0;
+        if (patchMode)
+            patchLines = 0;
+        propertyCount = 0;
+        interruptStatus = 0;
+        frequency = 0;
+        seekDirection = 0;
+        break;
+    case POWER_DOWN:
+        powered = patchMode = stcPending = false;
+        interruptStatus = 0;
+        break;
+    case GET_REV:
+        response[1] = 0x35; // PN (Si4735)
+        response[2] = '6';  // FWMAJOR
+        response[3] = '0';  // FWMINOR
+        response[6] = '6';  // CMPMAJOR
+        response[7] = '0';  // CMPMINOR
+        response[8] = 'D';  // CHIPREV
+        break;
+    case SET_PROPERTY:
+        latency = timing.property;
+        setProperty(((uint16_t)arg[2] << 8) | arg[3], ((uint16_t)arg[4] << 8) | arg[5]);
+        break;
+    case GET_PROPERTY:
+    {
+        latency = timing.property;
+        uint16_t value = getProperty(((uint16_t)arg[2] << 8) | arg[3]);
+        response[2] = value >> 8;
+        response[3] = value & 0xFF;
+        break;
+    }
+    case GET_INT_STATUS:
+    case GPIO_CTL:
+    case GPIO_SET:
+        break;
+    case FM_TUNE_FREQ:
+    case AM_TUNE_FREQ:
+    case NBFM_TUNE_FREQ:
+        startTune(now + latency, ((uint16_t)arg[2] << 8) | arg[3], 0, false);
+        break;
+    case FM_SEEK_START:
+    case AM_SEEK_START:
+        startTune(now + latency, frequency, (arg[1] & 0x08) ? 1 : -1, (arg[1] & 0x04) != 0);
+        break;
+    case FM_TUNE_STATUS:
+    case AM_TUNE_STATUS:
+    case NBFM_TUNE_STATUS:
+        tuneStatus(now, arg[1]);
+        break;
+    case FM_RSQ_STATUS:
+    case AM_RSQ_STATUS:
+    case NBFM_RSQ_STATUS:
+        rsqStatus(arg[1]);
+        break;
+    case FM_RDS_STATUS:
+        readRds(now, arg[1]);
+        break;
+    case FM_AGC_STATUS:
+    case AM_AGC_STATUS:
+    case NBFM_AGC_STATUS:
+        response[1] = agc[0] & 0x01;
+        response[2] = agc[1];
+        break;
+    case FM_AGC_OVERRIDE:
+    case AM_AGC_OVERRIDE:
+    case NBFM_AGC_OVERRIDE:
+        agc[0] = arg[1];
+        agc[1] = arg[2];
+        break;
+    default:
+        error = true; // Invalid command
+    }
+
+    ctsTime = now + latency;
+}
+
+/**
+ * @brief Gets the next channel of a seek
+ * @param freq current channel
+ * @param direction 1 = up; -1 = down
+ * @param wrap if true, continues from the other band limit
+ * @param limit set to true if the band limit was reached without wrap
+ * @return uint16_t the next channel (or the band limit)
+ */
+uint16_t SI4735Simulator::nextChannel(uint16_t freq, int8_t direction, bool wrap, bool *limit)
+{
+    uint16_t bottom = getProperty((function == SIM_FM) ? FM_SEEK_BAND_BOTTOM : AM_SEEK_BAND_BOTTOM);
+    uint16_t top = getProperty((function == SIM_FM) ? FM_SEEK_BAND_TOP : AM_SEEK_BAND_TOP);
+    uint16_t spacing = getProperty((function == SIM_FM) ? FM_SEEK_FREQ_SPACING : AM_SEEK_FREQ_SPACING);
+    int32_t next = (int32_t)freq + direction * (int32_t)spacing;
+
+    *limit = false;
+    if (next > top || next < bottom)
+    {
+        if (!wrap)
+        {
+            *limit = true;
+            return (direction > 0) ? top : bottom;
+        }
+        next = (direction > 0) ? bottom : top;
+    }
+    return (uint16_t)next;
+}
+
+/**
+ * @brief Starts a tune (direction = 0) or a seek
+ * @details The result of a seek is computed now. The time to STC is proportional to the number of channels scanned.
+ * @param now micros() when the device starts tuning (CTS of the command)
+ */
+void SI4735Simulator::startTune(uint32_t now, uint16_t freq, int8_t direction, bool wrap)
+{
+    // A new tune or seek interrupts the running one. A new seek continues from the channel being scanned.
+    if (direction != 0 && stcPending)
+        freq = getReadFrequency(now);
+
+    tuneStartTime = now;
+    seekDirection = direction;
+    seekFrom = freq;
+    seekChannels = 0;
+    seekLimit = false;
+    stcPending = true;
+    interruptStatus &= ~0x01;
+
+    if (direction == 0)
+    {
+        frequency = freq;
+        stcTime = now + ((function == SIM_FM) ? timing.fmTune : timing.amTune);
+    }
+    else
+    {
+        uint16_t f = freq;
+        do
+        {
+            f = nextChannel(f, direction, wrap, &seekLimit);
+            seekChannels++;
+        } while (!seekLimit && !isValid(f) && f != freq && seekChannels < 0xFFFF);
+        frequency = f;
+        stcTime = now + (uint32_t)seekChannels * ((function == SIM_FM) ? timing.fmSeekStep : timing.amSeekStep);
+    }
+
+    // RDS starts again on the new channel
+    rdsStartTime = stcTime;
+    rdsConsumed = 0;
+    rdsLost = false;
+}
+
+/**
+ * @brief Gets the frequency reported by the tune status (the seek progress while seeking)
+ */
+uint16_t SI4735Simulator::getReadFrequency(uint32_t now)
+{
+    if (!stcPending || seekDirection == 0)
+        return frequency;
+
+    uint32_t step = (function == SIM_FM) ? timing.fmSeekStep : timing.amSeekStep;
+    uint32_t channels = ((int32_t)(now - tuneStartTime) > 0) ? (now - tuneStartTime) / step : 0;
+    uint16_t f = seekFrom;
+    bool limit;
+    for (uint32_t i = 0; i < channels && i < seekChannels; i++)
+        f = nextChannel(f, seekDirection, true, &limit);
+    return f;
+}
+
+/**
+ * @brief Finds the station tuned on a frequency (including the adjacent channels) of the current function
+ * @return the strongest station heard on freq (NULL if none)
+ */
+const si4735_sim_station *SI4735Simulator::findStation(uint16_t freq)
+{
+    const si4735_sim_station *found = NULL;
+    uint8_t best = 0;
+
+    for (uint8_t i = 0; i < stationCount; i++)
+    {
+        if (stations[i].mode != function || stations[i].frequency != freq)
+            continue;
+        if (found == NULL || stations[i].rssi > best)
+        {
+            found = &stations[i];
+            best = stations[i].rssi;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Computes RSSI, SNR and multipath on a given frequency
+ * @details Exact channel: station values. Off channel (up to 50kHz FM or 2kHz AM): some dB less.
+ * @details Adjacent channel (up to 200kHz FM or 5kHz AM): much weaker and no SNR. Otherwise, the noise floor.
+ */
+void SI4735Simulator::getSignal(uint16_t freq, uint8_t *rssi, uint8_t *snr, uint8_t *multipath)
+{
+    *rssi = noiseRssi;
+    *snr = 0;
+    *multipath = 0;
+
+    for (uint8_t i = 0; i < stationCount; i++)
+    {
+        const si4735_sim_station *st = &stations[i];
+        if (st->mode != function)
+            continue;
+        uint16_t d = (st->frequency > freq) ? st->frequency - freq : freq - st->frequency;
+        uint8_t r, s;
+        if (d == 0)
+        {
+            r = st->rssi;
+            s = st->snr;
+        }
+        else if (d <= ((function == SIM_FM) ? 5 : 2))
+        {
+            r = (st->rssi > 6) ? st->rssi - 6 : 0;
+            s = (st->snr > 6) ? st->snr - 6 : 0;
+        }
+        else if (d <= ((function == SIM_FM) ? 20 : 5))
+        {
+            r = (st->rssi > 24) ? st->rssi - 24 : 0;
+            s = 0;
+        }
+        else
+            continue;
+        if (r > *rssi)
+        {
+            *rssi = r;
+            *snr = s;
+            *multipath = (function == SIM_FM) ? st->multipath : 0;
+        }
+    }
+}
+
+/**
+ * @brief Checks the seek/tune valid criteria (RSSI and SNR thresholds)
+ */
+bool SI4735Simulator::isValid(uint16_t freq)
+{
+    uint8_t rssi, snr, mult;
+    getSignal(freq, &rssi, &snr, &mult);
+    if (function == SIM_FM)
+        return rssi >= getProperty(FM_SEEK_TUNE_RSSI_THRESHOLD) && snr >= getProperty(FM_SEEK_TUNE_SNR_THRESHOLD);
+    return rssi >= getProperty(AM_SEEK_RSSI_THRESHOLD) && snr >= getProperty(AM_SEEK_SNR_THRESHOLD);
+}
+
+/**
+ * @brief FM_TUNE_STATUS / AM_TUNE_STATUS response
+ * @param arg INTACK (bit 0) and CANCEL (bit 1)
+ */
+void SI4735Simulator::tuneStatus(uint32_t now, uint8_t arg)
+{
+    uint8_t rssi, snr, mult;
+
+    if ((arg & 0x02) && stcPending && seekDirection != 0)
+    {
+        // Cancels the seek on the channel being scanned
+        frequency = getReadFrequency(now);
+        stcPending = false;
+        seekLimit = false;
+        interruptStatus |= 0x01;
+    }
+
+    uint16_t f = getReadFrequency(now);
+    getSignal(f, &rssi, &snr, &mult);
+
+    response[1] = ((!stcPending && isValid(f)) ? 0x01 : 0) | ((!stcPending && seekLimit) ? 0x80 : 0); // VALID and BLTF
+    response[2] = f >> 8;
+    response[3] = f & 0xFF;
+    response[4] = rssi;
+    response[5] = snr;
+    response[6] = (function == SIM_FM) ? mult : 0; // MULT (FM) or READANTCAPH (AM)
+    response[7] = (function == SIM_FM) ? 20 : 1;   // READANTCAP (FM) or READANTCAPL (AM)
+
+    if (arg & 0x01)
+        interruptStatus &= ~0x01; // INTACK clears STCINT
+}
+
+/**
+ * @brief FM_RSQ_STATUS / AM_RSQ_STATUS response
+ * @param arg INTACK (bit 0)
+ */
+void SI4735Simulator::rsqStatus(uint8_t arg)
+{
+    uint8_t rssi, snr, mult;
+
+    getSignal(frequency, &rssi, &snr, &mult);
+
+    response[2] = isValid(frequency) ? 0x01 : 0x08; // VALID or SMUTE
+    if (function == SIM_FM && rssi >= 30)
+        response[3] = 0x80 | ((rssi >= 45) ? 100 : (rssi - 30) * 6); // PILOT and STBLEND
+    response[4] = rssi;
+    response[5] = snr;
+    response[6] = mult;
+    response[7] = 0; // FREQOFF
+
+    if (arg & 0x01)
+        interruptStatus &= ~0x08; // INTACK clears RSQINT
+}
+
+/**
+ * @brief Number of RDS groups waiting in the FIFO
+ * @details The station sends one group every SIM_RDS_GROUP_TIME us. Groups beyond SIM_RDS_FIFO_SIZE are lost.
+ */
+uint32_t SI4735Simulator::getRdsFifo(uint32_t now)
+{
+    if (function != SIM_FM || stcPending || !(getProperty(FM_RDS_CONFIG) & 0x01) || (int32_t)(now - rdsStartTime) < 0)
+        return 0;
+
+    const si4735_sim_station *st = findStation(frequency);
+    if (st == NULL || st->rdsGroups == NULL || st->rdsGroupCount == 0)
+        return 0;
+
+    uint32_t sent = (now - rdsStartTime) / SIM_RDS_GROUP_TIME;
+    if (sent - rdsConsumed > SIM_RDS_FIFO_SIZE)
+    {
+        rdsConsumed = sent - SIM_RDS_FIFO_SIZE;
+        rdsLost = true;
+    }
+    return sent - rdsConsumed;
+}
+
+/**
+ * @brief FM_RDS_STATUS response
+ * @param arg INTACK (bit 0), MTFIFO (bit 1) and STATUSONLY (bit 2)
+ */
+void SI4735Simulator::readRds(uint32_t now, uint8_t arg)
+{
+    uint32_t fifo = getRdsFifo(now);
+    const si4735_sim_station *st = findStation(frequency);
+    bool sync = (fifo > 0 || rdsConsumed > 0);
+
+    if (arg & 0x01)
+        interruptStatus &= ~0x04; // INTACK clears RDSINT
+
+    if (arg & 0x02)
+    {
+        rdsConsumed += fifo; // MTFIFO clears the FIFO
+        fifo = 0;
+    }
+
+    response[1] = ((fifo > 0 && fifo >= getProperty(FM_RDS_INT_FIFO_COUNT)) ? 0x01 : 0) | (sync ? 0x04 : 0); // RDSRECV and RDSSYNCFOUND
+    response[2] = (sync ? 0x01 : 0) | (rdsLost ? 0x04 : 0);                                                 // RDSSYNC and GRPLOST
+    rdsLost = false;
+
+    if (fifo > 0 && !(arg & 0x04))
+    {
+        const uint16_t *group = &st->rdsGroups[(rdsConsumed % st->rdsGroupCount) * 4];
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            response[4 + i * 2] = group[i] >> 8;
+            response[5 + i * 2] = group[i] & 0xFF;
+        }
+        response[1] |= 0x30; // RDSNEWBLOCKA and RDSNEWBLOCKB
+        rdsConsumed++;
+        fifo--;
+    }
+    response[3] = fifo; // RDSFIFOUSED
+    response[12] = 0;   // BLEA to BLED: no errors
+}
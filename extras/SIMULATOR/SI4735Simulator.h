@@ -0,0 +1,206 @@
+/**
+ * @brief SI4735 Simulator - behavioral model of the Si47XX device
+ *
+ * @details This file contains a SI4735Transport that answers like a Si47XX device.
+ * @details With it, the SI4735 library runs unmodified (on a Linux host or on a board without the Si47XX) against a simulated chip.
+ * @details It models the command set used by the library (POWER_UP, GET_REV, SET/GET_PROPERTY, *_TUNE_FREQ, *_SEEK_START,
+ * @details *_TUNE_STATUS, *_RSQ_STATUS, FM_RDS_STATUS, AGC and GPIO commands), the CTS and STC timing, a band of stations
+ * @details (RSSI, SNR, multipath and RDS groups), the 8 bytes patch download protocol and an optional I2C EEPROM (24LC256 like).
+ * @details The time comes from micros(). On the host build (see extras/HOST), micros() is a virtual clock.
+ * @details The GPO2/INT pin is not modeled. Use the polling wait mode (default).
+ *
+ * @code
+ *   #include <SI4735.h>
+ *   #include "SI4735Simulator.h"
+ *
+ *   const uint16_t rdsGroups[] = {0x1234, 0x0400, 0xE0CD, 0x5241, ...}; // blocks A, B, C and D of each group
+ *   const si4735_sim_station band[] = {
+ *       {9390, SIM_FM, 45, 25, 5, rdsGroups, 4},
+ *       {10390, SIM_FM, 38, 20, 10, NULL, 0},
+ *       {810, SIM_AM, 40, 22, 0, NULL, 0}};
+ *
+ *   SI4735Simulator chip;
+ *   SI4735 rx;
+ *
+ *   void setup() {
+ *      chip.setStations(band, 3);
+ *      rx.setTransport(&chip);
+ *      rx.setup(RESET_PIN, FM_FUNCTION);
+ *   }
+ * @endcode
+ *
+ * @see SI4735Transport
+ * @see Si47XX PROGRAMMING GUIDE AN332 (Rev 1.0): https://www.silabs.com/documents/public/application-notes/AN332.pdf
+ */
+
+#ifndef _SI4735_SIMULATOR_H
+#define _SI4735_SIMULATOR_H
+
+#include <SI4735.h>
+
+#define SIM_FM 0 // FM station (frequency in 10kHz units. Example: 10390 = 103.9MHz)
+#define SIM_AM 1 // AM station (frequency in kHz). Also used by SSB.
+
+#define SIM_MAX_PROPERTIES 48   // Number of properties the simulated device can store
+#define SIM_RDS_FIFO_SIZE 25    // RDS FIFO size (groups)
+#define SIM_RDS_GROUP_TIME 87600 // In uS - time to receive one RDS group (1187.5 bps; 104 bits per group)
+#define SIM_PATCH_ARGS 0x15     // First byte of a patch line (arguments)
+#define SIM_PATCH_DATA 0x16     // First byte of a patch line (data)
+
+/**
+ * @ingroup group01
+ * @brief Simulated station
+ * @details The RDS groups are stored as 4 words (blocks A, B, C and D) per group and are transmitted in a loop.
+ */
+typedef struct
+{
+    uint16_t frequency;       //!< FM: 10kHz units; AM: kHz
+    uint8_t mode;             //!< SIM_FM or SIM_AM
+    uint8_t rssi;             //!< RSSI (dBuV) on the channel
+    uint8_t snr;              //!< SNR (dB) on the channel
+    uint8_t multipath;        //!< Multipath (0-100). FM only.
+    const uint16_t *rdsGroups; //!< RDS groups (4 blocks each). NULL if the station has no RDS.
+    uint8_t rdsGroupCount;    //!< Number of RDS groups
+} si4735_sim_station;
+
+/**
+ * @ingroup group01
+ * @brief Timing of the simulated device (in us)
+ */
+typedef struct
+{
+    uint32_t command;     //!< Time to CTS of most commands
+    uint32_t property;    //!< Time to CTS of SET_PROPERTY and GET_PROPERTY
+    uint32_t powerUp;     //!< Time to CTS of POWER_UP
+    uint32_t patchLine;   //!< Time to CTS of each patch line
+    uint32_t fmTune;      //!< FM: time from CTS to STC of a tune
+    uint32_t amTune;      //!< AM and SSB: time from CTS to STC of a tune
+    uint32_t fmSeekStep;  //!< FM: time spent on each channel during a seek
+    uint32_t amSeekStep;  //!< AM: time spent on each channel during a seek
+    uint32_t busByte;     //!< Time of a byte on the I2C bus (9 clocks). Updated by setClock.
+} si4735_sim_timing;
+
+/**
+ * @ingroup group01
+ * @brief Bus counters of the simulated device
+ */
+typedef struct
+{
+    uint32_t writes;       //!< Write transactions addressed to the device
+    uint32_t reads;        //!< Read transactions addressed to the device
+    uint32_t bytesWritten; //!< Bytes written to the device
+    uint32_t bytesRead;    //!< Bytes read from the device
+    uint32_t commands;     //!< Commands executed (patch lines not included)
+    uint32_t patchLines;   //!< Patch lines received
+    uint32_t eepromBytes;  //!< Bytes transferred to or from the EEPROM (addresses included)
+    uint32_t ctsViolations; //!< Commands received before CTS was set (the host did not wait)
+} si4735_sim_counters;
+
+/**
+ * @ingroup group05
+ *
+ * @brief Behavioral Si47XX simulator. It is a SI4735Transport.
+ *
+ * @details Responses are computed when they are read, from the time elapsed since the last command.
+ * @details There is no background task. So, it works on a virtual clock (host build) and on a real clock (board).
+ */
+class SI4735Simulator : public SI4735Transport
+{
+protected:
+    uint8_t address = SI473X_ADDR_SEN_LOW; //!< I2C address of the simulated device
+
+    si4735_sim_timing timing = {300, 550, 10000, 300, 10000, 20000, 2000, 4000, 90};
+    si4735_sim_counters counters;
+
+    const si4735_sim_station *stations = NULL;
+    uint8_t stationCount = 0;
+    uint8_t noiseRssi = 4; //!< RSSI (dBuV) out of any station
+
+    // Device state
+    bool powered = false;
+    bool patchMode = false;     //!< POWER_UP with PATCH = 1: the device expects patch lines
+    uint8_t function = SIM_FM;  //!< Current function (SIM_FM or SIM_AM)
+    uint16_t patchLines = 0;    //!< Lines received by the last patch download
+    uint8_t interruptStatus = 0; //!< Interrupt bits (STCINT, RDSINT and RSQINT) of the status byte
+    bool error = false;          //!< ERR bit of the last command
+    uint32_t ctsTime = 0;        //!< micros() when CTS is set again
+    uint8_t response[16];        //!< Response of the last command (response[0] is replaced by the status byte)
+    uint8_t agc[2] = {0, 0};     //!< Last AGC override arguments (AGCDIS and AGCIDX)
+
+    uint16_t propertyNumber[SIM_MAX_PROPERTIES];
+    uint16_t propertyValue[SIM_MAX_PROPERTIES];
+    uint8_t propertyCount = 0;
+
+    // Tune and seek
+    uint16_t frequency = 0;     //!< Current frequency (after STC)
+    uint16_t seekFrom = 0;      //!< Frequency where the current seek started
+    uint16_t seekChannels = 0;  //!< Number of channels scanned by the current seek
+    int8_t seekDirection = 0;   //!< 1 = up; -1 = down; 0 = tune (no seek)
+    bool seekLimit = false;     //!< The seek has hit the band limit (BLTF)
+    bool stcPending = false;    //!< A tune or a seek is running
+    uint32_t stcTime = 0;       //!< micros() when STC is set
+    uint32_t tuneStartTime = 0; //!< micros() when the tune or seek started
+
+    // RDS
+    uint32_t rdsStartTime = 0; //!< micros() when the current channel started receiving RDS
+    uint32_t rdsConsumed = 0;  //!< Groups read from the FIFO (or discarded) since rdsStartTime
+    bool rdsLost = false;      //!< One or more groups were discarded (FIFO overrun)
+
+    // EEPROM
+    uint8_t eepromAddress = 0;
+    uint8_t *eeprom = NULL;
+    uint16_t eepromSize = 0;
+    uint16_t eepromPointer = 0;
+
+    void busTime(uint8_t size);
+    void update(uint32_t now);
+    void execute(const uint8_t *data, uint8_t size);
+    void startTune(uint32_t now, uint16_t freq, int8_t direction, bool wrap);
+    uint16_t nextChannel(uint16_t freq, int8_t direction, bool wrap, bool *limit);
+    uint16_t getReadFrequency(uint32_t now);
+    const si4735_sim_station *findStation(uint16_t freq);
+    void getSignal(uint16_t freq, uint8_t *rssi, uint8_t *snr, uint8_t *multipath);
+    bool isValid(uint16_t freq);
+    uint32_t getRdsFifo(uint32_t now);
+    void readRds(uint32_t now, uint8_t arg);
+    void tuneStatus(uint32_t now, uint8_t arg);
+    void rsqStatus(uint8_t arg);
+
+public:
+    SI4735Simulator(uint8_t address = SI473X_ADDR_SEN_LOW);
+
+    void begin();
+    uint8_t write(uint8_t address, const uint8_t *data, uint8_t size);
+    uint8_t read(uint8_t address, uint8_t *data, uint8_t size);
+    void setClock(uint32_t frequency);
+
+    void reset();
+    void setStations(const si4735_sim_station *stations, uint8_t count);
+    void attachEeprom(uint8_t address, uint8_t *memory, uint16_t size);
+
+    uint16_t getProperty(uint16_t number);
+    void setProperty(uint16_t number, uint16_t value);
+
+    /**
+     * @brief Sets the timing of the simulated device
+     * @param timing see si4735_sim_timing
+     */
+    inline void setTiming(const si4735_sim_timing *timing) { this->timing = *timing; };
+    inline const si4735_sim_timing *getTiming() { return &timing; };
+
+    /**
+     * @brief Sets the RSSI returned out of any station (noise floor)
+     * @param rssi dBuV
+     */
+    inline void setNoiseRssi(uint8_t rssi) { noiseRssi = rssi; };
+
+    inline const si4735_sim_counters *getCounters() { return &counters; };
+    inline void resetCounters() { memset(&counters, 0, sizeof counters); };
+
+    inline bool isPowered() { return powered; };
+    inline uint8_t getFunction() { return function; };
+    inline uint16_t getFrequency() { return frequency; };
+    inline uint16_t getPatchLines() { return patchLines; };
+};
+
+#endif
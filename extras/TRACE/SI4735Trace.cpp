@@ -0,0 +1,280 @@
+/**
+ * @brief SI4735 Trace - I2C transaction capture and deterministic replay
+ *
+ * @details See SI4735Trace.h
+ */
+
+#include "SI4735Trace.h"
+
+/**
+ * @brief Construct a new SI4735TraceRecorder
+ * @param target transport that really exchanges data with the device (for example, SI4735WireTransport)
+ * @param output function that receives each trace line
+ */
+SI4735TraceRecorder::SI4735TraceRecorder(SI4735Transport *target, void (*output)(const char *line))
+{
+    this->target = target;
+    this->output = output;
+}
+
+void SI4735TraceRecorder::begin()
+{
+    target->begin();
+}
+
+/**
+ * @brief Formats a transaction and passes it to the output function
+ * @param now micros() at the start of the transaction
+ */
+void SI4735TraceRecorder::record(uint32_t now, char type, uint8_t address, const uint8_t *data, uint8_t size)
+{
+    char line[TRACE_MAX_LINE];
+    int n;
+
+    if (!enabled || output == NULL)
+        return;
+
+    if (!started)
+    {
+        startTime = now;
+        started = true;
+    }
+
+    n = sprintf(line, "%lu %c %02X", (unsigned long)(now - startTime), type, address);
+    for (uint8_t i = 0; i < size && i < TRACE_MAX_DATA; i++)
+        n += sprintf(line + n, " %02X", data[i]);
+    output(line);
+}
+
+uint8_t SI4735TraceRecorder::write(uint8_t address, const uint8_t *data, uint8_t size)
+{
+    uint32_t now = micros();
+    uint8_t result = target->write(address, data, size);
+    record(now, (result == 0) ? TRACE_WRITE : TRACE_NACK, address, data, size);
+    return result;
+}
+
+uint8_t SI4735TraceRecorder::read(uint8_t address, uint8_t *data, uint8_t size)
+{
+    uint32_t now = micros();
+    uint8_t received = target->read(address, data, size);
+    record(now, TRACE_READ, address, data, size);
+    return received;
+}
+
+/**
+ * @brief Forwards a combined transaction. It is recorded as a write followed by a read.
+ */
+uint8_t SI4735TraceRecorder::writeRead(uint8_t address, const uint8_t *data, uint8_t size, uint8_t *response, uint8_t responseSize)
+{
+    uint32_t now = micros();
+    uint8_t received = target->writeRead(address, data, size, response, responseSize);
+    record(now, TRACE_WRITE, address, data, size);
+    record(now, TRACE_READ, address, response, responseSize);
+    return received;
+}
+
+/**
+ * @brief Construct a new SI4735TraceReplay
+ * @param trace trace text (see SI4735Trace.h). Not copied.
+ */
+SI4735TraceReplay::SI4735TraceReplay(const char *trace)
+{
+    this->trace = trace;
+    rewind();
+}
+
+/**
+ * @brief Restarts the replay from the first line of the trace and clears the counters
+ */
+void SI4735TraceReplay::rewind()
+{
+    next = trace;
+    line = 0;
+    hasLast = false;
+    offset = 0;
+    memset(&counters, 0, sizeof counters);
+}
+
+/**
+ * @brief Sets the bus clock. Changes the time spent by each transaction.
+ * @param frequency in Hz
+ */
+void SI4735TraceReplay::setClock(uint32_t frequency)
+{
+    if (frequency != 0)
+        byteTime = 9000000UL / frequency;
+}
+
+static uint8_t hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return 0xFF;
+}
+
+/**
+ * @brief Parses the next record (comments, empty and invalid lines are skipped)
+ * @param p where to start
+ * @param rec record found
+ * @param lines incremented by the number of lines processed
+ * @return const char* the line after the record (rec->type is 0 if the trace has no more records)
+ */
+const char *SI4735TraceReplay::parse(const char *p, si4735_trace_record *rec, uint32_t *lines)
+{
+    rec->type = 0;
+    while (*p != '\0' && rec->type == 0)
+    {
+        const char *end = p;
+        while (*end != '\0' && *end != '\n')
+            end++;
+        (*lines)++;
+
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        if (p < end && *p >= '0' && *p <= '9')
+        {
+            uint32_t time = 0;
+            while (p < end && *p >= '0' && *p <= '9')
+                time = time * 10 + (*p++ - '0');
+            while (p < end && *p == ' ')
+                p++;
+            char type = (p < end) ? *p++ : 0;
+            if (type == TRACE_WRITE || type == TRACE_READ || type == TRACE_NACK)
+            {
+                uint8_t values[TRACE_MAX_DATA + 1];
+                uint8_t count = 0;
+                while (p < end && count <= TRACE_MAX_DATA)
+                {
+                    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+                        p++;
+                    if (end - p < 2 || hexValue(p[0]) == 0xFF || hexValue(p[1]) == 0xFF)
+                        break;
+                    values[count++] = (hexValue(p[0]) << 4) | hexValue(p[1]);
+                    p += 2;
+                }
+                if (count > 0)
+                {
+                    rec->time = time;
+                    rec->type = type;
+                    rec->address = values[0];
+                    rec->size = count - 1;
+                    memcpy(rec->data, &values[1], rec->size);
+                }
+            }
+        }
+        p = (*end == '\n') ? end + 1 : end;
+    }
+    return p;
+}
+
+/**
+ * @brief Copies a recorded response. Bytes not recorded are 0xFF (same of an empty Wire buffer).
+ */
+void SI4735TraceReplay::serve(uint8_t *data, uint8_t size, const si4735_trace_record *rec)
+{
+    for (uint8_t i = 0; i < size; i++)
+        data[i] = (i < rec->size) ? rec->data[i] : 0xFF;
+}
+
+/**
+ * @brief Receives a write from the library and compares it with the next recorded write
+ * @details The recorded reads not requested since the last write are skipped.
+ * @details The clock is aligned with the trace on each write; the next reads are served by time.
+ * @return uint8_t 0; 2 if the recorded write was not acknowledged (NACK)
+ */
+uint8_t SI4735TraceReplay::write(uint8_t address, const uint8_t *data, uint8_t size)
+{
+    si4735_trace_record rec;
+    uint32_t lines = 0;
+    uint32_t start = micros();
+    const char *p;
+
+    counters.writes++;
+    waitMicroseconds((uint32_t)(size + 1) * byteTime);
+    for (;;)
+    {
+        p = parse(next, &rec, &lines);
+        if (rec.type != TRACE_READ)
+            break;
+        counters.skippedReads++;
+        next = p;
+        line += lines;
+        lines = 0;
+    }
+
+    if (rec.type == 0)
+    {
+        counters.missingRecords++;
+        return 0;
+    }
+
+    next = p;
+    line += lines;
+    hasLast = false;
+    offset = start - rec.time;
+
+    if (rec.address != address || rec.size != size || memcmp(rec.data, data, size) != 0)
+    {
+        if (counters.mismatches++ == 0)
+            counters.firstMismatch = line;
+    }
+    return (rec.type == TRACE_NACK) ? 2 : 0;
+}
+
+/**
+ * @brief Serves a read to the library
+ * @details Among the recorded reads before the next write, returns the last one whose time has passed.
+ * @details If none has passed, repeats the last read served (or serves the first recorded read).
+ * @return uint8_t number of bytes received
+ */
+uint8_t SI4735TraceReplay::read(uint8_t address, uint8_t *data, uint8_t size)
+{
+    si4735_trace_record rec, chosen;
+    uint32_t lines = 0, chosenLines = 0;
+    uint32_t now = micros();
+    uint32_t duration = (uint32_t)(size + 1) * byteTime;
+    const char *p = next, *after = NULL;
+
+    counters.reads++;
+    waitMicroseconds(duration);
+    for (;;)
+    {
+        p = parse(p, &rec, &lines);
+        if (rec.type != TRACE_READ)
+            break;
+        // A recorded read whose time has not come yet (by the end of this transaction) is served only if there is nothing else to serve
+        if ((int32_t)(now + duration - offset - rec.time) < 0 && (after != NULL || hasLast))
+            break;
+        if (after != NULL)
+            counters.skippedReads++;
+        chosen = rec;
+        after = p;
+        chosenLines = lines;
+    }
+
+    if (after != NULL)
+    {
+        next = after;
+        line += chosenLines;
+        last = chosen;
+        hasLast = true;
+        serve(data, size, &chosen);
+        return size;
+    }
+
+    if (hasLast)
+    {
+        counters.repeatedReads++;
+        serve(data, size, &last);
+        return size;
+    }
+
+    counters.missingRecords++;
+    memset(data, 0xFF, size);
+    return 0;
+}
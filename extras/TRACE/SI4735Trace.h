@@ -0,0 +1,159 @@
+/**
+ * @brief SI4735 Trace - I2C transaction capture and deterministic replay
+ *
+ * @details This file contains two transports (see SI4735Transport):
+ * @details SI4735TraceRecorder sits between the library and the real transport and writes one text line per transaction.
+ * @details SI4735TraceReplay serves the recorded responses back to the library, without the device.
+ * @details With them, an RDS decode issue or a seek timing problem captured on a field unit can be reproduced offline
+ * @details (for example, on the host build - see extras/HOST) and the cost of real polling patterns can be measured.
+ *
+ * @details Trace format (text; one transaction per line; lines starting with # are comments):
+ * @details     <time> <type> <address> <bytes>
+ * @details time: microseconds from the start of the recording to the start of the transaction (decimal)
+ * @details type: W = write; R = read; N = write not acknowledged (NACK)
+ * @details address: I2C address (hex, two digits)
+ * @details bytes: data written or read (hex, two digits each, separated by spaces)
+ *
+ * @code
+ *   # SI4735 trace v1
+ *   1520 W 11 01 10 05
+ *   1862 R 11 80
+ *   2130 W 11 20 00 27 A6 00
+ *   2451 R 11 80
+ *   12710 R 11 81
+ * @endcode
+ *
+ * @details A logic analyzer I2C export can be converted to this format by saleae2trace.py (same folder).
+ *
+ * @see SI4735Transport
+ */
+
+#ifndef _SI4735_TRACE_H
+#define _SI4735_TRACE_H
+
+#include <SI4735.h>
+
+#define TRACE_MAX_DATA 32      // Maximum number of bytes of a transaction
+#define TRACE_MAX_LINE 120     // Maximum size of a trace line (TRACE_MAX_DATA * 3 plus time, type and address)
+#define TRACE_WRITE 'W'        // Write transaction
+#define TRACE_READ 'R'         // Read transaction
+#define TRACE_NACK 'N'         // Write transaction not acknowledged
+
+/**
+ * @ingroup group01
+ * @brief One transaction of a trace
+ */
+typedef struct
+{
+    uint32_t time;                //!< Microseconds since the start of the recording
+    char type;                    //!< TRACE_WRITE, TRACE_READ or TRACE_NACK
+    uint8_t address;              //!< I2C address
+    uint8_t size;                 //!< Number of bytes
+    uint8_t data[TRACE_MAX_DATA]; //!< Bytes written or read
+} si4735_trace_record;
+
+/**
+ * @ingroup group01
+ * @brief Replay counters
+ */
+typedef struct
+{
+    uint32_t writes;         //!< Writes received from the library
+    uint32_t reads;          //!< Reads served to the library
+    uint32_t mismatches;     //!< Writes different from the recorded ones
+    uint32_t firstMismatch;  //!< Trace line of the first mismatch (0 = none)
+    uint32_t skippedReads;   //!< Recorded reads not requested by the library (it polled less than the recording)
+    uint32_t repeatedReads;  //!< Reads served again (the library polled more than the recording)
+    uint32_t missingRecords; //!< Transactions requested after the end of the trace
+} si4735_trace_counters;
+
+/**
+ * @ingroup group05
+ *
+ * @brief Trace recorder. Forwards every transaction to another transport and writes it as a trace line.
+ *
+ * @details The line is passed to an output function (for example, one that prints it on the Serial Monitor).
+ *
+ * @code
+ *   SI4735WireTransport wire;
+ *   SI4735TraceRecorder recorder(&wire, [](const char *line) { Serial.println(line); });
+ *
+ *   rx.setTransport(&recorder);
+ * @endcode
+ */
+class SI4735TraceRecorder : public SI4735Transport
+{
+protected:
+    SI4735Transport *target;                //!< Transport that really exchanges data with the device
+    void (*output)(const char *line);       //!< Receives each trace line (without new line)
+    uint32_t startTime = 0;                 //!< micros() of the first transaction
+    bool started = false;
+    bool enabled = true;
+
+    void record(uint32_t now, char type, uint8_t address, const uint8_t *data, uint8_t size);
+
+public:
+    SI4735TraceRecorder(SI4735Transport *target, void (*output)(const char *line));
+
+    void begin();
+    uint8_t write(uint8_t address, const uint8_t *data, uint8_t size);
+    uint8_t read(uint8_t address, uint8_t *data, uint8_t size);
+    uint8_t writeRead(uint8_t address, const uint8_t *data, uint8_t size, uint8_t *response, uint8_t responseSize);
+    inline bool hasRepeatedStart() { return target->hasRepeatedStart(); };
+    inline void setClock(uint32_t frequency) { target->setClock(frequency); };
+    inline void waitMicroseconds(uint32_t us) { target->waitMicroseconds(us); };
+
+    /**
+     * @brief Starts or stops recording (the transactions are always forwarded)
+     * @param value true = record
+     */
+    inline void setEnabled(bool value) { enabled = value; };
+
+    /**
+     * @brief The next transaction will have time 0
+     */
+    inline void restart() { started = false; };
+};
+
+/**
+ * @ingroup group05
+ *
+ * @brief Trace replay. Serves the recorded responses to the library.
+ *
+ * @details The trace is a text in memory (not copied; it must exist while the replay is used).
+ * @details Writes are compared with the recorded ones (see si4735_trace_counters). A different write does not stop the replay.
+ * @details The library may poll the status a different number of times than in the recording. So, the reads between two
+ * @details recorded writes are served by time: each read returns the last recorded read of that group whose time (relative
+ * @details to the write before it) has already passed. Seek and tune timing (STC) are kept even with a different polling pattern.
+ * @details Recorded reads not requested are skipped; reads beyond the recorded ones repeat the last response.
+ * @details Each transaction takes the time it would take on the bus (see setClock), like on the recording.
+ * @details The result depends only on the trace and on the clock. On the host build (virtual clock), it is deterministic.
+ */
+class SI4735TraceReplay : public SI4735Transport
+{
+protected:
+    const char *trace;         //!< Trace text
+    const char *next;          //!< Next line to be processed
+    uint32_t line = 0;         //!< Trace line of next
+    si4735_trace_record last;  //!< Last read served
+    bool hasLast = false;
+    uint32_t offset = 0;       //!< micros() minus the trace time (set on each write)
+    uint32_t byteTime = 90;    //!< Time of a byte on the I2C bus (9 clocks at 100kHz). Updated by setClock.
+    si4735_trace_counters counters;
+
+    const char *parse(const char *p, si4735_trace_record *rec, uint32_t *lines);
+    void serve(uint8_t *data, uint8_t size, const si4735_trace_record *rec);
+
+public:
+    SI4735TraceReplay(const char *trace);
+
+    uint8_t write(uint8_t address, const uint8_t *data, uint8_t size);
+    uint8_t read(uint8_t address, uint8_t *data, uint8_t size);
+    void setClock(uint32_t frequency);
+
+    void rewind();
+    inline bool isFinished() { return *next == '\0'; };
+    inline const si4735_trace_counters *getCounters() { return &counters; };
+};
+
+#endif
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""
+Converts a Saleae Logic I2C analyzer export (CSV) to the SI4735 trace format (see SI4735Trace.h).
+
+Logic 2 export columns: name,type,start_time,duration,ack,address,read,data
+Logic 1 export columns: Time [s],Packet ID,Address,Data,Read/Write,ACK/NAK
+
+Usage:
+    python3 saleae2trace.py export.csv > field.trace
+    python3 saleae2trace.py --address-8bit export.csv > field.trace   (the analyzer shows 8-bit addresses)
+"""
+
+import argparse
+import csv
+import sys
+
+
+def to_int(value):
+    value = value.strip()
+    return int(value, 16) if value.lower().startswith("0x") else int(value)
+
+
+def emit(out, start, transaction):
+    time, address, read, nack, data = transaction
+    kind = "R" if read else ("N" if nack else "W")
+    line = "%d %s %02X" % (round((time - start) * 1e6), kind, address)
+    line += "".join(" %02X" % b for b in data)
+    out.write(line + "\n")
+
+
+def logic2(rows, address_shift):
+    """Yields (time, address, read, nack, data) from Logic 2 frames."""
+    current = None
+    for row in rows:
+        kind = row["type"]
+        if kind == "start":
+            if current is not None:
+                yield current  # repeated start
+            current = [float(row["start_time"]), 0, False, False, []]
+        elif kind == "address" and current is not None:
+            current[1] = to_int(row["address"]) >> address_shift
+            current[2] = row["read"].strip().lower() == "true"
+            current[3] = row["ack"].strip().lower() != "true"
+        elif kind == "data" and current is not None:
+            current[4].append(to_int(row["data"]))
+        elif kind == "stop" and current is not None:
+            yield current
+            current = None
+    if current is not None:
+        yield current
+
+
+def logic1(rows, address_shift):
+    """Yields (time, address, read, nack, data) from Logic 1 rows (one row per byte)."""
+    current = None
+    packet = None
+    for row in rows:
+        if row["Packet ID"] != packet:
+            if current is not None:
+                yield current
+            packet = row["Packet ID"]
+            current = [float(row["Time [s]"]), to_int(row["Address"]) >> address_shift,
+                       row["Read/Write"].strip().lower() == "read", False, []]
+        if "NAK" in row["ACK/NAK"] and not current[4] and not current[2]:
+            current[3] = True
+        if row["Data"].strip():
+            current[4].append(to_int(row["Data"]))
+    if current is not None:
+        yield current
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Saleae I2C export (CSV) to SI4735 trace")
+    parser.add_argument("csv", help="exported CSV file")
+    parser.add_argument("--address-8bit", action="store_true", help="addresses in the export include the R/W bit")
+    args = parser.parse_args()
+
+    with open(args.csv, newline="") as f:
+        reader = csv.DictReader(f)
+        shift = 1 if args.address_8bit else 0
+        if "type" in reader.fieldnames:
+            transactions = list(logic2(reader, shift))
+        elif "Packet ID" in reader.fieldnames:
+            transactions = list(logic1(reader, shift))
+        else:
+            sys.exit("Unknown export format: " + ",".join(reader.fieldnames))
+
+    out = sys.stdout
+    out.write("# SI4735 trace v1 (from %s)\n" % args.csv)
+    if transactions:
+        start = transactions[0][0]
+        for t in transactions:
+            emit(out, start, t)
+
+
+if __name__ == "__main__":
+    main()